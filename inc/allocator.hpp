@@ -5,6 +5,11 @@
 #include <type_traits>
 #include <assert.h>
 #include <stdint.h>
+#include <memory>
+#include <numeric>
+#include <new>
+#include <atomic>
+#include <sys/mman.h>
 #include "move_semantics.hpp"
 
 typedef unsigned int uint;
@@ -16,44 +21,91 @@ typedef unsigned int uint;
 // TODO:  select_on_container_copy_construction(alloc_traits)
 namespace nstd{
 
+/// allocators may report how many objects really fit into the block given for count_objects
+/// by providing good_size(), containers use it to round up their capacity.
+/// Extensions are skipped in constant evaluation, where only std::allocator could work
+template<class Allocator>
+constexpr size_t allocation_good_size(const Allocator& alloc, size_t count_objects) {
+    if constexpr(requires { alloc.good_size(count_objects); }) {
+        if(!std::is_constant_evaluated()) return alloc.good_size(count_objects);
+    }
+
+    return count_objects;
+}
+
+/// optional in-place resizing protocol: allocators may provide try_expand(ptr, old_n, new_n) and
+/// try_shrink(ptr, old_n, new_n), which resize the block without moving it and return false if they can't
+template<class Allocator, class T>
+constexpr bool allocation_try_expand(Allocator& alloc, T* ptr, size_t old_count_objects, size_t new_count_objects) {
+    if constexpr(requires { alloc.try_expand(ptr, old_count_objects, new_count_objects); }) {
+        if(!std::is_constant_evaluated()) return alloc.try_expand(ptr, old_count_objects, new_count_objects);
+    }
+
+    return false;
+}
+
+template<class Allocator, class T>
+constexpr bool allocation_try_shrink(Allocator& alloc, T* ptr, size_t old_count_objects, size_t new_count_objects) {
+    if constexpr(requires { alloc.try_shrink(ptr, old_count_objects, new_count_objects); }) {
+        if(!std::is_constant_evaluated()) return alloc.try_shrink(ptr, old_count_objects, new_count_objects);
+    }
+
+    return false;
+}
+
 //template<uint N_BLOCKS, class T>
 
 static const uint N_BLOCKS = 10000;
 
+/// first-fit allocator over the buffer of N_BLOCKS objects, free chunks are kept in the sorted
+/// list, which nodes are placed right in the free memory
 template<class T>
 class PoolAllocator
 {
     static_assert(!std::is_same<T, void>(), "Type of the allocator can not be void");
 
-    // static_assert(sizeof(T) > sizeof(chunk_list), "size of the block is too small, not supporting in current realization");
+    struct chunk_list {
+
+        chunk_list():
+            chunk_list(0){}
+
+        chunk_list(size_t n_blocks):
+            next_(NULL),
+            prev_(NULL),
+            n_blocks_(n_blocks){}
+
+        chunk_list(const chunk_list& other) = delete;
+
+        //            FIELDS             //
+        chunk_list* next_;
+        chunk_list* prev_;
+        size_t      n_blocks_;
+    };
+
+    // every block is a multiple of granule, so the header of the free chunk always fits in it and stays aligned
+    static const size_t ALIGN_GRANULE = alignof(chunk_list) / std::gcd(sizeof(T), alignof(chunk_list));
+    static const size_t GRANULE       = ALIGN_GRANULE * ((sizeof(chunk_list) + ALIGN_GRANULE * sizeof(T) - 1) / (ALIGN_GRANULE * sizeof(T)));
+    static const size_t N_OBJECTS = N_BLOCKS / GRANULE * GRANULE;
+
 public:
     typedef T value_type;
 
-    //? is adding allignment required
-    PoolAllocator() = default;
+    PoolAllocator():
+        free_chunks_(new (data_) chunk_list(N_OBJECTS)){}
 
     //? meaning
-    PoolAllocator(const PoolAllocator& other){}
+    PoolAllocator(const PoolAllocator& other):
+        PoolAllocator(){}
 
     /// allocate array of value_type, which size in count_objects
     T* allocate(size_t count_objects) {
+        count_objects = good_size(count_objects);
 
-        if(free_chunks_ == NULL) return NULL;
-        
-        chunk_list* cur_chunk = free_chunks_;
+        for(chunk_list* cur_chunk = free_chunks_; cur_chunk != NULL; cur_chunk = cur_chunk->next_) {
+            if(cur_chunk->n_blocks_ < count_objects) continue;
 
-        while(cur_chunk != NULL && cur_chunk->n_blocks_ < count_objects) {
             T* allocated_data = reinterpret_cast<T*>(cur_chunk);
-
-            if(cur_chunk->n_blocks_ == count_objects) {
-                cur_chunk->~chunk_list();
-            } else {
-                uint8_t* parted_chunk_place = reinterpret_cast<uint8_t*>(cur_chunk) + sizeof(chunk_list) + count_objects * sizeof(T);
-                chunk_list* parted_chunk = new (parted_chunk_place) chunk_list(nstd::move(*cur_chunk));
-
-                parted_chunk->n_blocks_ -= count_objects;
-                // we dont call cur_chunk->~chunk_list(), cause move constructor of parted chunk already has cleaned data of cur_chunk
-            }
+            cut_front(cur_chunk, count_objects);
 
             return allocated_data;
         }
@@ -64,146 +116,128 @@ public:
 
     //? is linear search of needed chunk_list object is too bad for performance
     void deallocate(T* ptr, size_t count_objects) {
+        count_objects = good_size(count_objects);
+
         uint8_t* chunk_to_deallocate_begin = reinterpret_cast<uint8_t*>(ptr);
         uint8_t* chunk_to_deallocate_end   = chunk_to_deallocate_begin + count_objects * sizeof(T);
 
-        if(data_ > chunk_to_deallocate_begin || chunk_to_deallocate_end >= data_ + N_BLOCKS * sizeof(T))
+        if(data_ > chunk_to_deallocate_begin || chunk_to_deallocate_end > data_ + N_OBJECTS * sizeof(T))
             return;            // TODO: throw except
-        
-        size_t diff = chunk_to_deallocate_begin - data_;
-        if(diff % sizeof(T) != 0)
+
+        if((chunk_to_deallocate_begin - data_) % (GRANULE * sizeof(T)) != 0)
             return;          // TODO: throw except
-        
-        if(free_chunks_ == NULL) {
-            free_chunks_ = new (chunk_to_deallocate_begin) chunk_list(count_objects);
-            return;
-        }
 
-        chunk_list* cur_chunk = free_chunks_;
-        
-        if(reinterpret_cast<uint8_t*>(cur_chunk) > chunk_to_deallocate_end) {
-            free_chunks_ = cur_chunk->insert_before(chunk_to_deallocate_begin, count_objects);
-            return;
+        // searching for the free neighbours
+        chunk_list* prev_chunk = NULL;
+        chunk_list* next_chunk = free_chunks_;
+
+        while(next_chunk != NULL && reinterpret_cast<uint8_t*>(next_chunk) < chunk_to_deallocate_begin) {
+            prev_chunk = next_chunk;
+            next_chunk = next_chunk->next_;
         }
 
-        // Todo: reduce
-        while(cur_chunk != NULL) {
-            uint8_t* cur_chunk_begin = reinterpret_cast<uint8_t*>(cur_chunk);
-            uint8_t* cur_chunk_end   = cur_chunk_begin + cur_chunk->n_blocks_ * sizeof(T);
+        if(prev_chunk && chunk_end(prev_chunk) > chunk_to_deallocate_begin)
+            return;         // TODO: throw except (double free)
 
-            if(cur_chunk_begin < chunk_to_deallocate_end || cur_chunk_end > chunk_to_deallocate_begin)
-                return;         // TODO: throw except
+        if(next_chunk && reinterpret_cast<uint8_t*>(next_chunk) < chunk_to_deallocate_end)
+            return;         // TODO: throw except (double free)
 
-            if(cur_chunk_end == chunk_to_deallocate_begin) {
-                // has found left free chunk neighbour
+        chunk_list* new_chunk = NULL;
 
-                if(cur_chunk->next_ && reinterpret_cast<uint8_t*>(cur_chunk->next_) == chunk_to_deallocate_end) {
-                    // has found right free chunk neighbour
+        if(prev_chunk && chunk_end(prev_chunk) == chunk_to_deallocate_begin) {
+            // has found left free chunk neighbour
+            prev_chunk->n_blocks_ += count_objects;
+            new_chunk = prev_chunk;
+        } else {
+            new_chunk = link_chunk(chunk_to_deallocate_begin, count_objects, prev_chunk, next_chunk);
+        }
 
-                    size_t next_chunk_n_blocks = cur_chunk->next->n_blocks_;
-                    cur_chunk->next_->~chunk_list();
+        if(next_chunk && reinterpret_cast<uint8_t*>(next_chunk) == chunk_end(new_chunk)) {
+            // has found right free chunk neighbour
+            new_chunk->n_blocks_ += next_chunk->n_blocks_;
+            unlink_chunk(next_chunk);
+        }
+    }
+
+    /// grows the block in place if the chunk right after it is free and big enough
+    bool try_expand(T* ptr, size_t old_count_objects, size_t new_count_objects) {
+        old_count_objects = good_size(old_count_objects);
+        new_count_objects = good_size(new_count_objects);
 
-                    cur_chunk->n_blocks_ += count_objects + next_chunk_n_blocks;
-                } else {
-                    // right free chunk neigbour hasn't been found
-                    cur_chunk->n_blocks_ += count_objects;
-                }
-                return;
-            } else if(cur_chunk_begin == chunk_to_deallocate_end){
-                // right free chunk neigbour hasn't been found
+        if(new_count_objects <= old_count_objects) return true;
 
-                chunk_list* new_chunk = new (chunk_to_deallocate_begin) chunk_list(nstd::move(cur_chunk));
-                new_chunk->n_blocks_ += count_objects;
+        uint8_t* block_end = reinterpret_cast<uint8_t*>(ptr + old_count_objects);
+        size_t   n_extra   = new_count_objects - old_count_objects;
 
-                return;
-            }
-            else if(cur_chunk_begin > chunk_to_deallocate_end){
-                // first chunk after chunk_to_deallocate(not neigbour)
+        for(chunk_list* cur_chunk = free_chunks_; cur_chunk != NULL; cur_chunk = cur_chunk->next_) {
+            uint8_t* cur_chunk_begin = reinterpret_cast<uint8_t*>(cur_chunk);
 
-                cur_chunk->insert_before(chunk_to_deallocate_begin, count_objects);
+            if(cur_chunk_begin < block_end) continue;
+            if(cur_chunk_begin > block_end || cur_chunk->n_blocks_ < n_extra) return false;
 
-                return;
-            }
+            cut_front(cur_chunk, n_extra);
+            return true;
         }
 
-        // we couldn't reach this place
-        assert(0);
+        return false;
     }
 
-private:
-    struct chunk_list {
-
-        chunk_list():
-            chunk_list(0){}
-
-        chunk_list(uint n_blocks):
-            next_(NULL),
-            prev_(NULL),
-            n_blocks_(n_blocks){}
+    /// gives the tail of the block back to the pool, block itself stays in place
+    bool try_shrink(T* ptr, size_t old_count_objects, size_t new_count_objects) {
+        old_count_objects = good_size(old_count_objects);
+        new_count_objects = good_size(new_count_objects);
 
-        chunk_list(const chunk_list& other) = delete;
-        chunk_list(chunk_list&& other):
-            chunk_list()
-        { 
-            std::swap(*this, other); 
-            if(this->next_)
-                { this->next_->prev_ = this; }
-            if(this->prev_)
-                { this->prev_->next_ = this; }
-        }
+        if(new_count_objects >= old_count_objects) return true;
 
-        ~chunk_list() {
-            if(next_)
-                { next_->prev_ = prev_; }
+        deallocate(ptr + new_count_objects, old_count_objects - new_count_objects);
+        return true;
+    }
 
-            if(prev_)
-                { prev_->next_ = next_; }
+    /// blocks are given in granules
+    size_t good_size(size_t count_objects) const
+    { return (count_objects + GRANULE - 1) / GRANULE * GRANULE; }
 
-            // for safety
-            next_ = prev_ = NULL;
-            n_blocks_ = 0;
-        }
+private:
+    uint8_t* chunk_end(chunk_list* chunk)
+    { return reinterpret_cast<uint8_t*>(chunk) + chunk->n_blocks_ * sizeof(T); }
 
-        chunk_list* insert_after(uint8_t* placement_pos, uint n_blocks) {
+    chunk_list* link_chunk(uint8_t* placement_pos, size_t n_blocks, chunk_list* prev, chunk_list* next) {
+        chunk_list* new_obj = new (placement_pos) chunk_list(n_blocks);
 
-            //? is performance ok, maybe just direct cast to chunk_list*
-            chunk_list* new_obj = new (placement_pos) chunk_list(n_blocks);
+        new_obj->prev_ = prev;
+        new_obj->next_ = next;
 
-            new_obj->next_ = next_;
-            new_obj->prev_ = this;
+        if(prev) prev->next_ = new_obj;
+        else     free_chunks_ = new_obj;
 
-            if(new_obj->next_) {
-                new_obj->next->prev = new_obj;
-            }
+        if(next) next->prev_ = new_obj;
 
-            this->next = new_obj;
-            return new_obj;
-        }
+        return new_obj;
+    }
 
-        void insert_before(uint8_t* placement_pos, uint n_blocks) {
+    void unlink_chunk(chunk_list* chunk) {
+        if(chunk->prev_) chunk->prev_->next_ = chunk->next_;
+        else             free_chunks_ = chunk->next_;
 
-            //? is performance ok, maybe just direct cast to chunk_list*
-            chunk_list* new_obj = new (placement_pos) chunk_list(n_blocks);
+        if(chunk->next_) chunk->next_->prev_ = chunk->prev_;
+    }
 
-            new_obj->next_ = this;
-            new_obj->prev_ = prev_;
+    /// takes n_blocks from the beginning of the free chunk
+    void cut_front(chunk_list* chunk, size_t n_blocks) {
+        chunk_list* prev = chunk->prev_;
+        chunk_list* next = chunk->next_;
+        size_t n_left    = chunk->n_blocks_ - n_blocks;
 
-            if(new_obj->prev_) {
-                new_obj->prev_->next_ = new_obj;
-            }
+        unlink_chunk(chunk);
 
-            this->prev_ = new_obj;
+        if(n_left) {
+            link_chunk(reinterpret_cast<uint8_t*>(chunk) + n_blocks * sizeof(T), n_left, prev, next);
         }
-
-        //            FIELDS             //
-        chunk_list* next_;
-        chunk_list* prev_;
-        uint n_blocks_;
-    };
+    }
 
 private:
-    uint8_t     data_[N_BLOCKS];
-    chunk_list* free_chunks_ = new (data_) chunk_list(N_BLOCKS);
+    alignas(T) alignas(chunk_list) uint8_t data_[N_OBJECTS * sizeof(T)];
+    chunk_list*                            free_chunks_;
 };
 
 //? is it a good idea for allocators make the option for reallocating storage in allocator or maybe it's better to implement chunk tactic from https://habr.com/ru/post/505632/
@@ -211,6 +245,7 @@ private:
 
 static const uint N_ELEMS = 20 * 1000;
 
+/// LIFO allocator, blocks are prefixed with their size and must be freed in reverse order
 template<class T>
 class StackAllocator
 {
@@ -222,11 +257,12 @@ public:
     StackAllocator():
         free_(data_){}
 
-    StackAllocator(const StackAllocator& other){}
+    StackAllocator(const StackAllocator& other):
+        free_(data_){}
 
     T* allocate(size_t count_objects) {
 
-        if(free_ + count_objects * sizeof(T) + sizeof(uint32_t) > data_ + N_ELEMS * sizeof(T))
+        if(free_ + count_objects * sizeof(T) + sizeof(uint32_t) > data_ + N_ELEMS)
             return NULL;
         
         *reinterpret_cast<uint32_t*>(free_) = count_objects;
@@ -248,11 +284,213 @@ public:
         free_ = casted_ptr - sizeof(uint32_t);
     }
 
+    /// only the top block can grow, it costs O(1) and moves nothing
+    bool try_expand(T* ptr, size_t old_count_objects, size_t new_count_objects) {
+        if(!is_top(ptr, old_count_objects)) return false;
+
+        uint8_t* new_free = reinterpret_cast<uint8_t*>(ptr + new_count_objects);
+        if(new_free > data_ + N_ELEMS) return false;
+
+        *(reinterpret_cast<uint32_t*>(ptr) - 1) = new_count_objects;
+        free_ = new_free;
+
+        return true;
+    }
+
+    bool try_shrink(T* ptr, size_t old_count_objects, size_t new_count_objects) {
+        if(!is_top(ptr, old_count_objects) || new_count_objects > old_count_objects) return false;
+
+        *(reinterpret_cast<uint32_t*>(ptr) - 1) = new_count_objects;
+        free_ = reinterpret_cast<uint8_t*>(ptr + new_count_objects);
+
+        return true;
+    }
+
+private:
+    bool is_top(T* ptr, size_t count_objects) const
+    { return reinterpret_cast<uint8_t*>(ptr + count_objects) == free_; }
+
 private:
     uint8_t     data_[N_ELEMS];
     uint8_t*    free_;
 };
 
+/// keeps one block of N objects inside itself and gives it for every request that fits,
+/// bigger requests (or requests made while the inline block is busy) go to std::allocator
+template<class T, size_t N>
+class InlineAllocator
+{
+    static_assert(!std::is_same<T, void>(), "Type of the allocator can not be void");
+    static_assert(N > 0, "Inline capacity can not be zero");
+
+public:
+    typedef T value_type;
+    typedef std::false_type is_always_equal;
+
+    InlineAllocator():
+        is_inline_busy_(false){}
+
+    // inline block isn't shared with copies
+    InlineAllocator(const InlineAllocator& other):
+        is_inline_busy_(false){}
+
+    InlineAllocator& operator=(const InlineAllocator& other)
+    { return *this; }
+
+    T* allocate(size_t count_objects) {
+        if(count_objects <= N && !is_inline_busy_) {
+            is_inline_busy_ = true;
+            return inline_data();
+        }
+
+        return std::allocator<T>().allocate(count_objects);
+    }
+
+    void deallocate(T* ptr, size_t count_objects) {
+        if(owns(ptr)) {
+            is_inline_busy_ = false;
+            return;
+        }
+
+        std::allocator<T>().deallocate(ptr, count_objects);
+    }
+
+    /// there is no sense to take less than the inline block
+    size_t good_size(size_t count_objects) const
+    { return count_objects < N ? N : count_objects; }
+
+    bool owns(const T* ptr) const
+    { return ptr == reinterpret_cast<const T*>(data_); }
+
+private:
+    T* inline_data()
+    { return reinterpret_cast<T*>(data_); }
+
+private:
+    alignas(T) uint8_t data_[N * sizeof(T)];
+    bool               is_inline_busy_;
+};
+
+/// binds inline capacity, so InlineBuffer<N>::allocator fits the template <typename> class Alloc slot of containers
+template<size_t N>
+struct InlineBuffer
+{
+    template<class T>
+    using allocator = InlineAllocator<T, N>;
+};
+
+/// big blocks are 2M aligned anonymous mappings, so the kernel backs them with huge pages and scans over them
+/// don't miss dTLB on every 4K page. Reserved hugetlbfs pages (MAP_HUGETLB) are tried first, then transparent
+/// huge pages are requested by MADV_HUGEPAGE. Blocks smaller than HUGE_THRESHOLD bytes go to std::allocator.
+/// Mappings grow and shrink in place with mremap
+template<class T>
+class HugePageAllocator
+{
+    static_assert(!std::is_same<T, void>(), "Type of the allocator can not be void");
+
+public:
+    typedef T value_type;
+    typedef std::true_type is_always_equal;
+
+    static const size_t HUGE_PAGE_SIZE = size_t(1) << 21;
+    static const size_t HUGE_THRESHOLD = HUGE_PAGE_SIZE;
+
+    HugePageAllocator() = default;
+
+    template<class U>
+    HugePageAllocator(const HugePageAllocator<U>&){}
+
+    T* allocate(size_t count_objects) {
+        if(!is_huge(count_objects))
+            return std::allocator<T>().allocate(count_objects);
+
+        size_t n_bytes = mapping_size(count_objects);
+
+        if(is_hugetlb_available()) {
+            void* ptr = mmap(NULL, n_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if(ptr != MAP_FAILED) return static_cast<T*>(ptr);
+
+            // pool of reserved pages is empty, don't ask again
+            is_hugetlb_available() = false;
+        }
+
+        // one huge page more, then the unaligned head and the tail are cut off
+        uint8_t* raw = static_cast<uint8_t*>(mmap(NULL, n_bytes + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                                                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if(raw == MAP_FAILED)
+            throw std::bad_alloc();
+
+        uint8_t* aligned = reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(raw) + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1));
+
+        if(aligned != raw) munmap(raw, aligned - raw);
+        munmap(aligned + n_bytes, raw + HUGE_PAGE_SIZE - aligned);
+
+        madvise(aligned, n_bytes, MADV_HUGEPAGE);
+
+        return reinterpret_cast<T*>(aligned);
+    }
+
+    void deallocate(T* ptr, size_t count_objects) {
+        if(!is_huge(count_objects)) {
+            std::allocator<T>().deallocate(ptr, count_objects);
+            return;
+        }
+
+        munmap(ptr, mapping_size(count_objects));
+    }
+
+    /// mapping is extended only if the address space after it is free, huge pages of the tail are requested again
+    bool try_expand(T* ptr, size_t old_count_objects, size_t new_count_objects) {
+        if(!is_huge(old_count_objects)) return false;
+
+        size_t old_bytes = mapping_size(old_count_objects);
+        size_t new_bytes = mapping_size(new_count_objects);
+        if(new_bytes <= old_bytes) return new_bytes == old_bytes;
+
+        if(mremap(ptr, old_bytes, new_bytes, 0) == MAP_FAILED) return false;
+
+        madvise(reinterpret_cast<uint8_t*>(ptr) + old_bytes, new_bytes - old_bytes, MADV_HUGEPAGE);
+        return true;
+    }
+
+    bool try_shrink(T* ptr, size_t old_count_objects, size_t new_count_objects) {
+        if(!is_huge(old_count_objects) || !is_huge(new_count_objects)) return false;
+
+        size_t old_bytes = mapping_size(old_count_objects);
+        size_t new_bytes = mapping_size(new_count_objects);
+        if(new_bytes > old_bytes) return false;
+
+        return new_bytes == old_bytes || mremap(ptr, old_bytes, new_bytes, 0) != MAP_FAILED;
+    }
+
+    /// mappings are whole huge pages
+    size_t good_size(size_t count_objects) const {
+        if(!is_huge(count_objects)) return count_objects;
+
+        return mapping_size(count_objects) / sizeof(T);
+    }
+
+private:
+    static bool is_huge(size_t count_objects)
+    { return count_objects * sizeof(T) >= HUGE_THRESHOLD; }
+
+    static size_t mapping_size(size_t count_objects)
+    { return (count_objects * sizeof(T) + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1); }
+
+    static std::atomic<bool>& is_hugetlb_available() {
+        static std::atomic<bool> is_available(true);
+        return is_available;
+    }
+};
+
+template<class T, class U>
+bool operator==(const HugePageAllocator<T>&, const HugePageAllocator<U>&)
+{ return true; }
+
+template<class T, class U>
+bool operator!=(const HugePageAllocator<T>&, const HugePageAllocator<U>&)
+{ return false; }
+
 /*
 template<class T, class U>
 bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&)
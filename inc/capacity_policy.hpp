@@ -0,0 +1,89 @@
+#ifndef NSTD_CAPACITY_POLICY_H
+#define NSTD_CAPACITY_POLICY_H
+
+#include <stdint.h>
+#include <cstdlib>
+
+const size_t DEF_CAPACITY    = 1 << 4;
+const size_t GROWTH_FACTOR   = 1 << 1;
+const size_t DECREASE_FACTOR = 1 << 3;
+
+// Capacity policies of nstd::vector.
+// Growth part:  static size_t grow(size_t capacity, size_t low_limit, size_t elem_size)   - new capacity >= low_limit
+// Shrink part:  static size_t shrink(size_t capacity, size_t size)                       - new capacity, capacity means "keep"
+
+namespace nstd{
+
+/// capacity *= Num / Den until it fits, first block is Initial elements
+template<size_t Num, size_t Den = 1, size_t Initial = DEF_CAPACITY>
+struct growth_factor {
+    static_assert(Num > Den, "growth factor must be greater than 1");
+
+    static constexpr size_t grow(size_t capacity, size_t low_limit, size_t /*elem_size*/) {
+        size_t new_capacity = capacity ? capacity : Initial;
+
+        while(new_capacity < low_limit) {
+            size_t next = new_capacity * Num / Den;
+            new_capacity = next > new_capacity ? next : new_capacity + 1;
+        }
+
+        return new_capacity;
+    }
+};
+
+typedef growth_factor<GROWTH_FACTOR> growth_x2;
+
+/// sum of the freed blocks becomes big enough for the next request, so allocator can reuse them
+typedef growth_factor<3, 2>          growth_x1_5;
+
+/// rounds capacity of Growth up to malloc-like size class: 16 byte steps for small blocks,
+/// then 4 classes per power of two, so no bytes are wasted on the allocator side
+template<class Growth = growth_x2>
+struct growth_size_class {
+
+    static constexpr size_t round_to_size_class(size_t n_bytes) {
+        if(n_bytes <= 128)
+            return (n_bytes + 15) / 16 * 16;
+
+        size_t high_bit = size_t(1) << (63 - __builtin_clzll(n_bytes));
+        size_t step     = high_bit / 4;
+
+        return (n_bytes + step - 1) / step * step;
+    }
+
+    static constexpr size_t grow(size_t capacity, size_t low_limit, size_t elem_size) {
+        size_t new_capacity = Growth::grow(capacity, low_limit, elem_size);
+
+        return round_to_size_class(new_capacity * elem_size) / elem_size;
+    }
+};
+
+/// storage is never given back before destruction or shrink_to_fit()
+struct shrink_never {
+    static constexpr size_t shrink(size_t capacity, size_t /*size*/)
+    { return capacity; }
+};
+
+/// shrinks when only 1/Trigger of the capacity is used, leaving Target times of the size.
+/// Trigger > Target, so push/pop oscillation near the threshold doesn't reallocate each time
+template<size_t Trigger = DECREASE_FACTOR, size_t Target = 2, size_t Min = DEF_CAPACITY>
+struct shrink_hysteresis {
+    static_assert(Trigger > Target && Target >= 1, "hysteresis requires Trigger > Target >= 1");
+
+    static constexpr size_t shrink(size_t capacity, size_t size) {
+        if(capacity <= Min || size * Trigger > capacity) return capacity;
+
+        size_t new_capacity = size * Target;
+        return new_capacity < Min ? Min : new_capacity;
+    }
+};
+
+/// vector takes both parts from one policy type
+template<class Growth = growth_x2, class Shrink = shrink_hysteresis<>>
+struct capacity_policy : Growth, Shrink {};
+
+typedef capacity_policy<> default_capacity_policy;
+
+}; // namespace nstd
+
+#endif // NSTD_CAPACITY_POLICY_H
@@ -0,0 +1,42 @@
+#ifndef NSTD_CHECK_POLICY_H
+#define NSTD_CHECK_POLICY_H
+
+#include <stdexcept>
+#include <assert.h>
+#include <cstdlib>
+
+// Bounds checking policies for operator[], front() and back() of nstd containers.
+// at() is always checked regardless of the policy.
+// Default policy could be changed for the whole build by defining NSTD_DEFAULT_CHECK_POLICY
+// (check_never, check_debug or check_always) before including nstd headers.
+
+namespace nstd{
+
+/// throws std::out_of_range, as at() does
+struct check_always {
+    static constexpr void check(size_t n_elem, size_t size) {
+        if(n_elem >= size)
+            throw std::out_of_range("index out of range");
+    }
+};
+
+/// assert, which disappears with NDEBUG
+struct check_debug {
+    static constexpr void check(size_t n_elem, size_t size)
+    { assert(n_elem < size && "index out of range"); }
+};
+
+/// no checks, so loops over operator[] can be vectorized
+struct check_never {
+    static constexpr void check(size_t, size_t) {}
+};
+
+#ifndef NSTD_DEFAULT_CHECK_POLICY
+#define NSTD_DEFAULT_CHECK_POLICY check_never
+#endif
+
+typedef NSTD_DEFAULT_CHECK_POLICY default_check_policy;
+
+}; // namespace nstd
+
+#endif // NSTD_CHECK_POLICY_H
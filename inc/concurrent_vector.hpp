@@ -0,0 +1,502 @@
+#ifndef NSTD_CONCURRENT_VECTOR_H
+#define NSTD_CONCURRENT_VECTOR_H
+
+#include <cstdlib>
+#include <stdexcept>
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include "iterator.hpp"
+#include "move_semantics.hpp"
+#include "check_policy.hpp"
+#include "segmented_vector.hpp"
+
+namespace nstd{
+
+/// element storage of concurrent_vector: the value and the state, which publishes it
+template<typename T>
+struct concurrent_slot{
+    /// DEAD slot is published without a value: its constructor has thrown
+    enum state_t : uint8_t {
+        EMPTY,
+        READY,
+        DEAD
+    };
+
+    alignas(T) uint8_t     value_[sizeof(T)];
+    std::atomic<state_t>   state_;
+
+    T* value()
+    { return reinterpret_cast<T*>(value_); }
+
+    const T* value() const
+    { return reinterpret_cast<const T*>(value_); }
+};
+
+template<typename Container, typename Ref>
+class concurrent_vector_iterator;
+
+/// append-only vector for many writers: push_back reserves the slot with one fetch_add and constructs the element
+/// there, writers wait only for the allocation of a missing block by another one. Storage is the segment table of segmented_vector, so published elements never move.
+/// size() is the published prefix: every element below it is constructed, so readers may index it concurrently
+/// with writers. A writer whose element is ready advances the prefix over all the ready slots after it,
+/// so the prefix is behind only while some writer is still constructing.
+/// Alloc must be thread safe (std::allocator, HugePageAllocator); clear(), reserve() and destruction are not concurrent.
+/// If the constructor of T throws, its slot is published as dead, so the elements after it still become visible:
+/// size() counts it, at() throws for it and is_constructed() is false, operator[] and iterators must not read it.
+/// The same happens if the block of the slot can't be allocated, then the writer, who installs the block later, publishes it.
+/// The writer of the middle of a block installs the next one, so the others rarely meet a missing block
+template<typename T, template <typename> class Alloc = std::allocator, class CheckPolicy = default_check_policy,
+         size_t LogFirst = 4>
+class concurrent_vector : public Alloc<concurrent_slot<T>>{
+    typedef concurrent_slot<T>                    slot_t;
+    typedef segmented_iterator<T*, LogFirst>      layout;
+
+public:
+    typedef concurrent_vector_iterator<concurrent_vector, T&>              iterator;
+    typedef concurrent_vector_iterator<const concurrent_vector, const T&>  const_iterator;
+
+    typedef T&                                    reference;
+    typedef const T&                              const_reference;
+
+    static const size_t FIRST_BLOCK = size_t(1) << LogFirst;
+    static const size_t MAX_BLOCKS  = 64 - LogFirst;
+
+public:
+    concurrent_vector():
+        blocks_(),
+        n_reserved_(0),
+        n_published_(0),
+        abandoned_(NULL){}
+
+    concurrent_vector(const concurrent_vector& other) = delete;
+    concurrent_vector& operator=(const concurrent_vector& other) = delete;
+
+    ~concurrent_vector() {
+        clear();
+
+        for(size_t n_block = 0; n_block < MAX_BLOCKS; n_block++) {
+            slot_t* block = blocks_[n_block].load(std::memory_order_relaxed);
+            if(block) this->deallocate(block, block_size(n_block));
+        }
+    }
+
+    void push_back(const T& val)
+    { emplace_back(val); }
+
+    void push_back(T&& val)
+    { emplace_back(nstd::move(val)); }
+
+    /// safe to call from any number of threads, returns the element, which stays at its place until clear()
+    template<typename... Args>
+    reference emplace_back(Args&&... args) {
+        size_t n_elem = n_reserved_.fetch_add(1, std::memory_order_relaxed);
+
+        size_t n_block = 0, offset = 0;
+        layout::locate(n_elem, n_block, offset);
+        slot_t* place = NULL;
+
+        try {
+            place = get_block(n_block) + offset;
+
+            if(offset == block_size(n_block) / 2 && n_block + 1 < MAX_BLOCKS) get_block(n_block + 1);
+
+            new (place->value()) T(nstd::forward<Args>(args)...);
+        } catch(...) {
+            // the reserved slot can't be given back, unpublished it would hide all the later elements
+            if(place) finish_slot(n_elem, place, slot_t::DEAD);
+            else      abandon_slot(n_elem);
+            throw;
+        }
+
+        finish_slot(n_elem, place, slot_t::READY);
+        return *place->value();
+    }
+
+    /// number of published elements, all of them could be read
+    size_t size() const
+    { return n_published_.load(std::memory_order_acquire); }
+
+    bool empty() const
+    { return size() == 0; }
+
+    /// number of slots allocated up to the first missing block
+    size_t capacity() const {
+        size_t n_block = 0;
+        while(installed_block(n_block, std::memory_order_acquire)) n_block++;
+
+        return block_begin(n_block);
+    }
+
+    /// allocates blocks up front, so pushes below capacity never call the allocator
+    void reserve(size_t capacity) {
+        for(size_t n_block = 0; n_block < MAX_BLOCKS && block_begin(n_block) < capacity; n_block++) {
+            get_block(n_block);
+        }
+    }
+
+    /// whether the published element n_elem holds a value, false for the slots of the thrown constructors
+    bool is_constructed(size_t n_elem) const {
+        CheckPolicy::check(n_elem, size());
+        return slot(n_elem)->state_.load(std::memory_order_relaxed) != slot_t::DEAD;
+    }
+
+    reference at(size_t n_elem) {
+        if(n_elem >= size() || slot(n_elem)->state_.load(std::memory_order_relaxed) == slot_t::DEAD)
+            throw std::out_of_range("out of range");
+
+        return *slot(n_elem)->value();
+    }
+
+    const_reference at(size_t n_elem) const {
+        if(n_elem >= size() || slot(n_elem)->state_.load(std::memory_order_relaxed) == slot_t::DEAD)
+            throw std::out_of_range("out of range");
+
+        return *slot(n_elem)->value();
+    }
+
+    reference operator[](size_t n_elem) {
+        CheckPolicy::check(n_elem, size());
+        return *slot(n_elem)->value();
+    }
+
+    const_reference operator[](size_t n_elem) const {
+        CheckPolicy::check(n_elem, size());
+        return *slot(n_elem)->value();
+    }
+
+    reference front()
+    { return (*this)[0]; }
+
+    const_reference front() const
+    { return (*this)[0]; }
+
+    /// last published element
+    reference back()
+    { return (*this)[size() - 1]; }
+
+    const_reference back() const
+    { return (*this)[size() - 1]; }
+
+    /// destroys the elements and keeps the blocks, must not run concurrently with anything
+    void clear() {
+        size_t n_reserved = n_reserved_.load(std::memory_order_relaxed);
+
+        for(size_t n_elem = 0; n_elem < n_reserved; n_elem++) {
+            size_t n_block = 0, offset = 0;
+            layout::locate(n_elem, n_block, offset);
+
+            // abandoned slots of a block, which couldn't be allocated
+            slot_t* block = blocks_[n_block].load(std::memory_order_relaxed);
+            if(!block) continue;
+
+            slot_t* place = block + offset;
+            if(place->state_.load(std::memory_order_relaxed) == slot_t::READY) place->value()->~T();
+            place->state_.store(slot_t::EMPTY, std::memory_order_relaxed);
+        }
+
+        while(abandoned_) {
+            abandoned_slot* next = abandoned_->next_;
+            delete abandoned_;
+            abandoned_ = next;
+        }
+
+        n_reserved_.store(0, std::memory_order_relaxed);
+        n_published_.store(0, std::memory_order_relaxed);
+    }
+
+    /// iterators walk over the elements published at the moment of the call of begin()/end()
+    iterator begin()
+    { return iterator(this, 0); }
+
+    const_iterator begin() const
+    { return const_iterator(this, 0); }
+
+    const_iterator cbegin() const
+    { return const_iterator(this, 0); }
+
+    iterator end()
+    { return iterator(this, size()); }
+
+    const_iterator end() const
+    { return const_iterator(this, size()); }
+
+    const_iterator cend() const
+    { return const_iterator(this, size()); }
+
+private:
+    /// reserved slot, which block the writer couldn't allocate
+    struct abandoned_slot{
+        size_t           n_elem_;
+        abandoned_slot*  next_;
+    };
+
+    static size_t block_size(size_t n_block)
+    { return FIRST_BLOCK << n_block; }
+
+    static size_t block_begin(size_t n_block)
+    { return (FIRST_BLOCK << n_block) - FIRST_BLOCK; }
+
+    /// slot of a reserved element, its block is installed
+    slot_t* slot(size_t n_elem) const {
+        size_t n_block = 0, offset = 0;
+        layout::locate(n_elem, n_block, offset);
+
+        return blocks_[n_block].load(std::memory_order_acquire) + offset;
+    }
+
+    /// marks the block, which is being allocated by some writer
+    static slot_t* installing() {
+        static slot_t marker;
+        return &marker;
+    }
+
+    /// NULL while the block is missing or being allocated
+    slot_t* installed_block(size_t n_block, std::memory_order order = std::memory_order_seq_cst) const {
+        if(n_block >= MAX_BLOCKS) return NULL;
+
+        slot_t* block = blocks_[n_block].load(order);
+        return block == installing() ? NULL : block;
+    }
+
+    /// the first thread to need the block allocates and installs it, the others wait for it instead of allocating
+    /// their copies. If the allocation fails, the block is missing again and the next writer tries
+    slot_t* get_block(size_t n_block) {
+        if(n_block >= MAX_BLOCKS)
+            throw std::length_error("concurrent_vector is too long");
+
+        slot_t* block = blocks_[n_block].load(std::memory_order_acquire);
+        while(block == NULL || block == installing()) {
+            if(block == installing()) {
+                std::this_thread::yield();
+                block = blocks_[n_block].load(std::memory_order_acquire);
+                continue;
+            }
+            if(!blocks_[n_block].compare_exchange_weak(block, installing(), std::memory_order_acquire)) continue;
+
+            try {
+                block = this->allocate(block_size(n_block));
+            } catch(...) {
+                blocks_[n_block].store(NULL);
+                throw;
+            }
+            for(size_t i = 0; i < block_size(n_block); i++) {
+                new (&block[i].state_) std::atomic<typename slot_t::state_t>(slot_t::EMPTY);
+            }
+
+            blocks_[n_block].store(block);
+            finish_abandoned(n_block, block);
+        }
+
+        return block;
+    }
+
+    /// the slot has no block to store its state, so it is recorded for the writer, who installs the block.
+    /// Both check the block under the lock, so either the record is found or the block is seen here
+    void abandon_slot(size_t n_elem) {
+        size_t n_block = 0, offset = 0;
+        layout::locate(n_elem, n_block, offset);
+
+        {
+            std::lock_guard<std::mutex> lock(abandoned_mutex_);
+
+            if(!installed_block(n_block)) {
+                abandoned_slot* record = new (std::nothrow) abandoned_slot{n_elem, abandoned_};
+                if(record) {
+                    abandoned_ = record;
+                    return;
+                }
+            }
+        }
+
+        // the block is installed already or even the record doesn't fit into memory, then the block is retried
+        // until it is there. Blocks past MAX_BLOCKS never are, their slots are beyond any reachable size
+        while(n_block < MAX_BLOCKS && !installed_block(n_block)) {
+            try {
+                get_block(n_block);
+            } catch(const std::bad_alloc&) {
+                std::this_thread::yield();
+            }
+        }
+        if(n_block < MAX_BLOCKS) finish_slot(n_elem, installed_block(n_block) + offset, slot_t::DEAD);
+    }
+
+    /// publishes the abandoned slots of the just installed block as dead
+    void finish_abandoned(size_t n_block, slot_t* block) {
+        abandoned_slot* found = NULL;
+
+        {
+            std::lock_guard<std::mutex> lock(abandoned_mutex_);
+
+            abandoned_slot** link = &abandoned_;
+            while(*link) {
+                size_t n_record_block = 0, offset = 0;
+                layout::locate((*link)->n_elem_, n_record_block, offset);
+
+                if(n_record_block != n_block) {
+                    link = &(*link)->next_;
+                    continue;
+                }
+
+                abandoned_slot* record = *link;
+                *link         = record->next_;
+                record->next_ = found;
+                found         = record;
+            }
+        }
+
+        while(found) {
+            size_t n_record_block = 0, offset = 0;
+            layout::locate(found->n_elem_, n_record_block, offset);
+            finish_slot(found->n_elem_, block + offset, slot_t::DEAD);
+
+            abandoned_slot* next = found->next_;
+            delete found;
+            found = next;
+        }
+    }
+
+    /// sets the final state of the slot and publishes it
+    void finish_slot(size_t n_elem, slot_t* place, typename slot_t::state_t state) {
+        // usual case: all the previous slots are published, so the ready slot is published right away and
+        // its state is needed only by clear(). Dead state is stored before, readers of the prefix must see it
+        size_t n_published = n_elem;
+        if(state == slot_t::READY && n_published_.compare_exchange_strong(n_published, n_elem + 1)) {
+            place->state_.store(state, std::memory_order_relaxed);
+        }
+        else {
+            place->state_.store(state);
+        }
+
+        publish();
+    }
+
+    /// moves the published prefix over the finished (ready or dead) slots. States and the prefix are sequentially
+    /// consistent: either the writer of the blocking slot sees our state, or we see its one, so no finished slot stays
+    /// unpublished. The fast path of emplace_back doesn't need the state: its successful exchange is seen by everybody after it
+    void publish() {
+        size_t n_published = n_published_.load();
+
+        while(n_published < n_reserved_.load() && is_finished(n_published)) {
+            // on failure n_published is updated by the winner, who may be further already
+            n_published_.compare_exchange_weak(n_published, n_published + 1);
+        }
+    }
+
+    /// block of a reserved slot may be not installed yet, then its writer hasn't finished
+    bool is_finished(size_t n_elem) const {
+        size_t n_block = 0, offset = 0;
+        layout::locate(n_elem, n_block, offset);
+
+        slot_t* block = installed_block(n_block);
+        return block && block[offset].state_.load() != slot_t::EMPTY;
+    }
+
+private:
+    std::atomic<slot_t*>  blocks_[MAX_BLOCKS];
+    std::atomic<size_t>   n_reserved_;
+    std::atomic<size_t>   n_published_;
+
+    std::mutex            abandoned_mutex_;
+    abandoned_slot*       abandoned_;
+};
+
+/// random access by index over concurrent_vector
+template<typename Container, typename Ref>
+class concurrent_vector_iterator
+{
+public:
+    typedef std::random_access_iterator_tag          iterator_category;
+    typedef std::remove_reference_t<Ref>             value_type;
+    typedef ptrdiff_t                                difference_type;
+    typedef value_type*                              pointer;
+    typedef Ref                                      reference;
+
+public:
+    concurrent_vector_iterator():
+        container_(NULL),
+        n_elem_(0){}
+
+    concurrent_vector_iterator(Container* container, size_t n_elem):
+        container_(container),
+        n_elem_(n_elem){}
+
+    concurrent_vector_iterator(const concurrent_vector_iterator& other) = default;
+
+    concurrent_vector_iterator& operator =(const concurrent_vector_iterator& other) = default;
+
+    ~concurrent_vector_iterator() = default;
+
+    reference operator *() const
+    { return (*container_)[n_elem_]; }
+
+    pointer operator ->() const
+    { return &(*container_)[n_elem_]; }
+
+    reference operator [](difference_type idx) const
+    { return (*container_)[n_elem_ + idx]; }
+
+    concurrent_vector_iterator& operator ++() {
+        n_elem_++;
+        return *this;
+    }
+
+    concurrent_vector_iterator operator ++(int)
+    { return concurrent_vector_iterator(container_, n_elem_++); }
+
+    concurrent_vector_iterator& operator --() {
+        n_elem_--;
+        return *this;
+    }
+
+    concurrent_vector_iterator operator --(int)
+    { return concurrent_vector_iterator(container_, n_elem_--); }
+
+    concurrent_vector_iterator  operator +(difference_type offset) const
+    { return concurrent_vector_iterator(container_, n_elem_ + offset); }
+
+    concurrent_vector_iterator& operator +=(difference_type offset){
+        n_elem_ += offset;
+        return *this;
+    }
+
+    concurrent_vector_iterator operator -(difference_type offset) const
+    { return concurrent_vector_iterator(container_, n_elem_ - offset); }
+
+    concurrent_vector_iterator& operator -=(difference_type offset) {
+        n_elem_ -= offset;
+        return *this;
+    }
+
+    difference_type operator -(const concurrent_vector_iterator& other) const
+    { return difference_type(n_elem_ - other.n_elem_); }
+
+    bool operator ==(const concurrent_vector_iterator& other) const
+    { return n_elem_ == other.n_elem_; }
+
+    bool operator !=(const concurrent_vector_iterator& other) const
+    { return n_elem_ != other.n_elem_; }
+
+    bool operator >(const concurrent_vector_iterator& other) const
+    { return n_elem_ > other.n_elem_; }
+
+    bool operator >=(const concurrent_vector_iterator& other) const
+    { return n_elem_ >= other.n_elem_; }
+
+    bool operator <(const concurrent_vector_iterator& other) const
+    { return n_elem_ < other.n_elem_; }
+
+    bool operator <=(const concurrent_vector_iterator& other) const
+    { return n_elem_ <= other.n_elem_; }
+
+private:
+    Container*  container_;
+    size_t      n_elem_;
+};
+
+}; // namespace nstd
+
+#endif // NSTD_CONCURRENT_VECTOR_H
@@ -3,43 +3,225 @@
 
 #include <cstdlib>
 #include <utility>
+#include <new>
+#include <memory>
+#include <string.h>
 #include <stdint.h>
+#include <type_traits>
 
-// TODO: remake under iterators
+// Uninitialized-memory algorithms used by the containers.
+// Every function works on raw storage of n_elems objects and picks at compile time
+// between memcpy/memmove/memset, a plain loop or a no-op depending on the type traits of T.
+// All of them are usable in constant evaluation: there mem* functions are replaced by std::construct_at loops.
+
+namespace nstd{
+
+/// types, which could be moved to other place by memmove with the source forgotten (no destructor call).
+/// Trivially copyable types are, others, which only own the heap through plain pointers, could be marked by specialization
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template<typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+/// destroys n_elems objects starting from data, no-op for trivially destructible types
+template<typename T>
+constexpr void destroy_n(T* data, size_t n_elems) {
+    if constexpr(!std::is_trivially_destructible_v<T>) {
+        for(size_t i = 0; i < n_elems; i++) {
+            std::destroy_at(data + i);
+        }
+    }
+}
+
+/// value-initializes (T()) n_elems objects in uninitialized storage
+template<typename T>
+constexpr void uninitialized_value_construct_n(T* data, size_t n_elems) {
+    if constexpr(std::is_trivial_v<T>) {
+        if(!std::is_constant_evaluated()) {
+            if(n_elems) memset(static_cast<void*>(data), 0, n_elems * sizeof(T));
+            return;
+        }
+    }
+
+    size_t i = 0;
+    try {
+        for(; i < n_elems; i++) {
+            std::construct_at(data + i);
+        }
+    } catch(...) {
+        destroy_n(data, i);
+        throw;
+    }
+}
+
+/// default-initializes (T, without braces) n_elems objects: trivial types are left with garbage and memory isn't touched
+template<typename T>
+constexpr void uninitialized_default_construct_n(T* data, size_t n_elems) {
+    if constexpr(std::is_trivially_default_constructible_v<T>) {
+        if(!std::is_constant_evaluated()) return;
+    }
+
+    size_t i = 0;
+    try {
+        for(; i < n_elems; i++) {
+            if(std::is_constant_evaluated()) std::construct_at(data + i);
+            else                             ::new (static_cast<void*>(data + i)) T;
+        }
+    } catch(...) {
+        destroy_n(data, i);
+        throw;
+    }
+}
+
+/// copy-constructs n_elems copies of val in uninitialized storage
+template<typename T>
+constexpr void uninitialized_fill_n(T* data, size_t n_elems, const T& val) {
+    if constexpr(std::is_trivially_copyable_v<T> && sizeof(T) == 1) {
+        if(!std::is_constant_evaluated()) {
+            if(n_elems) memset(static_cast<void*>(data), *reinterpret_cast<const uint8_t*>(&val), n_elems);
+            return;
+        }
+    }
+    else if constexpr(std::is_trivially_copyable_v<T>) {
+        if(!std::is_constant_evaluated()) {
+            // no exception handling required, loop is left to the vectorizer
+            T tmp = val;
+            for(size_t i = 0; i < n_elems; i++) {
+                memcpy(static_cast<void*>(data + i), &tmp, sizeof(T));
+            }
+            return;
+        }
+    }
+
+    size_t i = 0;
+    try {
+        for(; i < n_elems; i++) {
+            std::construct_at(data + i, val);
+        }
+    } catch(...) {
+        destroy_n(data, i);
+        throw;
+    }
+}
+
+/// copy-constructs n_elems objects from [from, from + n_elems) into uninitialized storage, ranges must not overlap
 template<typename T>
-void clear_mem(T* data, size_t init_pos, size_t n_elems) {
-    for(uint i = 0; i < n_elems; i++){
-        (*(data + (init_pos + i))).~T();
+constexpr void uninitialized_copy_n(const T* from, size_t n_elems, T* to) {
+    if constexpr(std::is_trivially_copyable_v<T>) {
+        if(!std::is_constant_evaluated()) {
+            if(n_elems) memcpy(static_cast<void*>(to), from, n_elems * sizeof(T));
+            return;
+        }
+    }
+
+    size_t i = 0;
+    try {
+        for(; i < n_elems; i++) {
+            std::construct_at(to + i, from[i]);
+        }
+    } catch(...) {
+        destroy_n(to, i);
+        throw;
     }
 }
 
+/// move-constructs n_elems objects from [from, from + n_elems) into uninitialized storage, ranges must not overlap
 template<typename T>
-void set_mem(T* data, size_t init_pos, size_t n_elems) {
-    for(uint i = 0; i < n_elems; i++) {
-        new (data + (init_pos + i)) T();
+constexpr void uninitialized_move_n(T* from, size_t n_elems, T* to) {
+    if constexpr(std::is_trivially_copyable_v<T>) {
+        if(!std::is_constant_evaluated()) {
+            if(n_elems) memcpy(static_cast<void*>(to), from, n_elems * sizeof(T));
+            return;
+        }
+    }
+
+    size_t i = 0;
+    try {
+        for(; i < n_elems; i++) {
+            std::construct_at(to + i, std::move(from[i]));
+        }
+    } catch(...) {
+        destroy_n(to, i);
+        throw;
+    }
+}
+
+template<typename Pt>
+class ptlike_iterator;
+
+/// iterators over contiguous storage of the containers, which could be turned into pointers
+template<typename It>
+struct is_ptlike_iterator : std::false_type {};
+
+template<typename Pt>
+struct is_ptlike_iterator<ptlike_iterator<Pt>> : std::true_type {};
+
+/// copy-constructs n_elems objects from the range starting at the iterator start into uninitialized storage.
+/// Pointers and ptlike_iterator of T take the path of uninitialized_copy_n, other iterators are copied one by one
+template<typename ItFrom, typename T>
+constexpr void uninitialized_copy_iter_n(ItFrom start, size_t n_elems, T* to) {
+    if constexpr(std::is_convertible_v<ItFrom, const T*>) {
+        uninitialized_copy_n(static_cast<const T*>(start), n_elems, to);
+    }
+    else if constexpr(is_ptlike_iterator<ItFrom>::value && std::is_convertible_v<typename ItFrom::pointer, const T*>) {
+        if(n_elems) uninitialized_copy_n(static_cast<const T*>(&*start), n_elems, to);
+    }
+    else {
+        size_t i = 0;
+        try {
+            for(; i < n_elems; i++, ++start) {
+                std::construct_at(to + i, *start);
+            }
+        } catch(...) {
+            destroy_n(to, i);
+            throw;
+        }
     }
 }
 
+/// true if ptr points into [first, first + n_elems). Pointers to different blocks can't be ordered
+/// in constant evaluation, so there they are compared for equality only
 template<typename T>
-void set_mem(T* data, size_t init_pos, size_t n_elems, const T& val) {
-    for(uint i = 0; i < n_elems; i++) {
-        new (data + (init_pos + i)) T(val);
+constexpr bool is_in_range(const T* ptr, const T* first, size_t n_elems) {
+    if(std::is_constant_evaluated()) {
+        for(size_t i = 0; i < n_elems; i++) {
+            if(first + i == ptr) return true;
+        }
+        return false;
     }
+
+    return ptr >= first && ptr < first + n_elems;
 }
 
+/// moves n_elems objects to uninitialized storage and destroys the sources.
+/// Ranges may overlap: after the call [to, to + n_elems) is alive and the rest of [from, from + n_elems) is raw memory
 template<typename T>
-void set_mem(T* data, size_t init_pos, T* from, size_t from_init_pos, size_t n_elems, bool is_move = false) {
-    
-    if(!is_move) {
-        for(uint i = 0; i < n_elems; i++) {
-            new (data + (init_pos + i)) T(from[from_init_pos + i]);
+constexpr void uninitialized_relocate_n(T* from, size_t n_elems, T* to) {
+    if(from == to || n_elems == 0) return;
+
+    if constexpr(is_trivially_relocatable_v<T>) {
+        if(!std::is_constant_evaluated()) {
+            memmove(static_cast<void*>(to), from, n_elems * sizeof(T));
+            return;
         }
     }
-    else{
-        for(uint i = 0; i < n_elems; i++) {
-            new (data + (init_pos + i)) T(std::move(from[from_init_pos + i]));
+
+    // copying forward is safe unless the destination starts inside the source
+    if(!is_in_range(to, from, n_elems)) {
+        for(size_t i = 0; i < n_elems; i++) {
+            std::construct_at(to + i, std::move(from[i]));
+            std::destroy_at(from + i);
+        }
+    }
+    else {
+        for(size_t i = n_elems; i > 0; i--) {
+            std::construct_at(to + i - 1, std::move(from[i - 1]));
+            std::destroy_at(from + i - 1);
         }
     }
 }
 
+}; // namespace nstd
+
 #endif // ALLOCATION_H
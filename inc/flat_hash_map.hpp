@@ -0,0 +1,596 @@
+#ifndef NSTD_FLAT_HASH_MAP_H
+#define NSTD_FLAT_HASH_MAP_H
+
+#include <cstdlib>
+#include <stdexcept>
+#include <functional>
+#include <utility>
+#include <memory>
+#include <string.h>
+#include <stdint.h>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#include "construction.hpp"
+#include "iterator.hpp"
+#include "move_semantics.hpp"
+#include "flat_map.hpp"
+
+namespace nstd{
+
+/// control bytes of flat_hash_map: EMPTY or 7 bits of the hash of the key in the slot
+static const int8_t HASH_CTRL_EMPTY = -128;
+
+/// WIDTH control bytes compared at once: 32 with AVX2, 16 with SSE2, 8 in a word otherwise.
+/// Masks have a bit per byte (SHIFT = 0) or the top bit of every byte (SHIFT = 3)
+struct hash_probe_group {
+#if defined(__AVX2__)
+    static const size_t WIDTH = 32;
+    static const int    SHIFT = 0;
+
+    explicit hash_probe_group(const int8_t* ctrl):
+        ctrl_(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ctrl))){}
+
+    uint64_t match(int8_t h2) const
+    { return uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(ctrl_, _mm256_set1_epi8(h2)))); }
+
+    /// EMPTY is the only negative control byte
+    uint64_t match_empty() const
+    { return uint32_t(_mm256_movemask_epi8(ctrl_)); }
+
+    __m256i ctrl_;
+#elif defined(__SSE2__)
+    static const size_t WIDTH = 16;
+    static const int    SHIFT = 0;
+
+    explicit hash_probe_group(const int8_t* ctrl):
+        ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))){}
+
+    uint64_t match(int8_t h2) const
+    { return uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(h2)))); }
+
+    uint64_t match_empty() const
+    { return uint32_t(_mm_movemask_epi8(ctrl_)); }
+
+    __m128i ctrl_;
+#else
+    static const size_t WIDTH = 8;
+    static const int    SHIFT = 3;
+
+    static const uint64_t LSBS = 0x0101010101010101ull;
+    static const uint64_t MSBS = 0x8080808080808080ull;
+
+    explicit hash_probe_group(const int8_t* ctrl)
+    { memcpy(&ctrl_, ctrl, sizeof(ctrl_)); }
+
+    /// may give false positives, keys are compared anyway
+    uint64_t match(int8_t h2) const {
+        uint64_t diff = ctrl_ ^ (LSBS * uint8_t(h2));
+        return (diff - LSBS) & ~diff & MSBS;
+    }
+
+    uint64_t match_empty() const
+    { return ctrl_ & MSBS; }
+
+    uint64_t ctrl_;
+#endif
+
+    /// position of the lowest set bit of the mask in the group
+    static size_t first(uint64_t mask)
+    { return size_t(__builtin_ctzll(mask)) >> SHIFT; }
+};
+
+template<typename K, typename V, bool IS_CONST>
+class flat_hash_map_iterator;
+
+/// open addressing hash map in the style of Swiss tables: a control byte per slot keeps 7 bits of the hash,
+/// so a probe compares a whole group of them with one SIMD instruction and touches slots only on matches.
+/// Probing is linear with slot granularity: groups are read from the home slot on, control bytes of the first
+/// group are mirrored after the end, so no load is split by the wraparound. Linear probing needs no tombstones:
+/// erase shifts the following elements of the cluster back, and the load factor depends on live elements only.
+/// Slots and control bytes are one block from Alloc. Iterators and references are invalidated by insertion
+/// (rehash) and erasure (shift)
+template<typename K, typename V, typename Hash = std::hash<K>, template <typename> class Alloc = std::allocator,
+         typename KeyEqual = std::equal_to<K>>
+class flat_hash_map : public Alloc<std::pair<K, V>>{
+    typedef std::pair<K, V>     slot_t;
+    typedef hash_probe_group    group_t;
+
+    static const size_t GROUP_WIDTH = group_t::WIDTH;
+    /// capacity is a power of two, never less than a group, so a group never wraps more than once
+    static const size_t MIN_CAPACITY = GROUP_WIDTH;
+
+    static constexpr bool IS_ALLOC_ALWAYS_EQUAL = std::allocator_traits<Alloc<slot_t>>::is_always_equal::value;
+
+public:
+    typedef flat_hash_map_iterator<K, V, false>  iterator;
+    typedef flat_hash_map_iterator<K, V, true>   const_iterator;
+
+    typedef K                                    key_type;
+    typedef V                                    mapped_type;
+    typedef std::pair<K, V>                      value_type;
+
+    /// the table grows, when it is fuller than MAX_LOAD_NUM / MAX_LOAD_DEN
+    static const size_t MAX_LOAD_NUM = 7;
+    static const size_t MAX_LOAD_DEN = 8;
+
+public:
+    flat_hash_map():
+        slots_(NULL),
+        ctrl_(NULL),
+        size_(0),
+        capacity_(0){}
+
+    flat_hash_map(const flat_hash_map& other):
+        Alloc<slot_t>(other),
+        slots_(NULL),
+        ctrl_(NULL),
+        size_(0),
+        capacity_(0)
+    {
+        reserve(other.size_);
+        for(size_t n_slot = 0; n_slot < other.capacity_; n_slot++) {
+            if(other.is_full(n_slot)) insert_unique(other.slots_[n_slot].first, other.slots_[n_slot].second);
+        }
+    }
+
+    flat_hash_map(flat_hash_map&& other):
+        flat_hash_map()
+    { steal(other); }
+
+    template<legacy_input_iterator ItFrom>
+    flat_hash_map(ItFrom start, ItFrom last):
+        flat_hash_map()
+    {
+        if constexpr(legacy_forward_iterator<ItFrom>) reserve(std::distance(start, last));
+
+        for(; start != last; ++start) try_emplace(start->first, start->second);
+    }
+
+    ~flat_hash_map()
+    { release(); }
+
+    flat_hash_map& operator=(const flat_hash_map& other) {
+        flat_hash_map tmp = other;
+        *this = nstd::move(tmp);
+
+        return *this;
+    }
+
+    flat_hash_map& operator=(flat_hash_map&& other) {
+        if(this == &other) return *this;
+
+        clear();
+        steal(other);
+
+        return *this;
+    }
+
+    size_t size() const
+    { return size_; }
+
+    bool empty() const
+    { return size_ == 0; }
+
+    /// number of slots, at most capacity() * MAX_LOAD_NUM / MAX_LOAD_DEN of them are used
+    size_t capacity() const
+    { return capacity_; }
+
+    /// makes room for n_elems without further rehashes, one rehash at most
+    void reserve(size_t n_elems) {
+        if(n_elems == 0) return;
+
+        size_t capacity = capacity_for(n_elems);
+        if(capacity > capacity_) rehash(capacity);
+    }
+
+    /// destroys the elements and keeps the table
+    void clear() {
+        for(size_t n_slot = 0; n_slot < capacity_ && size_; n_slot++) {
+            if(is_full(n_slot)) {
+                std::destroy_at(slots_ + n_slot);
+                size_--;
+            }
+        }
+
+        if(capacity_) memset(ctrl_, HASH_CTRL_EMPTY, capacity_ + GROUP_WIDTH - 1);
+    }
+
+    V& at(const K& key) {
+        size_t n_slot = find_slot(key);
+        if(n_slot == capacity_)
+            throw std::out_of_range("flat_hash_map: no such key");
+
+        return slots_[n_slot].second;
+    }
+
+    const V& at(const K& key) const {
+        size_t n_slot = find_slot(key);
+        if(n_slot == capacity_)
+            throw std::out_of_range("flat_hash_map: no such key");
+
+        return slots_[n_slot].second;
+    }
+
+    V& operator[](const K& key)
+    { return (*try_emplace(key).first).second; }
+
+    V& operator[](K&& key)
+    { return (*try_emplace(nstd::move(key)).first).second; }
+
+    std::pair<iterator, bool> insert(const value_type& pair)
+    { return try_emplace(pair.first, pair.second); }
+
+    std::pair<iterator, bool> insert(value_type&& pair)
+    { return try_emplace(nstd::move(pair.first), nstd::move(pair.second)); }
+
+    /// value is constructed only if the key is absent
+    template<typename KeyArg, typename... Args>
+    std::pair<iterator, bool> try_emplace(KeyArg&& key, Args&&... args) {
+        size_t hash = hash_of(key);
+
+        size_t n_slot = find_slot(key, hash);
+        if(n_slot != capacity_) return {iterator(this, n_slot), false};
+
+        if(size_ + 1 > max_load()) rehash(capacity_for(size_ + 1));
+
+        n_slot = find_empty(hash);
+        std::construct_at(slots_ + n_slot, std::piecewise_construct,
+                          std::forward_as_tuple(nstd::forward<KeyArg>(key)),
+                          std::forward_as_tuple(nstd::forward<Args>(args)...));
+        set_ctrl(n_slot, h2(hash));
+        size_++;
+
+        return {iterator(this, n_slot), true};
+    }
+
+    template<typename KeyArg, typename Arg>
+    std::pair<iterator, bool> insert_or_assign(KeyArg&& key, Arg&& value) {
+        auto [it, is_inserted] = try_emplace(nstd::forward<KeyArg>(key), nstd::forward<Arg>(value));
+        if(!is_inserted) (*it).second = nstd::forward<Arg>(value);
+
+        return {it, is_inserted};
+    }
+
+    size_t erase(const K& key) {
+        size_t n_slot = find_slot(key);
+        if(n_slot == capacity_) return 0;
+
+        erase_slot(n_slot);
+        return 1;
+    }
+
+    /// elements after pos may be shifted into its place, even from the start of the table,
+    /// so no iterator is returned. Erasure while walking over the map is done by erase_if()
+    void erase(const_iterator pos)
+    { erase_slot(pos.slot()); }
+
+    /// erases the elements, for which pred(std::pair<const K&, V&>) is true, each one is checked once.
+    /// The walk starts after an empty slot, so the shifts never bring back already checked elements
+    template<typename Pred>
+    size_t erase_if(Pred pred) {
+        if(size_ == 0) return 0;
+
+        size_t mask = capacity_ - 1;
+        size_t n_start = find_empty(0) & mask;
+        size_t old_size = size_;
+
+        for(size_t n_step = 1; n_step <= capacity_; n_step++) {
+            size_t n_slot = (n_start + n_step) & mask;
+
+            // the slot is checked again, if an element is shifted into it
+            while(is_full(n_slot) && pred(std::pair<const K&, V&>(slots_[n_slot].first, slots_[n_slot].second))) {
+                erase_slot(n_slot);
+            }
+        }
+
+        return old_size - size_;
+    }
+
+    iterator find(const K& key)
+    { return iterator(this, find_slot(key)); }
+
+    const_iterator find(const K& key) const
+    { return const_iterator(this, find_slot(key)); }
+
+    bool contains(const K& key) const
+    { return find_slot(key) != capacity_; }
+
+    size_t count(const K& key) const
+    { return contains(key); }
+
+    iterator begin()
+    { return iterator(this, next_full(0)); }
+
+    const_iterator begin() const
+    { return cbegin(); }
+
+    const_iterator cbegin() const
+    { return const_iterator(this, next_full(0)); }
+
+    iterator end()
+    { return iterator(this, capacity_); }
+
+    const_iterator end() const
+    { return cend(); }
+
+    const_iterator cend() const
+    { return const_iterator(this, capacity_); }
+
+    void swap(flat_hash_map& other) {
+        if constexpr(IS_ALLOC_ALWAYS_EQUAL) {
+            std::swap(slots_,    other.slots_);
+            std::swap(ctrl_,     other.ctrl_);
+            std::swap(size_,     other.size_);
+            std::swap(capacity_, other.capacity_);
+        }
+        else {
+            flat_hash_map tmp(nstd::move(other));
+            other = nstd::move(*this);
+            *this = nstd::move(tmp);
+        }
+    }
+
+private:
+    friend class flat_hash_map_iterator<K, V, false>;
+    friend class flat_hash_map_iterator<K, V, true>;
+
+    /// std::hash of integers is identity, so the bits are mixed before they are split into the home and h2
+    static size_t hash_of(const K& key) {
+        __uint128_t product = __uint128_t(Hash()(key)) * 0x9E3779B97F4A7C15ull;
+        return size_t(product) ^ size_t(product >> 64);
+    }
+
+    static int8_t h2(size_t hash)
+    { return int8_t(hash & 0x7F); }
+
+    size_t home(size_t hash) const
+    { return (hash >> 7) & (capacity_ - 1); }
+
+    size_t max_load() const
+    { return capacity_ / MAX_LOAD_DEN * MAX_LOAD_NUM; }
+
+    static size_t capacity_for(size_t n_elems) {
+        size_t capacity = MIN_CAPACITY;
+        while(capacity / MAX_LOAD_DEN * MAX_LOAD_NUM < n_elems) capacity *= 2;
+
+        return capacity;
+    }
+
+    bool is_full(size_t n_slot) const
+    { return ctrl_[n_slot] != HASH_CTRL_EMPTY; }
+
+    /// control bytes of the first group are mirrored after the last slot
+    void set_ctrl(size_t n_slot, int8_t ctrl) {
+        ctrl_[n_slot] = ctrl;
+        if(n_slot < GROUP_WIDTH - 1) ctrl_[capacity_ + n_slot] = ctrl;
+    }
+
+    size_t next_full(size_t n_slot) const {
+        while(n_slot < capacity_ && !is_full(n_slot)) n_slot++;
+        return n_slot;
+    }
+
+    size_t find_slot(const K& key) const
+    { return find_slot(key, hash_of(key)); }
+
+    /// capacity_ if there is no such key. Probing stops at the first group with an empty slot:
+    /// the cluster of the key ends there
+    size_t find_slot(const K& key, size_t hash) const {
+        if(size_ == 0) return capacity_;
+
+        size_t mask = capacity_ - 1;
+        int8_t tag  = h2(hash);
+
+        for(size_t pos = home(hash);; pos = (pos + GROUP_WIDTH) & mask) {
+            group_t group(ctrl_ + pos);
+
+            for(uint64_t match = group.match(tag); match; match &= match - 1) {
+                size_t n_slot = (pos + group_t::first(match)) & mask;
+                if(KeyEqual()(slots_[n_slot].first, key)) return n_slot;
+            }
+
+            if(group.match_empty()) return capacity_;
+        }
+    }
+
+    /// first empty slot from the home on, load factor guarantees there is one
+    size_t find_empty(size_t hash) const {
+        size_t mask = capacity_ - 1;
+
+        for(size_t pos = home(hash);; pos = (pos + GROUP_WIDTH) & mask) {
+            uint64_t empty = group_t(ctrl_ + pos).match_empty();
+            if(empty) return (pos + group_t::first(empty)) & mask;
+        }
+    }
+
+    /// key is known to be absent and there is room, used by rehash and copying
+    void insert_unique(const K& key, const V& value) {
+        size_t hash = hash_of(key);
+        size_t n_slot = find_empty(hash);
+
+        std::construct_at(slots_ + n_slot, key, value);
+        set_ctrl(n_slot, h2(hash));
+        size_++;
+    }
+
+    /// backward shift: elements of the cluster after the hole move into it, unless the hole is before their home
+    void erase_slot(size_t n_hole) {
+        size_t mask = capacity_ - 1;
+
+        std::destroy_at(slots_ + n_hole);
+        size_--;
+
+        for(size_t n_slot = (n_hole + 1) & mask; is_full(n_slot); n_slot = (n_slot + 1) & mask) {
+            size_t n_home = home(hash_of(slots_[n_slot].first));
+
+            // distances from the home: the element may move only closer to it
+            if(((n_slot - n_home) & mask) < ((n_slot - n_hole) & mask)) continue;
+
+            uninitialized_relocate_n(slots_ + n_slot, 1, slots_ + n_hole);
+            set_ctrl(n_hole, ctrl_[n_slot]);
+            n_hole = n_slot;
+        }
+
+        set_ctrl(n_hole, HASH_CTRL_EMPTY);
+    }
+
+    /// slots and control bytes in one block: capacity slots, then capacity + GROUP_WIDTH - 1 bytes
+    static size_t block_slots(size_t capacity)
+    { return capacity + (capacity + GROUP_WIDTH - 1 + sizeof(slot_t) - 1) / sizeof(slot_t); }
+
+    void rehash(size_t new_capacity) {
+        slot_t* new_slots = this->allocate(block_slots(new_capacity));
+
+        slot_t* old_slots    = slots_;
+        int8_t* old_ctrl     = ctrl_;
+        size_t  old_capacity = capacity_;
+
+        slots_    = new_slots;
+        ctrl_     = reinterpret_cast<int8_t*>(new_slots + new_capacity);
+        capacity_ = new_capacity;
+        memset(ctrl_, HASH_CTRL_EMPTY, new_capacity + GROUP_WIDTH - 1);
+
+        // keys are known to be unique, so elements are relocated to their first empty slots without lookups
+        for(size_t n_slot = 0; n_slot < old_capacity; n_slot++) {
+            if(old_ctrl[n_slot] == HASH_CTRL_EMPTY) continue;
+
+            size_t hash = hash_of(old_slots[n_slot].first);
+            size_t n_new = find_empty(hash);
+
+            uninitialized_relocate_n(old_slots + n_slot, 1, slots_ + n_new);
+            set_ctrl(n_new, h2(hash));
+        }
+
+        if(old_slots) this->deallocate(old_slots, block_slots(old_capacity));
+    }
+
+    void release() {
+        clear();
+
+        if(slots_) this->deallocate(slots_, block_slots(capacity_));
+        slots_    = NULL;
+        ctrl_     = NULL;
+        capacity_ = 0;
+    }
+
+    // this must be empty
+    void steal(flat_hash_map& other) {
+        if constexpr(IS_ALLOC_ALWAYS_EQUAL) {
+            release();
+
+            std::swap(slots_,    other.slots_);
+            std::swap(ctrl_,     other.ctrl_);
+            std::swap(size_,     other.size_);
+            std::swap(capacity_, other.capacity_);
+        }
+        else {
+            // table belongs to the other's allocator, so elements are moved one by one
+            reserve(other.size_);
+
+            for(size_t n_slot = 0; n_slot < other.capacity_; n_slot++) {
+                if(other.is_full(n_slot))
+                    try_emplace(nstd::move(other.slots_[n_slot].first), nstd::move(other.slots_[n_slot].second));
+            }
+            other.clear();
+        }
+    }
+
+private:
+    slot_t*   slots_;
+    int8_t*   ctrl_;
+    size_t    size_;
+    size_t    capacity_;
+};
+
+/// forward iterator over the full slots, dereferences to std::pair of references as flat_map_iterator
+template<typename K, typename V, bool IS_CONST>
+class flat_hash_map_iterator
+{
+    typedef std::conditional_t<IS_CONST, const V, V>  mapped_t;
+
+public:
+    typedef std::forward_iterator_tag                 iterator_category;
+    typedef std::pair<const K&, mapped_t&>            value_type;
+    typedef ptrdiff_t                                 difference_type;
+    typedef std::pair<const K&, mapped_t&>            reference;
+    typedef typename flat_map_iterator<K, mapped_t>::pointer pointer;
+
+public:
+    flat_hash_map_iterator():
+        slots_(NULL),
+        ctrl_(NULL),
+        n_slot_(0),
+        capacity_(0){}
+
+    template<typename Map>
+    flat_hash_map_iterator(Map* map, size_t n_slot):
+        slots_(map->slots_),
+        ctrl_(map->ctrl_),
+        n_slot_(n_slot),
+        capacity_(map->capacity_){}
+
+    /// iterator to const_iterator
+    template<bool IS_OTHER_CONST> requires (IS_CONST && !IS_OTHER_CONST)
+    flat_hash_map_iterator(const flat_hash_map_iterator<K, V, IS_OTHER_CONST>& other):
+        slots_(other.slots_),
+        ctrl_(other.ctrl_),
+        n_slot_(other.n_slot_),
+        capacity_(other.capacity_){}
+
+    flat_hash_map_iterator(const flat_hash_map_iterator& other) = default;
+
+    flat_hash_map_iterator& operator =(const flat_hash_map_iterator& other) = default;
+
+    ~flat_hash_map_iterator() = default;
+
+    reference operator *() const
+    { return reference(slots_[n_slot_].first, slots_[n_slot_].second); }
+
+    pointer operator ->() const
+    { return pointer{**this}; }
+
+    flat_hash_map_iterator& operator ++() {
+        n_slot_++;
+        while(n_slot_ < capacity_ && ctrl_[n_slot_] == HASH_CTRL_EMPTY) n_slot_++;
+
+        return *this;
+    }
+
+    flat_hash_map_iterator operator ++(int) {
+        flat_hash_map_iterator old = *this;
+        ++*this;
+
+        return old;
+    }
+
+    bool operator ==(const flat_hash_map_iterator& other) const
+    { return n_slot_ == other.n_slot_; }
+
+    bool operator !=(const flat_hash_map_iterator& other) const
+    { return n_slot_ != other.n_slot_; }
+
+    size_t slot() const
+    { return n_slot_; }
+
+private:
+    template<typename, typename, bool>
+    friend class flat_hash_map_iterator;
+
+    std::pair<K, V>*  slots_;
+    const int8_t*     ctrl_;
+    size_t            n_slot_;
+    size_t            capacity_;
+};
+
+template<typename K, typename V, typename Hash, template <typename> class Alloc, typename KeyEqual, typename Pred>
+size_t erase_if(flat_hash_map<K, V, Hash, Alloc, KeyEqual>& map, Pred pred)
+{ return map.erase_if(pred); }
+
+template<typename K, typename V, typename Hash, template <typename> class Alloc, typename KeyEqual>
+void swap(flat_hash_map<K, V, Hash, Alloc, KeyEqual>& lhs, flat_hash_map<K, V, Hash, Alloc, KeyEqual>& rhs)
+{ lhs.swap(rhs); }
+
+}; // namespace nstd
+
+#endif // NSTD_FLAT_HASH_MAP_H
@@ -0,0 +1,428 @@
+#ifndef NSTD_FLAT_MAP_H
+#define NSTD_FLAT_MAP_H
+
+#include <cstdlib>
+#include <stdexcept>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include "vector.hpp"
+#include "flat_set.hpp"
+#include "iterator.hpp"
+#include "move_semantics.hpp"
+
+namespace nstd{
+
+/// walks keys and values of flat_map together, dereferences to std::pair of references
+template<typename K, typename V>
+class flat_map_iterator
+{
+public:
+    typedef std::random_access_iterator_tag          iterator_category;
+    typedef std::pair<const K&, V&>                  value_type;
+    typedef ptrdiff_t                                difference_type;
+    typedef std::pair<const K&, V&>                  reference;
+
+    /// operator-> has to return something with ->, so the pair of references is kept in it
+    struct pointer {
+        reference ref_;
+
+        reference* operator ->()
+        { return &ref_; }
+    };
+
+public:
+    flat_map_iterator():
+        key_(NULL),
+        value_(NULL){}
+
+    flat_map_iterator(const K* key, V* value):
+        key_(key),
+        value_(value){}
+
+    /// iterator to const_iterator
+    template<typename OtherV> requires std::is_same_v<const OtherV, V>
+    flat_map_iterator(const flat_map_iterator<K, OtherV>& other):
+        key_(other.key()),
+        value_(other.value()){}
+
+    flat_map_iterator(const flat_map_iterator& other) = default;
+
+    flat_map_iterator& operator =(const flat_map_iterator& other) = default;
+
+    ~flat_map_iterator() = default;
+
+    reference operator *() const
+    { return reference(*key_, *value_); }
+
+    pointer operator ->() const
+    { return pointer{**this}; }
+
+    reference operator [](difference_type idx) const
+    { return reference(key_[idx], value_[idx]); }
+
+    flat_map_iterator& operator ++() {
+        key_++;
+        value_++;
+        return *this;
+    }
+
+    flat_map_iterator operator ++(int)
+    { return flat_map_iterator(key_++, value_++); }
+
+    flat_map_iterator& operator --() {
+        key_--;
+        value_--;
+        return *this;
+    }
+
+    flat_map_iterator operator --(int)
+    { return flat_map_iterator(key_--, value_--); }
+
+    flat_map_iterator  operator +(difference_type offset) const
+    { return flat_map_iterator(key_ + offset, value_ + offset); }
+
+    flat_map_iterator& operator +=(difference_type offset){
+        key_   += offset;
+        value_ += offset;
+        return *this;
+    }
+
+    flat_map_iterator operator -(difference_type offset) const
+    { return flat_map_iterator(key_ - offset, value_ - offset); }
+
+    flat_map_iterator& operator -=(difference_type offset) {
+        key_   -= offset;
+        value_ -= offset;
+        return *this;
+    }
+
+    difference_type operator -(const flat_map_iterator& other) const
+    { return key_ - other.key_; }
+
+    bool operator ==(const flat_map_iterator& other) const
+    { return key_ == other.key_; }
+
+    bool operator !=(const flat_map_iterator& other) const
+    { return key_ != other.key_; }
+
+    bool operator >(const flat_map_iterator& other) const
+    { return key_ > other.key_; }
+
+    bool operator >=(const flat_map_iterator& other) const
+    { return key_ >= other.key_; }
+
+    bool operator <(const flat_map_iterator& other) const
+    { return key_ < other.key_; }
+
+    bool operator <=(const flat_map_iterator& other) const
+    { return key_ <= other.key_; }
+
+    const K* key() const
+    { return key_; }
+
+    V* value() const
+    { return value_; }
+
+private:
+    const K* key_;
+    V*       value_;
+};
+
+/// map on two sorted nstd::vectors: keys are searched without touching values, so a lookup reads only
+/// the keys array, values are reached by the found index. Costs are as of flat_set
+template<typename K, typename V, typename Compare = std::less<K>, template <typename> class Alloc = std::allocator>
+class flat_map{
+public:
+    typedef vector<K, Alloc>                         key_container_type;
+    typedef vector<V, Alloc>                         mapped_container_type;
+
+    typedef flat_map_iterator<K, V>                  iterator;
+    typedef flat_map_iterator<K, const V>            const_iterator;
+
+    typedef K                                        key_type;
+    typedef V                                        mapped_type;
+    typedef std::pair<K, V>                          value_type;
+
+public:
+    flat_map() = default;
+
+    explicit flat_map(const Compare& comp):
+        keys_(),
+        values_(),
+        comp_(comp){}
+
+    /// range of pairs, for equal keys the first one is kept
+    template<legacy_input_iterator ItFrom>
+    flat_map(ItFrom start, ItFrom last, const Compare& comp = Compare()):
+        keys_(),
+        values_(),
+        comp_(comp)
+    { insert_range(start, last); }
+
+    template<legacy_input_iterator ItFrom>
+    flat_map(sorted_unique_t, ItFrom start, ItFrom last, const Compare& comp = Compare()):
+        keys_(),
+        values_(),
+        comp_(comp)
+    {
+        if constexpr(legacy_forward_iterator<ItFrom>) {
+            size_t n_elems = std::distance(start, last);
+            keys_.reserve(n_elems);
+            values_.reserve(n_elems);
+        }
+
+        for(; start != last; ++start) {
+            keys_.push_back(start->first);
+            values_.push_back(start->second);
+        }
+    }
+
+    /// keys and values are taken as is, they must be of the same length
+    flat_map(sorted_unique_t, key_container_type keys, mapped_container_type values, const Compare& comp = Compare()):
+        keys_(nstd::move(keys)),
+        values_(nstd::move(values)),
+        comp_(comp)
+    {
+        if(keys_.size() != values_.size())
+            throw std::invalid_argument("flat_map: keys and values differ in length");
+    }
+
+    size_t size() const
+    { return keys_.size(); }
+
+    bool empty() const
+    { return keys_.empty(); }
+
+    void reserve(size_t capacity) {
+        keys_.reserve(capacity);
+        values_.reserve(capacity);
+    }
+
+    void clear() {
+        keys_.clear();
+        values_.clear();
+    }
+
+    const key_container_type& keys() const
+    { return keys_; }
+
+    const mapped_container_type& values() const
+    { return values_; }
+
+    V& at(const K& key) {
+        size_t n_pos = find_index(key);
+        if(n_pos == keys_.size())
+            throw std::out_of_range("flat_map: no such key");
+
+        return values_[n_pos];
+    }
+
+    const V& at(const K& key) const {
+        size_t n_pos = find_index(key);
+        if(n_pos == keys_.size())
+            throw std::out_of_range("flat_map: no such key");
+
+        return values_[n_pos];
+    }
+
+    V& operator[](const K& key)
+    { return (*try_emplace(key).first).second; }
+
+    V& operator[](K&& key)
+    { return (*try_emplace(nstd::move(key)).first).second; }
+
+    std::pair<iterator, bool> insert(const value_type& pair)
+    { return try_emplace(pair.first, pair.second); }
+
+    std::pair<iterator, bool> insert(value_type&& pair)
+    { return try_emplace(nstd::move(pair.first), nstd::move(pair.second)); }
+
+    /// value is constructed only if the key is absent
+    template<typename KeyArg, typename... Args>
+    std::pair<iterator, bool> try_emplace(KeyArg&& key, Args&&... args) {
+        size_t n_pos = lower_bound_index(key);
+        if(n_pos != keys_.size() && !comp_(key, keys_[n_pos]))
+            return {begin() + n_pos, false};
+
+        insert_at(n_pos, nstd::forward<KeyArg>(key), V(nstd::forward<Args>(args)...));
+        return {begin() + n_pos, true};
+    }
+
+    template<typename KeyArg, typename Arg>
+    std::pair<iterator, bool> insert_or_assign(KeyArg&& key, Arg&& value) {
+        size_t n_pos = lower_bound_index(key);
+        if(n_pos != keys_.size() && !comp_(key, keys_[n_pos])) {
+            values_[n_pos] = nstd::forward<Arg>(value);
+            return {begin() + n_pos, false};
+        }
+
+        insert_at(n_pos, nstd::forward<KeyArg>(key), V(nstd::forward<Arg>(value)));
+        return {begin() + n_pos, true};
+    }
+
+    /// appends the pairs, sorts them and merges with the old ones in one pass. Keys already present keep their values
+    template<legacy_input_iterator ItFrom>
+    void insert_range(ItFrom start, ItFrom last) {
+        vector<value_type, Alloc> pairs;
+        for(; start != last; ++start) {
+            pairs.emplace_back(start->first, start->second);
+        }
+        if(pairs.empty()) return;
+
+        value_type* added = pairs.data();
+        size_t n_added = pairs.size();
+
+        auto key_less = [this](const value_type& lhs, const value_type& rhs) { return comp_(lhs.first, rhs.first); };
+        std::stable_sort(added, added + n_added, key_less);
+
+        size_t n_old = keys_.size();
+        key_container_type    keys;
+        mapped_container_type values;
+        keys.reserve(n_old + n_added);
+        values.reserve(n_old + n_added);
+
+        // one pass over both sorted sequences, of equal keys the old one or the first added one wins
+        size_t n_cur = 0, n_add = 0;
+        while(n_add < n_added) {
+            const K& key = added[n_add].first;
+
+            while(n_cur < n_old && comp_(keys_[n_cur], key)) {
+                keys.push_back(nstd::move(keys_[n_cur]));
+                values.push_back(nstd::move(values_[n_cur]));
+                n_cur++;
+            }
+
+            bool is_present = (n_cur < n_old && !comp_(key, keys_[n_cur])) ||
+                              (!keys.empty() && !comp_(keys.back(), key));
+            if(!is_present) {
+                keys.push_back(nstd::move(added[n_add].first));
+                values.push_back(nstd::move(added[n_add].second));
+            }
+            n_add++;
+        }
+        for(; n_cur < n_old; n_cur++) {
+            keys.push_back(nstd::move(keys_[n_cur]));
+            values.push_back(nstd::move(values_[n_cur]));
+        }
+
+        keys_   = nstd::move(keys);
+        values_ = nstd::move(values);
+    }
+
+    template<typename Range>
+    void insert_range(Range&& range)
+    { insert_range(std::begin(range), std::end(range)); }
+
+    size_t erase(const K& key) {
+        size_t n_pos = find_index(key);
+        if(n_pos == keys_.size()) return 0;
+
+        erase_at(n_pos);
+        return 1;
+    }
+
+    iterator erase(const_iterator pos) {
+        size_t n_pos = pos - cbegin();
+        erase_at(n_pos);
+
+        return begin() + n_pos;
+    }
+
+    iterator find(const K& key)
+    { return begin() + find_index(key); }
+
+    const_iterator find(const K& key) const
+    { return cbegin() + find_index(key); }
+
+    bool contains(const K& key) const
+    { return find_index(key) != keys_.size(); }
+
+    size_t count(const K& key) const
+    { return contains(key); }
+
+    iterator lower_bound(const K& key)
+    { return begin() + lower_bound_index(key); }
+
+    const_iterator lower_bound(const K& key) const
+    { return cbegin() + lower_bound_index(key); }
+
+    iterator upper_bound(const K& key)
+    { return begin() + upper_bound_index(key); }
+
+    const_iterator upper_bound(const K& key) const
+    { return cbegin() + upper_bound_index(key); }
+
+    iterator begin()
+    { return iterator(keys_.data(), values_.data()); }
+
+    const_iterator begin() const
+    { return cbegin(); }
+
+    const_iterator cbegin() const
+    { return const_iterator(keys_.data(), values_.data()); }
+
+    iterator end()
+    { return begin() + keys_.size(); }
+
+    const_iterator end() const
+    { return cend(); }
+
+    const_iterator cend() const
+    { return cbegin() + keys_.size(); }
+
+    void swap(flat_map& other) {
+        keys_.swap(other.keys_);
+        values_.swap(other.values_);
+        std::swap(comp_, other.comp_);
+    }
+
+private:
+    size_t lower_bound_index(const K& key) const
+    { return flat_lower_bound(keys_.data(), keys_.size(), key, comp_); }
+
+    size_t upper_bound_index(const K& key) const {
+        size_t n_pos = lower_bound_index(key);
+        if(n_pos != keys_.size() && !comp_(key, keys_[n_pos])) n_pos++;
+
+        return n_pos;
+    }
+
+    /// size() if there is no such key
+    size_t find_index(const K& key) const {
+        size_t n_pos = lower_bound_index(key);
+        if(n_pos == keys_.size() || comp_(key, keys_[n_pos])) return keys_.size();
+
+        return n_pos;
+    }
+
+    template<typename KeyArg>
+    void insert_at(size_t n_pos, KeyArg&& key, V&& value) {
+        keys_.insert(keys_.begin() + n_pos, K(nstd::forward<KeyArg>(key)));
+
+        try {
+            values_.insert(values_.begin() + n_pos, nstd::move(value));
+        } catch(...) {
+            keys_.erase(keys_.begin() + n_pos);
+            throw;
+        }
+    }
+
+    void erase_at(size_t n_pos) {
+        keys_.erase(keys_.begin() + n_pos);
+        values_.erase(values_.begin() + n_pos);
+    }
+
+private:
+    key_container_type            keys_;
+    mapped_container_type         values_;
+    [[no_unique_address]] Compare comp_;
+};
+
+template<typename K, typename V, typename Compare, template <typename> class Alloc>
+void swap(flat_map<K, V, Compare, Alloc>& lhs, flat_map<K, V, Compare, Alloc>& rhs)
+{ lhs.swap(rhs); }
+
+}; // namespace nstd
+
+#endif // NSTD_FLAT_MAP_H
@@ -0,0 +1,249 @@
+#ifndef NSTD_FLAT_SET_H
+#define NSTD_FLAT_SET_H
+
+#include <cstdlib>
+#include <stdexcept>
+#include <functional>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include "vector.hpp"
+#include "iterator.hpp"
+#include "move_semantics.hpp"
+
+namespace nstd{
+
+/// tag for constructors of flat containers: input is already sorted and has no equal keys, so it is taken as is
+struct sorted_unique_t { explicit sorted_unique_t() = default; };
+inline constexpr sorted_unique_t sorted_unique{};
+
+/// index of the first key, which is not less than key. Cheap keys (numbers, pointers) are searched without branches:
+/// the loop always halves the range and the choice compiles to cmov, both possible next probes are prefetched,
+/// so large tables wait for memory instead of mispredictions. Other keys go to std::lower_bound
+template<typename K, typename Compare>
+size_t flat_lower_bound(const K* keys, size_t n_keys, const K& key, const Compare& comp) {
+    if constexpr(std::is_arithmetic_v<K> || std::is_pointer_v<K>) {
+        if(n_keys == 0) return 0;
+
+        const K* base = keys;
+        while(n_keys > 1) {
+            size_t half = n_keys / 2;
+
+            __builtin_prefetch(base + half / 2);
+            __builtin_prefetch(base + half + half / 2);
+
+            base = comp(base[half], key) ? base + half : base;
+            n_keys -= half;
+        }
+
+        return (base - keys) + comp(*base, key);
+    }
+    else {
+        return std::lower_bound(keys, keys + n_keys, key, comp) - keys;
+    }
+}
+
+/// set on a sorted nstd::vector: lookups are binary searches over contiguous keys, iteration is a linear scan.
+/// Insertion and erasure of single keys are O(n), bulk insertion is done by insert_range() in O(n + m log m)
+template<typename K, typename Compare = std::less<K>, template <typename> class Alloc = std::allocator>
+class flat_set{
+public:
+    typedef vector<K, Alloc>                                 container_type;
+    typedef typename container_type::const_iterator          iterator;
+    typedef typename container_type::const_iterator          const_iterator;
+
+    typedef K                                                value_type;
+    typedef const K&                                         reference;
+    typedef const K&                                         const_reference;
+
+public:
+    flat_set() = default;
+
+    explicit flat_set(const Compare& comp):
+        keys_(),
+        comp_(comp){}
+
+    template<legacy_input_iterator ItFrom>
+    flat_set(ItFrom start, ItFrom last, const Compare& comp = Compare()):
+        keys_(start, last),
+        comp_(comp)
+    { sort_unique(0); }
+
+    template<legacy_input_iterator ItFrom>
+    flat_set(sorted_unique_t, ItFrom start, ItFrom last, const Compare& comp = Compare()):
+        keys_(start, last),
+        comp_(comp){}
+
+    explicit flat_set(container_type keys, const Compare& comp = Compare()):
+        keys_(nstd::move(keys)),
+        comp_(comp)
+    { sort_unique(0); }
+
+    flat_set(sorted_unique_t, container_type keys, const Compare& comp = Compare()):
+        keys_(nstd::move(keys)),
+        comp_(comp){}
+
+    size_t size() const
+    { return keys_.size(); }
+
+    bool empty() const
+    { return keys_.empty(); }
+
+    void reserve(size_t capacity)
+    { keys_.reserve(capacity); }
+
+    void clear()
+    { keys_.clear(); }
+
+    /// sorted keys
+    const container_type& keys() const
+    { return keys_; }
+
+    /// gives the storage away, the set is left empty
+    container_type extract() {
+        container_type keys = nstd::move(keys_);
+        keys_.clear();
+
+        return keys;
+    }
+
+    std::pair<iterator, bool> insert(const K& key)
+    { return emplace(key); }
+
+    std::pair<iterator, bool> insert(K&& key)
+    { return emplace(nstd::move(key)); }
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        K key(nstd::forward<Args>(args)...);
+
+        size_t n_pos = lower_bound_index(key);
+        if(n_pos != keys_.size() && !comp_(key, keys_[n_pos]))
+            return {cbegin() + n_pos, false};
+
+        keys_.insert(keys_.begin() + n_pos, nstd::move(key));
+        return {cbegin() + n_pos, true};
+    }
+
+    /// appends the keys, sorts them and merges with the old ones in one pass. Keys already present are kept
+    template<legacy_input_iterator ItFrom>
+    void insert_range(ItFrom start, ItFrom last) {
+        size_t old_size = keys_.size();
+
+        keys_.insert(keys_.end(), start, last);
+        sort_unique(old_size);
+    }
+
+    template<typename Range>
+    void insert_range(Range&& range)
+    { insert_range(std::begin(range), std::end(range)); }
+
+    size_t erase(const K& key) {
+        size_t n_pos = lower_bound_index(key);
+        if(n_pos == keys_.size() || comp_(key, keys_[n_pos])) return 0;
+
+        keys_.erase(keys_.begin() + n_pos);
+        return 1;
+    }
+
+    iterator erase(const_iterator pos) {
+        size_t n_pos = pos - cbegin();
+        keys_.erase(keys_.begin() + n_pos);
+
+        return cbegin() + n_pos;
+    }
+
+    template<typename Pred>
+    size_t erase_if(Pred pred)
+    { return keys_.erase_if(pred); }
+
+    const_iterator find(const K& key) const {
+        size_t n_pos = lower_bound_index(key);
+        if(n_pos == keys_.size() || comp_(key, keys_[n_pos])) return cend();
+
+        return cbegin() + n_pos;
+    }
+
+    bool contains(const K& key) const
+    { return find(key) != cend(); }
+
+    size_t count(const K& key) const
+    { return contains(key); }
+
+    const_iterator lower_bound(const K& key) const
+    { return cbegin() + lower_bound_index(key); }
+
+    const_iterator upper_bound(const K& key) const {
+        size_t n_pos = lower_bound_index(key);
+        if(n_pos != keys_.size() && !comp_(key, keys_[n_pos])) n_pos++;
+
+        return cbegin() + n_pos;
+    }
+
+    const_iterator begin() const
+    { return keys_.cbegin(); }
+
+    const_iterator cbegin() const
+    { return keys_.cbegin(); }
+
+    const_iterator end() const
+    { return keys_.cend(); }
+
+    const_iterator cend() const
+    { return keys_.cend(); }
+
+    void swap(flat_set& other) {
+        keys_.swap(other.keys_);
+        std::swap(comp_, other.comp_);
+    }
+
+private:
+    size_t lower_bound_index(const K& key) const
+    { return flat_lower_bound(keys_.data(), keys_.size(), key, comp_); }
+
+    /// [0, n_sorted) is sorted and unique, the rest is arbitrary. The tail is sorted, then both are merged
+    /// into new storage in one pass, the first of equal keys wins
+    void sort_unique(size_t n_sorted) {
+        K* keys = keys_.data();
+        size_t n_keys = keys_.size();
+        if(n_sorted == n_keys) return;
+
+        auto is_equal = [this](const K& lhs, const K& rhs) { return !comp_(lhs, rhs) && !comp_(rhs, lhs); };
+
+        std::stable_sort(keys + n_sorted, keys + n_keys, comp_);
+        size_t n_new = std::unique(keys + n_sorted, keys + n_keys, is_equal) - keys;
+
+        if(n_sorted == 0) {
+            keys_.erase(keys_.begin() + n_new, keys_.end());
+            return;
+        }
+
+        container_type merged;
+        merged.reserve(n_new);
+
+        size_t n_old = 0, n_add = n_sorted;
+        while(n_old < n_sorted && n_add < n_new) {
+            if(comp_(keys[n_add], keys[n_old]))      merged.push_back(nstd::move(keys[n_add++]));
+            else {
+                if(!comp_(keys[n_old], keys[n_add])) n_add++;
+                merged.push_back(nstd::move(keys[n_old++]));
+            }
+        }
+        while(n_old < n_sorted) merged.push_back(nstd::move(keys[n_old++]));
+        while(n_add < n_new)    merged.push_back(nstd::move(keys[n_add++]));
+
+        keys_ = nstd::move(merged);
+    }
+
+private:
+    container_type              keys_;
+    [[no_unique_address]] Compare comp_;
+};
+
+template<typename K, typename Compare, template <typename> class Alloc>
+void swap(flat_set<K, Compare, Alloc>& lhs, flat_set<K, Compare, Alloc>& rhs)
+{ lhs.swap(rhs); }
+
+}; // namespace nstd
+
+#endif // NSTD_FLAT_SET_H
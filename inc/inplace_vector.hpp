@@ -0,0 +1,444 @@
+#ifndef NSTD_INPLACE_VECTOR_H
+#define NSTD_INPLACE_VECTOR_H
+
+#include <cstdlib>
+#include <stdexcept>
+#include <stdint.h>
+#include <assert.h>
+#include <type_traits>
+#include <algorithm>
+#include "construction.hpp"
+#include "iterator.hpp"
+#include "move_semantics.hpp"
+#include "check_policy.hpp"
+
+namespace nstd{
+
+/// vector with capacity N fixed at compile time: elements live inside the object, the heap is never touched.
+/// Insertions past N throw std::length_error, try_push_back() and try_emplace_back() return NULL instead,
+/// unchecked_push_back() and unchecked_emplace_back() expect the caller to know there is room.
+/// For trivially copyable T the whole object is trivially copyable, so it could be memcpy'd as is
+/// (e.g. through shared memory queues)
+template<typename T, size_t N, class CheckPolicy = default_check_policy>
+class inplace_vector{
+    static constexpr bool IS_TRIVIAL = std::is_trivially_copyable_v<T>;
+
+public:
+    typedef ptlike_iterator<T*>                                     iterator;
+    typedef ptlike_iterator<const T*>                               const_iterator;
+    typedef reverse_ra_iterator_default<ptlike_iterator<T*>>        reverse_iterator;
+    typedef reverse_ra_iterator_default<ptlike_iterator<const T*>>  const_reverse_iterator;
+
+    typedef T                                                       value_type;
+    typedef T&                                                      reference;
+    typedef const T&                                                const_reference;
+
+public:
+    inplace_vector():
+        size_(0){}
+
+    explicit inplace_vector(size_t size, const T& def_val = T()):
+        size_(0)
+    {
+        check_room(size);
+
+        uninitialized_fill_n(data(), size, def_val);
+        size_ = size;
+    }
+
+    template<legacy_input_iterator ItFrom>
+    inplace_vector(ItFrom start, ItFrom last):
+        size_(0)
+    {
+        // constructor is not delegated, so partially built vector is cleaned here
+        try {
+            assign(start, last);
+        } catch(...) {
+            clear();
+            throw;
+        }
+    }
+
+    inplace_vector(const inplace_vector& other) requires IS_TRIVIAL = default;
+
+    inplace_vector(const inplace_vector& other):
+        size_(0)
+    {
+        uninitialized_copy_n(other.data(), other.size_, data());
+        size_ = other.size_;
+    }
+
+    inplace_vector(inplace_vector&& other) requires IS_TRIVIAL = default;
+
+    /// elements are relocated, other is left empty
+    inplace_vector(inplace_vector&& other):
+        size_(0)
+    {
+        uninitialized_relocate_n(other.data(), other.size_, data());
+        size_       = other.size_;
+        other.size_ = 0;
+    }
+
+    ~inplace_vector() requires IS_TRIVIAL = default;
+
+    ~inplace_vector()
+    { clear(); }
+
+    inplace_vector& operator=(const inplace_vector& other) requires IS_TRIVIAL = default;
+
+    inplace_vector& operator=(const inplace_vector& other) {
+        if(this == &other) return *this;
+
+        clear();
+        uninitialized_copy_n(other.data(), other.size_, data());
+        size_ = other.size_;
+
+        return *this;
+    }
+
+    inplace_vector& operator=(inplace_vector&& other) requires IS_TRIVIAL = default;
+
+    inplace_vector& operator=(inplace_vector&& other) {
+        if(this == &other) return *this;
+
+        clear();
+        uninitialized_relocate_n(other.data(), other.size_, data());
+        size_       = other.size_;
+        other.size_ = 0;
+
+        return *this;
+    }
+
+    void swap(inplace_vector& other) {
+        inplace_vector& shorter = size_ < other.size_ ? *this : other;
+        inplace_vector& longer  = size_ < other.size_ ? other : *this;
+
+        std::swap_ranges(shorter.data(), shorter.data() + shorter.size_, longer.data());
+        uninitialized_relocate_n(longer.data() + shorter.size_, longer.size_ - shorter.size_,
+                                 shorter.data() + shorter.size_);
+        std::swap(size_, other.size_);
+    }
+
+    void assign(size_t n_elems, const T& val) {
+        check_room(n_elems);
+
+        // val could be the element of this vector
+        T tmp = val;
+        clear();
+
+        uninitialized_fill_n(data(), n_elems, tmp);
+        size_ = n_elems;
+    }
+
+    template<legacy_input_iterator ItFrom>
+    void assign(ItFrom start, ItFrom last) {
+        clear();
+
+        if constexpr(legacy_forward_iterator<ItFrom>) {
+            size_t n_elems = std::distance(start, last);
+            check_room(n_elems);
+
+            uninitialized_copy_iter_n(start, n_elems, data());
+            size_ = n_elems;
+        }
+        else {
+            for(; start != last; ++start) {
+                emplace_back(*start);
+            }
+        }
+    }
+
+    reference at(size_t n_elem) {
+        if(n_elem >= size_)
+            throw std::out_of_range("out of range");
+
+        return data()[n_elem];
+    }
+
+    const_reference at(size_t n_elem) const {
+        if(n_elem >= size_)
+            throw std::out_of_range("out of range");
+
+        return data()[n_elem];
+    }
+
+    reference operator[](size_t n_elem) {
+        CheckPolicy::check(n_elem, size_);
+        return data()[n_elem];
+    }
+
+    const_reference operator[](size_t n_elem) const {
+        CheckPolicy::check(n_elem, size_);
+        return data()[n_elem];
+    }
+
+    reference front() {
+        CheckPolicy::check(0, size_);
+        return data()[0];
+    }
+
+    const_reference front() const {
+        CheckPolicy::check(0, size_);
+        return data()[0];
+    }
+
+    reference back() {
+        CheckPolicy::check(size_ - 1, size_);
+        return data()[size_ - 1];
+    }
+
+    const_reference back() const {
+        CheckPolicy::check(size_ - 1, size_);
+        return data()[size_ - 1];
+    }
+
+    T* data()
+    { return reinterpret_cast<T*>(storage_); }
+
+    const T* data() const
+    { return reinterpret_cast<const T*>(storage_); }
+
+    bool empty() const
+    { return size_ == 0; }
+
+    size_t size() const
+    { return size_; }
+
+    static constexpr size_t capacity()
+    { return N; }
+
+    static constexpr size_t max_size()
+    { return N; }
+
+    /// nothing to allocate, only checks that capacity fits
+    void reserve(size_t capacity)
+    { check_room(capacity); }
+
+    void shrink_to_fit() {}
+
+    void clear() {
+        destroy_n(data(), size_);
+        size_ = 0;
+    }
+
+    iterator erase(iterator pos)
+    { return erase(pos, pos + 1); }
+
+    iterator erase(iterator start, iterator last) {
+        size_t n_first = start - begin();
+        size_t n_erased = last - start;
+        if(n_erased == 0) return start;
+
+        std::move(data() + n_first + n_erased, data() + size_, data() + n_first);
+
+        destroy_n(data() + size_ - n_erased, n_erased);
+        size_ -= n_erased;
+
+        return start;
+    }
+
+    iterator insert(iterator pos, const T& val)
+    { return insert(pos, 1, val); }
+
+    iterator insert(iterator pos, T&& val)
+    { return emplace(pos, nstd::move(val)); }
+
+    iterator insert(iterator pos, size_t count, const T& val) {
+        if(count == 0) return pos;
+        check_room(size_ + count);
+
+        // val could be the element of this vector, which is going to be moved
+        if(is_in_range(&val, data(), size_)) {
+            T tmp = val;
+            return insert(pos, count, tmp);
+        }
+
+        size_t n_pos = pos - begin();
+
+        uninitialized_relocate_n(data() + n_pos, size_ - n_pos, data() + n_pos + count);
+        try {
+            uninitialized_fill_n(data() + n_pos, count, val);
+        } catch(...) {
+            uninitialized_relocate_n(data() + n_pos + count, size_ - n_pos, data() + n_pos);
+            throw;
+        }
+        size_ += count;
+
+        return pos;
+    }
+
+    template<legacy_input_iterator ItFrom>
+    iterator insert(iterator pos, ItFrom start, ItFrom last) {
+        size_t n_pos = pos - begin();
+
+        if constexpr(!legacy_forward_iterator<ItFrom>) {
+            // length is unknown, so elements are appended and rotated into place
+            size_t old_size = size_;
+            for(; start != last; ++start) {
+                emplace_back(*start);
+            }
+
+            std::rotate(data() + n_pos, data() + old_size, data() + size_);
+        }
+        else {
+            size_t count = std::distance(start, last);
+            if(count == 0) return pos;
+            check_room(size_ + count);
+
+            uninitialized_relocate_n(data() + n_pos, size_ - n_pos, data() + n_pos + count);
+            try {
+                uninitialized_copy_iter_n(start, count, data() + n_pos);
+            } catch(...) {
+                uninitialized_relocate_n(data() + n_pos + count, size_ - n_pos, data() + n_pos);
+                throw;
+            }
+            size_ += count;
+        }
+
+        return pos;
+    }
+
+    template<typename Range>
+    void append_range(Range&& range)
+    { insert(end(), std::begin(range), std::end(range)); }
+
+    /// constructs element in place before pos, args may refer to elements of the vector
+    template<typename... Args>
+    iterator emplace(iterator pos, Args&&... args) {
+        size_t n_pos = pos - begin();
+
+        if(n_pos == size_) {
+            emplace_back(nstd::forward<Args>(args)...);
+            return pos;
+        }
+
+        check_room(size_ + 1);
+
+        // args could refer to the tail, which is going to be shifted
+        T tmp(nstd::forward<Args>(args)...);
+
+        uninitialized_relocate_n(data() + n_pos, size_ - n_pos, data() + n_pos + 1);
+        std::construct_at(data() + n_pos, nstd::move(tmp));
+        size_++;
+
+        return pos;
+    }
+
+    void push_back(const T& val)
+    { emplace_back(val); }
+
+    void push_back(T&& val)
+    { emplace_back(nstd::move(val)); }
+
+    template<typename... Args>
+    reference emplace_back(Args&&... args) {
+        check_room(size_ + 1);
+
+        return unchecked_emplace_back(nstd::forward<Args>(args)...);
+    }
+
+    /// returns NULL if the vector is full, otherwise the new element
+    T* try_push_back(const T& val)
+    { return try_emplace_back(val); }
+
+    T* try_push_back(T&& val)
+    { return try_emplace_back(nstd::move(val)); }
+
+    template<typename... Args>
+    T* try_emplace_back(Args&&... args) {
+        if(size_ == N) return NULL;
+
+        return &unchecked_emplace_back(nstd::forward<Args>(args)...);
+    }
+
+    /// size() < capacity() is the precondition, it is only asserted
+    void unchecked_push_back(const T& val)
+    { unchecked_emplace_back(val); }
+
+    void unchecked_push_back(T&& val)
+    { unchecked_emplace_back(nstd::move(val)); }
+
+    template<typename... Args>
+    reference unchecked_emplace_back(Args&&... args) {
+        assert(size_ < N && "inplace_vector is full");
+
+        std::construct_at(data() + size_, nstd::forward<Args>(args)...);
+        return data()[size_++];
+    }
+
+    T pop_back() {
+        if(size_ == 0)
+            throw std::out_of_range("pop_back on empty vector");
+
+        T val = nstd::move(data()[size_ - 1]);
+        size_--;
+        std::destroy_at(data() + size_);
+
+        return val;
+    }
+
+    void resize(size_t n_elems) {
+        check_room(n_elems);
+
+        if(size_ > n_elems) {
+            destroy_n(data() + n_elems, size_ - n_elems);
+        }
+        else if(size_ < n_elems) {
+            uninitialized_value_construct_n(data() + size_, n_elems - size_);
+        }
+        size_ = n_elems;
+    }
+
+    void resize(size_t n_elems, const T& val) {
+        check_room(n_elems);
+
+        if(size_ > n_elems) {
+            destroy_n(data() + n_elems, size_ - n_elems);
+        }
+        else if(size_ < n_elems) {
+            uninitialized_fill_n(data() + size_, n_elems - size_, val);
+        }
+        size_ = n_elems;
+    }
+
+    iterator begin()
+    { return iterator(data()); }
+
+    const_iterator cbegin() const
+    { return const_iterator(data()); }
+
+    reverse_iterator rbegin()
+    { return reverse_iterator(end()); }
+
+    const_reverse_iterator crbegin() const
+    { return const_reverse_iterator(cend()); }
+
+    iterator end()
+    { return iterator(data() + size_); }
+
+    const_iterator cend() const
+    { return const_iterator(data() + size_); }
+
+    reverse_iterator rend()
+    { return reverse_iterator(begin()); }
+
+    const_reverse_iterator crend() const
+    { return const_reverse_iterator(cbegin()); }
+
+private:
+    static void check_room(size_t n_elems) {
+        if(n_elems > N)
+            throw std::length_error("inplace_vector capacity exceeded");
+    }
+
+    size_t                  size_;
+    alignas(T) uint8_t      storage_[N ? N * sizeof(T) : 1];
+};
+
+template<typename T, size_t N, class CheckPolicy>
+void swap(inplace_vector<T, N, CheckPolicy>& lhs, inplace_vector<T, N, CheckPolicy>& rhs)
+{ lhs.swap(rhs); }
+
+}; // namespace nstd
+
+#endif // NSTD_INPLACE_VECTOR_H
@@ -3,11 +3,23 @@
 
 #include "move_semantics.hpp"
 #include <iostream>
+#include <iterator>
+#include <stdint.h>
+#include <concepts>
 
 // TODO: operator++ refactor
 
 namespace nstd{
 
+/// anything with iterator_traits, used to separate (first, last) overloads from (count, value) ones
+template<typename It>
+concept legacy_input_iterator = requires { typename std::iterator_traits<It>::iterator_category; };
+
+/// iterators which allow to measure the range before walking over it
+template<typename It>
+concept legacy_forward_iterator = legacy_input_iterator<It> &&
+    std::derived_from<typename std::iterator_traits<It>::iterator_category, std::forward_iterator_tag>;
+
 // TODO: add checks
 
 //? Could it work on non pointer classes
@@ -22,79 +34,79 @@ public:
     typedef typename std::iterator_traits<Pt>::pointer pointer;
     typedef typename std::iterator_traits<Pt>::reference reference;
 public:
-    ptlike_iterator():
+    constexpr ptlike_iterator():
         p_data_(NULL){}
 
-    ptlike_iterator(Pt pt):
+    constexpr ptlike_iterator(Pt pt):
         p_data_(pt){}
 
-    ptlike_iterator(const ptlike_iterator& other) = default;
+    constexpr ptlike_iterator(const ptlike_iterator& other) = default;
  
-    ptlike_iterator& operator =(const ptlike_iterator& other) = default;
+    constexpr ptlike_iterator& operator =(const ptlike_iterator& other) = default;
 
-    ~ptlike_iterator()
+    constexpr ~ptlike_iterator()
     { p_data_ = NULL; }
 
-    reference operator *()
+    constexpr reference operator *()
     { return *p_data_; }
 
-    pointer operator ->() 
+    constexpr pointer operator ->() 
     { return p_data_; }
 
-    reference operator [](difference_type idx) 
+    constexpr reference operator [](difference_type idx) 
     { return *(p_data_ + idx); }
     
-    ptlike_iterator& operator ++() {
+    constexpr ptlike_iterator& operator ++() {
         p_data_++;
         return *this;
     }
 
-    ptlike_iterator operator ++(int)
+    constexpr ptlike_iterator operator ++(int)
     { return ptlike_iterator(p_data_++); }
 
-    ptlike_iterator& operator --() {
+    constexpr ptlike_iterator& operator --() {
         p_data_--;
         return *this;
     }
 
-    ptlike_iterator operator --(int)
+    constexpr ptlike_iterator operator --(int)
     { return ptlike_iterator(p_data_--); }
 
-    ptlike_iterator  operator +(difference_type offset) const
+    constexpr ptlike_iterator  operator +(difference_type offset) const
     { return ptlike_iterator(p_data_ + offset); }
 
-    ptlike_iterator& operator +=(difference_type offset){
+    constexpr ptlike_iterator& operator +=(difference_type offset){
         p_data_ += offset;
         return *this;
     }
 
-    ptlike_iterator operator -(difference_type offset) const
+    constexpr ptlike_iterator operator -(difference_type offset) const
     { return ptlike_iterator(p_data_ - offset); }
 
-    ptlike_iterator& operator -=(difference_type offset) {
+    constexpr ptlike_iterator& operator -=(difference_type offset) {
         p_data_ -= offset;
         return *this;
     }
 
-    difference_type operator -(const ptlike_iterator& other) const
+    constexpr difference_type operator -(const ptlike_iterator& other) const
     { return p_data_ - other.p_data_; }
 
-    bool operator ==(const ptlike_iterator& other) const
+    constexpr bool operator ==(const ptlike_iterator& other) const
     { return p_data_ == other.p_data_; }
 
-    bool operator !=(const ptlike_iterator& other) const
+    constexpr bool operator !=(const ptlike_iterator& other) const
     { return p_data_ != other.p_data_; }
 
-    bool operator >(const ptlike_iterator& other) const
+    constexpr bool operator >(const ptlike_iterator& other) const
     { return p_data_ > other.p_data_; }
 
-    bool operator >=(const ptlike_iterator& other) const
+    constexpr bool operator >=(const ptlike_iterator& other) const
     { return p_data_ >= other.p_data_; }
 
-    bool operator <(const ptlike_iterator& other) const
+    constexpr bool operator <(const ptlike_iterator& other) const
     { return p_data_ < other.p_data_; }
 
-    bool operator <=(const ptlike_iterator& other) const
+    constexpr bool operator <=(const ptlike_iterator& other) const
     { return p_data_ <= other.p_data_; }
 
 private:
@@ -106,15 +118,17 @@ template<typename TIter>
 class reverse_ra_iterator_default;
 
 template<class TIter>
-reverse_ra_iterator_default<TIter>  make_default_ra_reverse_iterator(const TIter& iter){
+constexpr reverse_ra_iterator_default<TIter>  make_default_ra_reverse_iterator(const TIter& iter){
     return reverse_ra_iterator_default<TIter>(iter);
 }
 
 template<class TIter>
-reverse_ra_iterator_default<TIter>  make_default_ra_reverse_iterator(TIter&& iter){
+constexpr reverse_ra_iterator_default<TIter>  make_default_ra_reverse_iterator(TIter&& iter){
     return reverse_ra_iterator_default<TIter>(iter);
 }
 
+/// holds the base iterator one past the element, as std::reverse_iterator does,
+/// so rbegin() and rend() are made of end() and begin() without stepping before the first element
 template<typename TIter>
 class reverse_ra_iterator_default : public std::iterator_traits<TIter>
 {
@@ -124,89 +138,92 @@ class reverse_ra_iterator_default : public std::iterator_traits<TIter>
     typedef typename std::iterator_traits<TIter>::pointer pointer;
     typedef typename std::iterator_traits<TIter>::reference reference;
 public:
-    reverse_ra_iterator_default() = default;
+    constexpr reverse_ra_iterator_default() = default;
 
     //?
-    reverse_ra_iterator_default(pointer pt):
+    constexpr reverse_ra_iterator_default(pointer pt):
         direct_iter_(pt){}
 
-    reverse_ra_iterator_default(const reverse_ra_iterator_default& other) = default;
-    reverse_ra_iterator_default(reverse_ra_iterator_default&& other) = default;
+    constexpr reverse_ra_iterator_default(const reverse_ra_iterator_default& other) = default;
+    constexpr reverse_ra_iterator_default(reverse_ra_iterator_default&& other) = default;
 //?    { other.direct_iter_ = NULL; }
 
-    reverse_ra_iterator_default(const TIter& other):
+    constexpr reverse_ra_iterator_default(const TIter& other):
         direct_iter_(other){}
 
-    reverse_ra_iterator_default(TIter&& other):
+    constexpr reverse_ra_iterator_default(TIter&& other):
         direct_iter_(nstd::move(other)){}
 
-    reverse_ra_iterator_default& operator =(const reverse_ra_iterator_default& other) = default;
+    constexpr reverse_ra_iterator_default& operator =(const reverse_ra_iterator_default& other) = default;
     //? operator=(const TIter ..)
 
-    ~reverse_ra_iterator_default() = default;
+    constexpr ~reverse_ra_iterator_default() = default;
 
-    reference operator *()
-    { return direct_iter_.operator*(); }
+    constexpr TIter base() const
+    { return direct_iter_; }
 
-    pointer operator ->() 
-    { return direct_iter_.operator->(); }
+    constexpr reference operator *()
+    { return direct_iter_.operator[](-1); }
 
-    reference operator [](difference_type idx) 
-    { return direct_iter_.operator[](idx); }
+    constexpr pointer operator ->() 
+    { return (direct_iter_ - 1).operator->(); }
 
-    reverse_ra_iterator_default& operator ++(){ 
+    constexpr reference operator [](difference_type idx) 
+    { return direct_iter_.operator[](-idx - 1); }
+
+    constexpr reverse_ra_iterator_default& operator ++(){ 
         direct_iter_.operator--(); //! extra return *this in fw_iter.operator--()
         return *this;
     }
 
     //? is performance ok
-    reverse_ra_iterator_default operator ++(int)
+    constexpr reverse_ra_iterator_default operator ++(int)
     { return reverse_ra_iterator_default(nstd::move(direct_iter_.operator--(0))); }
 
-    reverse_ra_iterator_default& operator --(){
+    constexpr reverse_ra_iterator_default& operator --(){
         direct_iter_.operator++();
         return *this;
     }
 
-    reverse_ra_iterator_default operator --(int)
+    constexpr reverse_ra_iterator_default operator --(int)
     { return reverse_ra_iterator_default(nstd::move(direct_iter_.operator++(0))); }
 
-    reverse_ra_iterator_default operator +(difference_type offset) const
+    constexpr reverse_ra_iterator_default operator +(difference_type offset) const
     { return reverse_ra_iterator_default(nstd::move(direct_iter_.operator-(offset))); }
 
-    reverse_ra_iterator_default& operator +=(difference_type offset){ 
+    constexpr reverse_ra_iterator_default& operator +=(difference_type offset){ 
         direct_iter_.operator-=(offset); 
         return *this;
     }
 
-    reverse_ra_iterator_default operator -(difference_type offset) const
+    constexpr reverse_ra_iterator_default operator -(difference_type offset) const
     { return reverse_ra_iterator_default(nstd::move(direct_iter_.operator+(offset))); }
 
-    reverse_ra_iterator_default& operator -=(difference_type offset){
+    constexpr reverse_ra_iterator_default& operator -=(difference_type offset){
         direct_iter_.operator+=(offset); 
         return *this;
     }
 
     //? for ex std::normal_iterator doesnt have this operator
-    difference_type operator -(const reverse_ra_iterator_default& other) const
+    constexpr difference_type operator -(const reverse_ra_iterator_default& other) const
     { return other.direct_iter_.operator-(direct_iter_); }
 
-    bool operator ==(const reverse_ra_iterator_default& other) const
+    constexpr bool operator ==(const reverse_ra_iterator_default& other) const
     { return direct_iter_.operator==(other.direct_iter_); }
 
-    bool operator !=(const reverse_ra_iterator_default& other) const
+    constexpr bool operator !=(const reverse_ra_iterator_default& other) const
     { return direct_iter_.operator!=(other.direct_iter_); }
 
-    bool operator >(const reverse_ra_iterator_default& other) const
+    constexpr bool operator >(const reverse_ra_iterator_default& other) const
     { return direct_iter_.operator<(other.direct_iter_); }
 
-    bool operator >=(const reverse_ra_iterator_default& other) const
+    constexpr bool operator >=(const reverse_ra_iterator_default& other) const
     { return direct_iter_.operator<=(other.direct_iter_); }
 
-    bool operator <(const reverse_ra_iterator_default& other) const
+    constexpr bool operator <(const reverse_ra_iterator_default& other) const
     { return direct_iter_.operator>(other.direct_iter_); }
 
-    bool operator <=(const reverse_ra_iterator_default& other) const
+    constexpr bool operator <=(const reverse_ra_iterator_default& other) const
     { return direct_iter_.operator>=(other.direct_iter_); }
 
 private:
@@ -215,13 +232,18 @@ private:
     TIter direct_iter_;
 };
 
+/// bits of vector<bool> are kept in 64-bit words, bit n is (word n / 64) >> (n % 64)
+typedef uint64_t bit_word_t;
+static const size_t BITS_PER_WORD = 64;
+
+/// proxy of a single bit: assignment from bool or from another reference writes the bit
 struct bit_reference{
 
     bit_reference():
         p_data_(NULL),
         mask_offset_(0){}
     
-    bit_reference(uint8_t* p_data, uint8_t mask_offset):
+    bit_reference(bit_word_t* p_data, uint8_t mask_offset):
         p_data_(p_data),
         mask_offset_(mask_offset){}
     
@@ -231,28 +253,26 @@ struct bit_reference{
         p_data_ = NULL; mask_offset_ = 0;
     }
 
-    bit_reference& operator=(const bit_reference& other){
-        p_data_        = other.p_data_;
-        mask_offset_   = other.mask_offset_;
-
-        return *this;
-    }
+    bit_reference& operator=(const bit_reference& other)
+    { return *this = bool(other); }
 
     bit_reference& operator=(bool val) {
-        uint8_t mask = 1 << mask_offset_;
+        bit_word_t mask = bit_word_t(1) << mask_offset_;
 
-        *p_data_ &= ~mask;
-        *p_data_ |= val ? mask : ~mask;
+        *p_data_ = val ? (*p_data_ | mask) : (*p_data_ & ~mask);
 
         return *this;
     }
 
-    operator bool(){
-        return *p_data_ & (1 << mask_offset_);
+    operator bool() const {
+        return (*p_data_ >> mask_offset_) & 1;
     }
 
-    uint8_t* p_data_;
-    uint8_t  mask_offset_;
+    void flip()
+    { *p_data_ ^= bit_word_t(1) << mask_offset_; }
+
+    bit_word_t* p_data_;
+    uint8_t     mask_offset_;
 };
 
 struct bit_reference_const{
@@ -261,7 +281,7 @@ struct bit_reference_const{
         p_data_(NULL),
         mask_offset_(0){}
     
-    bit_reference_const(const uint8_t* p_data, uint8_t mask_offset):
+    bit_reference_const(const bit_word_t* p_data, uint8_t mask_offset):
         p_data_(p_data),
         mask_offset_(mask_offset){}
     
@@ -271,21 +291,16 @@ struct bit_reference_const{
         p_data_ = NULL; mask_offset_ = 0;
     }
 
-    bit_reference_const& operator=(const bit_reference_const& other){
-        p_data_        = other.p_data_;
-        mask_offset_   = other.mask_offset_;
-
-        return *this;
-    }
+    bit_reference_const& operator=(const bit_reference_const& other) = delete;
 
     bit_reference_const& operator=(bool val) = delete;
 
-    operator bool(){
-        return *p_data_ & (1 << mask_offset_);
+    operator bool() const {
+        return (*p_data_ >> mask_offset_) & 1;
     }
 
-    const uint8_t* p_data_;
-    uint8_t  mask_offset_;
+    const bit_word_t* p_data_;
+    uint8_t           mask_offset_;
 };
 
 template<class BIT_REF> class bit_iterator_reverse;
@@ -307,13 +322,21 @@ public:
     typedef BIT_REF reference;
 
 private:
+    /// offsets may be negative, so words are counted by floor division
     BIT_REF get_shifted_bitref(difference_type offset) const {
-        uint8_t new_mask_offset     = (bit_ref_.mask_offset_ + offset) % 8;
-        difference_type addr_offset = (bit_ref_.mask_offset_ + offset) / 8;
+        difference_type bit_offset  = bit_ref_.mask_offset_ + offset;
+        difference_type addr_offset = bit_offset >= 0 ? bit_offset / difference_type(BITS_PER_WORD)
+                                                      : -((-bit_offset + difference_type(BITS_PER_WORD) - 1) / difference_type(BITS_PER_WORD));
 
-        return BIT_REF(bit_ref_.p_data_ + addr_offset, new_mask_offset);
+        return BIT_REF(bit_ref_.p_data_ + addr_offset, uint8_t(bit_offset - addr_offset * difference_type(BITS_PER_WORD)));
     } 
 
+    /// assignment of references writes bits, iterators move by changing the fields
+    void rebind(const BIT_REF& bit_ref) {
+        bit_ref_.p_data_      = bit_ref.p_data_;
+        bit_ref_.mask_offset_ = bit_ref.mask_offset_;
+    }
+
 public:
     bit_iterator():
         bit_ref_(){}
@@ -323,23 +346,26 @@ public:
 
     bit_iterator(const bit_iterator& other) = default;
  
-    bit_iterator& operator =(const bit_iterator& other) = default;
+    bit_iterator& operator =(const bit_iterator& other) {
+        rebind(other.bit_ref_);
+        return *this;
+    }
 
     ~bit_iterator() = default;
 
-    reference operator *()
+    reference operator *() const
     { return bit_ref_; }
 
     // TODO: check
     pointer operator ->() 
     { return &bit_ref_; }
 
-    reference operator [](difference_type idx) { 
+    reference operator [](difference_type idx) const { 
         return get_shifted_bitref(idx);
     }
 
     bit_iterator& operator ++() {
-        if(bit_ref_.mask_offset_ == 7) {
+        if(bit_ref_.mask_offset_ == BITS_PER_WORD - 1) {
             bit_ref_.mask_offset_  = 0;
             bit_ref_.p_data_      += 1;
         } else {
@@ -348,12 +374,15 @@ public:
         return *this;
     }
 
-    bit_iterator operator ++(int)
-    { return bit_iterator(this->operator++()); }
+    bit_iterator operator ++(int) {
+        bit_iterator old = *this;
+        this->operator++();
+        return old;
+    }
 
     bit_iterator& operator --() {
         if(bit_ref_.mask_offset_ == 0) {
-            bit_ref_.mask_offset_  = 7;
+            bit_ref_.mask_offset_  = BITS_PER_WORD - 1;
             bit_ref_.p_data_      -= 1;
         } else {
             bit_ref_.mask_offset_ -= 1;
@@ -361,14 +390,17 @@ public:
         return *this;
     }
 
-    bit_iterator operator --(int)
-    { return bit_iterator(this->operator--()); }
+    bit_iterator operator --(int) {
+        bit_iterator old = *this;
+        this->operator--();
+        return old;
+    }
 
     bit_iterator  operator +(difference_type offset) const
     { return bit_iterator(get_shifted_bitref(offset)); }
 
     bit_iterator& operator +=(difference_type offset){
-        bit_ref_ = get_shifted_bitref(offset);
+        rebind(get_shifted_bitref(offset));
         return *this;
     }
 
@@ -376,36 +408,34 @@ public:
     { return bit_iterator(get_shifted_bitref(-offset)); }
 
     bit_iterator& operator -=(difference_type offset) {
-        bit_ref_ = get_shifted_bitref(-offset);
+        rebind(get_shifted_bitref(-offset));
         return *this;
     }
 
-    difference_type operator -(const bit_iterator& other) const{
-        if(bit_ref_.p_data_ == other.bit_ref_.p_data_)
-            { return static_cast<difference_type>(bit_ref_.mask_offset_ - other.bit_ref_.mask_offset_); }
-
-        return static_cast<difference_type>(bit_ref_.p_data_ - other.bit_ref_.p_data_) * 8 + bit_ref_.mask_offset_ + 7 - other.bit_ref_.mask_offset_;
+    difference_type operator -(const bit_iterator& other) const {
+        return static_cast<difference_type>(bit_ref_.p_data_ - other.bit_ref_.p_data_) * difference_type(BITS_PER_WORD) +
+               bit_ref_.mask_offset_ - other.bit_ref_.mask_offset_;
     }
 
     bool operator ==(const bit_iterator& other) const
     { return bit_ref_.p_data_ == other.bit_ref_.p_data_ && bit_ref_.mask_offset_ == other.bit_ref_.mask_offset_; }
 
     bool operator !=(const bit_iterator& other) const
-    { return !(bit_ref_.p_data_ == other.bit_ref_.p_data_ && bit_ref_.mask_offset_ == other.bit_ref_.mask_offset_); }
+    { return !(*this == other); }
 
     bool operator >(const bit_iterator& other) const
     { return bit_ref_.p_data_ > other.bit_ref_.p_data_ || (bit_ref_.p_data_ == other.bit_ref_.p_data_ && bit_ref_.mask_offset_ > other.bit_ref_.mask_offset_); }
 
     bool operator >=(const bit_iterator& other) const
-    { return bit_ref_.p_data_ >= other.bit_ref_.p_data_ || (bit_ref_.p_data_ == other.bit_ref_.p_data_ && bit_ref_.mask_offset_ >= other.bit_ref_.mask_offset_); }
+    { return !(*this < other); }
 
     bool operator <(const bit_iterator& other) const
     { return bit_ref_.p_data_ < other.bit_ref_.p_data_ || (bit_ref_.p_data_ == other.bit_ref_.p_data_ && bit_ref_.mask_offset_ < other.bit_ref_.mask_offset_); }
 
     bool operator <=(const bit_iterator& other) const
-    { return bit_ref_.p_data_ <= other.bit_ref_.p_data_ || (bit_ref_.p_data_ == other.bit_ref_.p_data_ && bit_ref_.mask_offset_ <= other.bit_ref_.mask_offset_); }
+    { return !(*this > other); }
 
-    BIT_REF bit_ref()
+    BIT_REF bit_ref() const
     { return bit_ref_; }
 private:
    BIT_REF bit_ref_;
@@ -424,14 +454,6 @@ public:
     typedef BIT_REF* pointer;
     typedef BIT_REF reference;
 
-private:
-    BIT_REF get_shifted_bitref(difference_type offset) const {
-        uint8_t new_mask_offset     = (direct_iter_.bit_ref_.mask_offset_ + offset) % 8;
-        difference_type addr_offset = (direct_iter_.bit_ref_.mask_offset_ + offset) / 8;
-
-        return BIT_REF(direct_iter_.bit_ref_.p_data_ + addr_offset, new_mask_offset);
-    } 
-
 public:
     bit_iterator_reverse():
         direct_iter_(){}
@@ -445,15 +467,15 @@ public:
 
     ~bit_iterator_reverse() = default;
 
-    reference operator *()
+    reference operator *() const
     { return direct_iter_.bit_ref_; }
 
     // TODO: check
     pointer operator ->() 
     { return &(direct_iter_.bit_ref_); }
 
-    reference operator [](difference_type idx) { 
-        return get_shifted_bitref(-idx);
+    reference operator [](difference_type idx) const { 
+        return direct_iter_.get_shifted_bitref(-idx);
     }
 
     bit_iterator_reverse& operator ++() {
@@ -461,30 +483,36 @@ public:
         return *this;
     }
 
-    bit_iterator_reverse operator ++(int)
-    { return bit_iterator_reverse(this->operator++()); }
+    bit_iterator_reverse operator ++(int) {
+        bit_iterator_reverse old = *this;
+        direct_iter_.operator--();
+        return old;
+    }
 
     bit_iterator_reverse& operator --() {
-        direct_iter_.operator--();
+        direct_iter_.operator++();
         return *this;
     }
 
-    bit_iterator_reverse operator --(int)
-    { return bit_iterator_reverse(this->operator--()); }
+    bit_iterator_reverse operator --(int) {
+        bit_iterator_reverse old = *this;
+        direct_iter_.operator++();
+        return old;
+    }
 
     bit_iterator_reverse  operator +(difference_type offset) const
-    { return bit_iterator_reverse(get_shifted_bitref(-offset)); }
+    { return bit_iterator_reverse(direct_iter_.get_shifted_bitref(-offset)); }
 
     bit_iterator_reverse& operator +=(difference_type offset){
-        direct_iter_.bit_ref_ = get_shifted_bitref(-offset);
+        direct_iter_ -= offset;
         return *this;
     }
 
     bit_iterator_reverse operator -(difference_type offset) const
-    { return bit_iterator_reverse(get_shifted_bitref(offset)); }
+    { return bit_iterator_reverse(direct_iter_.get_shifted_bitref(offset)); }
 
     bit_iterator_reverse& operator -=(difference_type offset) {
-        direct_iter_.bit_ref_ = get_shifted_bitref(offset);
+        direct_iter_ += offset;
         return *this;
     }
 
@@ -0,0 +1,407 @@
+#ifndef NSTD_MMAP_VECTOR_H
+#define NSTD_MMAP_VECTOR_H
+
+#include <cstdlib>
+#include <stdexcept>
+#include <system_error>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "iterator.hpp"
+#include "move_semantics.hpp"
+#include "capacity_policy.hpp"
+#include "check_policy.hpp"
+
+// Vector of trivially copyable elements kept in a file mapped with MAP_SHARED.
+// File is a 64 byte header (magic, element size, size) followed by the elements as they lie in memory,
+// so reopening is a single mmap without parsing, and pages are loaded and evicted by the page cache.
+// Growth extends the file with ftruncate and the mapping with mremap, data() may move on growth as for nstd::vector.
+// Linux only (mremap).
+
+namespace nstd{
+
+enum mmap_mode {
+    MMAP_OPEN_OR_CREATE,    // keeps the elements of an existing file
+    MMAP_CREATE,            // truncates an existing file
+    MMAP_READ_ONLY          // file must exist, mutating methods throw
+};
+
+template<typename T, class CapacityPolicy = capacity_policy<growth_x2, shrink_never>, class CheckPolicy = default_check_policy>
+class mmap_vector{
+    static_assert(std::is_trivially_copyable_v<T>, "elements of mmap_vector are stored as raw bytes");
+    static_assert(alignof(T) <= 64, "elements must fit the alignment of the header");
+
+public:
+    typedef ptlike_iterator<T*>                                     iterator;
+    typedef ptlike_iterator<const T*>                               const_iterator;
+    typedef reverse_ra_iterator_default<ptlike_iterator<T*>>        reverse_iterator;
+    typedef reverse_ra_iterator_default<ptlike_iterator<const T*>>  const_reverse_iterator;
+
+    typedef T&                                                      reference;
+    typedef const T&                                                const_reference;
+
+    static const uint64_t MAGIC       = 0x5254434556504d4eull;   // "NMPVECTR"
+    static const size_t   HEADER_SIZE = 64;
+
+public:
+    explicit mmap_vector(const char* path, mmap_mode mode = MMAP_OPEN_OR_CREATE):
+        fd_(-1),
+        header_(NULL),
+        data_(NULL),
+        capacity_(0),
+        mapped_size_(0),
+        is_read_only_(mode == MMAP_READ_ONLY)
+    {
+        int flags = is_read_only_ ? O_RDONLY : O_RDWR | O_CREAT;
+        if(mode == MMAP_CREATE) flags |= O_TRUNC;
+
+        fd_ = ::open(path, flags, 0644);
+        if(fd_ < 0)
+            throw std::system_error(errno, std::generic_category(), "mmap_vector: open failed");
+
+        try {
+            struct stat st = {};
+            if(fstat(fd_, &st) != 0)
+                throw std::system_error(errno, std::generic_category(), "mmap_vector: fstat failed");
+
+            if(st.st_size == 0 && !is_read_only_) {
+                resize_file(file_size(0));
+                map(file_size(0));
+                header_->magic_     = MAGIC;
+                header_->elem_size_ = sizeof(T);
+                header_->size_      = 0;
+            }
+            else {
+                if(size_t(st.st_size) < HEADER_SIZE)
+                    throw std::runtime_error("mmap_vector: file is too short");
+
+                map(st.st_size);
+                if(header_->magic_ != MAGIC || header_->elem_size_ != sizeof(T) || header_->size_ > capacity_)
+                    throw std::runtime_error("mmap_vector: file has another format or element type");
+            }
+        } catch(...) {
+            unmap();
+            ::close(fd_);
+            throw;
+        }
+    }
+
+    mmap_vector(const mmap_vector& other) = delete;
+    mmap_vector& operator=(const mmap_vector& other) = delete;
+
+    mmap_vector(mmap_vector&& other):
+        fd_(other.fd_),
+        header_(other.header_),
+        data_(other.data_),
+        capacity_(other.capacity_),
+        mapped_size_(other.mapped_size_),
+        is_read_only_(other.is_read_only_)
+    {
+        other.fd_          = -1;
+        other.header_      = NULL;
+        other.data_        = NULL;
+        other.capacity_    = 0;
+        other.mapped_size_ = 0;
+    }
+
+    mmap_vector& operator=(mmap_vector&& other) {
+        if(this == &other) return *this;
+
+        close();
+        std::swap(fd_,           other.fd_);
+        std::swap(header_,       other.header_);
+        std::swap(data_,         other.data_);
+        std::swap(capacity_,     other.capacity_);
+        std::swap(mapped_size_,  other.mapped_size_);
+        std::swap(is_read_only_, other.is_read_only_);
+
+        return *this;
+    }
+
+    /// pages are written back by the kernel, call sync() to be sure they reached the disk
+    ~mmap_vector()
+    { close(); }
+
+    /// unmaps the file, vector becomes unusable
+    void close() {
+        unmap();
+        if(fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+    }
+
+    /// checkpoint: blocks until the elements and the size are on the disk, async version only schedules the writeback
+    void sync(bool is_async = false) {
+        if(header_ && msync(header_, mapped_size_, is_async ? MS_ASYNC : MS_SYNC) != 0)
+            throw std::system_error(errno, std::generic_category(), "mmap_vector: msync failed");
+    }
+
+    reference at(size_t n_elem) {
+        if(n_elem >= size())
+            throw std::out_of_range("out of range");
+
+        return data_[n_elem];
+    }
+
+    const_reference at(size_t n_elem) const {
+        if(n_elem >= size())
+            throw std::out_of_range("out of range");
+
+        return data_[n_elem];
+    }
+
+    reference operator[](size_t n_elem) {
+        CheckPolicy::check(n_elem, size());
+        return data_[n_elem];
+    }
+
+    const_reference operator[](size_t n_elem) const {
+        CheckPolicy::check(n_elem, size());
+        return data_[n_elem];
+    }
+
+    reference front() {
+        CheckPolicy::check(0, size());
+        return data_[0];
+    }
+
+    const_reference front() const {
+        CheckPolicy::check(0, size());
+        return data_[0];
+    }
+
+    reference back() {
+        CheckPolicy::check(size() - 1, size());
+        return data_[size() - 1];
+    }
+
+    const_reference back() const {
+        CheckPolicy::check(size() - 1, size());
+        return data_[size() - 1];
+    }
+
+    T* data()
+    { return data_; }
+
+    const T* data() const
+    { return data_; }
+
+    bool empty() const
+    { return size() == 0; }
+
+    /// size lives in the mapped header, so it is saved together with the elements
+    size_t size() const
+    { return header_ ? header_->size_ : 0; }
+
+    size_t capacity() const
+    { return capacity_; }
+
+    bool is_read_only() const
+    { return is_read_only_; }
+
+    void reserve(size_t capacity) {
+        if(capacity > capacity_) remap(capacity);
+    }
+
+    /// cuts the file to the elements
+    void shrink_to_fit() {
+        if(size() < capacity_) remap(size());
+    }
+
+    void clear() {
+        check_writable();
+        header_->size_ = 0;
+    }
+
+    void push_back(const T& val) {
+        // copy is taken before the remap, val may be an element of the vector
+        T tmp = val;
+        grow_for(size() + 1);
+
+        data_[header_->size_++] = tmp;
+    }
+
+    template<typename... Args>
+    reference emplace_back(Args&&... args) {
+        T tmp(nstd::forward<Args>(args)...);
+        grow_for(size() + 1);
+
+        data_[header_->size_] = tmp;
+        return data_[header_->size_++];
+    }
+
+    /// appends n_elems elements with one remap
+    void append(const T* from, size_t n_elems) {
+        if(n_elems == 0) return;
+
+        if(from >= data_ && from < data_ + capacity_) {
+            // source is inside the mapping, which may move
+            size_t n_from = from - data_;
+            grow_for(size() + n_elems);
+            from = data_ + n_from;
+        }
+        else {
+            grow_for(size() + n_elems);
+        }
+
+        memcpy(data_ + size(), from, n_elems * sizeof(T));
+        header_->size_ += n_elems;
+    }
+
+    T pop_back() {
+        check_writable();
+        if(size() == 0)
+            throw std::out_of_range("pop_back on empty vector");
+
+        return data_[--header_->size_];
+    }
+
+    /// new elements are value-initialized (zero bytes of the extended file)
+    void resize(size_t n_elems) {
+        grow_for(n_elems);
+
+        if(n_elems > size()) memset(data_ + size(), 0, (n_elems - size()) * sizeof(T));
+        header_->size_ = n_elems;
+    }
+
+    void resize(size_t n_elems, const T& val) {
+        T tmp = val;
+        grow_for(n_elems);
+
+        for(size_t i = size(); i < n_elems; i++) data_[i] = tmp;
+        header_->size_ = n_elems;
+    }
+
+    void swap(mmap_vector& other) {
+        std::swap(fd_,           other.fd_);
+        std::swap(header_,       other.header_);
+        std::swap(data_,         other.data_);
+        std::swap(capacity_,     other.capacity_);
+        std::swap(mapped_size_,  other.mapped_size_);
+        std::swap(is_read_only_, other.is_read_only_);
+    }
+
+    iterator begin()
+    { return iterator(data_); }
+
+    const_iterator cbegin() const
+    { return const_iterator(data_); }
+
+    reverse_iterator rbegin()
+    { return reverse_iterator(end()); }
+
+    const_reverse_iterator crbegin() const
+    { return const_reverse_iterator(cend()); }
+
+    iterator end()
+    { return iterator(data_ + size()); }
+
+    const_iterator cend() const
+    { return const_iterator(data_ + size()); }
+
+    reverse_iterator rend()
+    { return reverse_iterator(begin()); }
+
+    const_reverse_iterator crend() const
+    { return const_reverse_iterator(cbegin()); }
+
+private:
+    struct file_header{
+        uint64_t magic_;
+        uint64_t elem_size_;
+        uint64_t size_;
+    };
+
+    static_assert(sizeof(file_header) <= HEADER_SIZE, "header doesn't fit");
+
+    static size_t file_size(size_t n_elems)
+    { return HEADER_SIZE + n_elems * sizeof(T); }
+
+    /// number of elements, which fit the whole pages of the file
+    static size_t page_capacity(size_t n_elems) {
+        size_t page_size = sysconf(_SC_PAGESIZE);
+        size_t n_bytes   = (file_size(n_elems) + page_size - 1) / page_size * page_size;
+
+        return (n_bytes - HEADER_SIZE) / sizeof(T);
+    }
+
+    void check_writable() const {
+        if(is_read_only_)
+            throw std::logic_error("mmap_vector is opened read only");
+    }
+
+    void grow_for(size_t low_limit) {
+        check_writable();
+        if(low_limit > capacity_) remap(CapacityPolicy::grow(capacity_, low_limit, sizeof(T)));
+    }
+
+    void resize_file(size_t n_bytes) {
+        if(ftruncate(fd_, n_bytes) != 0)
+            throw std::system_error(errno, std::generic_category(), "mmap_vector: ftruncate failed");
+    }
+
+    void map(size_t n_bytes) {
+        int prot  = is_read_only_ ? PROT_READ : PROT_READ | PROT_WRITE;
+        void* ptr = mmap(NULL, n_bytes, prot, MAP_SHARED, fd_, 0);
+
+        if(ptr == MAP_FAILED)
+            throw std::system_error(errno, std::generic_category(), "mmap_vector: mmap failed");
+
+        set_mapping(ptr, n_bytes);
+    }
+
+    void unmap() {
+        if(header_) munmap(header_, mapped_size_);
+
+        header_      = NULL;
+        data_        = NULL;
+        capacity_    = 0;
+        mapped_size_ = 0;
+    }
+
+    void remap(size_t new_capacity) {
+        check_writable();
+        new_capacity = page_capacity(new_capacity);
+        if(new_capacity == capacity_) return;
+
+        size_t old_bytes = mapped_size_;
+        size_t new_bytes = file_size(new_capacity);
+
+        // file is extended before the mapping, so no page of the mapping is past the end of the file
+        if(new_bytes > old_bytes) resize_file(new_bytes);
+
+        void* ptr = mremap(header_, old_bytes, new_bytes, MREMAP_MAYMOVE);
+        if(ptr == MAP_FAILED)
+            throw std::system_error(errno, std::generic_category(), "mmap_vector: mremap failed");
+
+        set_mapping(ptr, new_bytes);
+
+        if(new_bytes < old_bytes) resize_file(new_bytes);
+    }
+
+    void set_mapping(void* ptr, size_t n_bytes) {
+        header_   = static_cast<file_header*>(ptr);
+        data_     = reinterpret_cast<T*>(static_cast<uint8_t*>(ptr) + HEADER_SIZE);
+        capacity_    = (n_bytes - HEADER_SIZE) / sizeof(T);
+        mapped_size_ = n_bytes;
+    }
+
+private:
+    int           fd_;
+    file_header*  header_;
+    T*            data_;
+    size_t        capacity_;
+    size_t        mapped_size_;
+    bool          is_read_only_;
+};
+
+template<typename T, class CapacityPolicy, class CheckPolicy>
+void swap(mmap_vector<T, CapacityPolicy, CheckPolicy>& lhs, mmap_vector<T, CapacityPolicy, CheckPolicy>& rhs)
+{ lhs.swap(rhs); }
+
+}; // namespace nstd
+
+#endif // NSTD_MMAP_VECTOR_H
@@ -19,12 +19,12 @@ struct remove_reference<T&&> {
 };
 
 template<class T>
-typename remove_reference<T>::type&& move(T&& obj) {
+constexpr typename remove_reference<T>::type&& move(T&& obj) {
     return static_cast<typename remove_reference<T>::type&&>(obj);
 }
 
 template<class T>
-T&& forward(T& a)
+constexpr T&& forward(T& a)
 {
     return static_cast<T&&>(a);
 }
@@ -0,0 +1,264 @@
+#ifndef NSTD_PARALLEL_H
+#define NSTD_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <functional>
+#include "thread_pool.hpp"
+#include "vector.hpp"
+
+// Parallel algorithms over random access ranges (ptlike_iterator of nstd::vector, raw pointers, ...).
+// Range is split into chunks, which are run as tasks of the thread_pool of the policy.
+// Ops of reduce/scan must be associative, as for the std::execution::par versions.
+
+namespace nstd{
+namespace par{
+
+struct execution_policy{
+    /// inputs shorter than serial_cutoff are processed in the calling thread
+    static const size_t DEF_SERIAL_CUTOFF  = 1 << 15;
+    /// number of chunks per thread when chunk_size is chosen automatically
+    static const size_t DEF_CHUNKS_PER_THREAD = 4;
+
+    thread_pool* pool          = &thread_pool::global();
+    size_t       chunk_size    = 0;                        // 0 - automatic
+    size_t       serial_cutoff = DEF_SERIAL_CUTOFF;
+
+    execution_policy on(thread_pool& other_pool) const {
+        execution_policy policy = *this;
+        policy.pool = &other_pool;
+        return policy;
+    }
+
+    execution_policy with_chunk_size(size_t size) const {
+        execution_policy policy = *this;
+        policy.chunk_size = size;
+        return policy;
+    }
+
+    execution_policy with_serial_cutoff(size_t cutoff) const {
+        execution_policy policy = *this;
+        policy.serial_cutoff = cutoff;
+        return policy;
+    }
+
+    size_t n_chunks(size_t n_elems) const {
+        if(n_elems == 0) return 0;
+        if(n_elems < serial_cutoff || pool->size() < 2) return 1;
+
+        size_t size = chunk_size ? chunk_size : n_elems / (pool->size() * DEF_CHUNKS_PER_THREAD);
+        if(size == 0) size = 1;
+
+        return (n_elems + size - 1) / size;
+    }
+};
+
+inline execution_policy default_policy()
+{ return execution_policy(); }
+
+namespace detail{
+
+/// calls func(n_chunk, begin, end) for every chunk of [0, n_elems), returns number of chunks
+template<class TFunc>
+size_t for_each_chunk(const execution_policy& policy, size_t n_elems, TFunc func) {
+    size_t n_chunks = policy.n_chunks(n_elems);
+
+    if(n_chunks == 1) {
+        func(size_t(0), size_t(0), n_elems);
+        return 1;
+    }
+
+    task_group group(*policy.pool);
+
+    for(size_t n_chunk = 0; n_chunk < n_chunks; n_chunk++) {
+        size_t begin = n_elems * n_chunk / n_chunks;
+        size_t end   = n_elems * (n_chunk + 1) / n_chunks;
+
+        group.run([&func, n_chunk, begin, end]{ func(n_chunk, begin, end); });
+    }
+
+    group.wait();
+    return n_chunks;
+}
+
+template<class It, class Comp>
+void sort_subrange(task_group& group, It first, It last, Comp comp, size_t cutoff) {
+    typedef typename std::iterator_traits<It>::value_type value_type;
+
+    while(size_t(last - first) > cutoff) {
+        It middle = first + (last - first) / 2;
+
+        // median of three as the pivot
+        value_type pivot = comp(*first, *middle) ?
+            (comp(*middle, *(last - 1)) ? *middle : (comp(*first, *(last - 1)) ? *(last - 1) : *first)) :
+            (comp(*first, *(last - 1)) ? *first : (comp(*middle, *(last - 1)) ? *(last - 1) : *middle));
+
+        It less_end    = std::partition(first, last,    [&](const value_type& x){ return comp(x, pivot); });
+        It greater_beg = std::partition(less_end, last, [&](const value_type& x){ return !comp(pivot, x); });
+
+        group.run([&group, first, less_end, comp, cutoff]{ sort_subrange(group, first, less_end, comp, cutoff); });
+        first = greater_beg;
+    }
+
+    std::sort(first, last, comp);
+}
+
+}; // namespace detail
+
+template<class It, class TFunc>
+void for_each(const execution_policy& policy, It first, It last, TFunc func) {
+    detail::for_each_chunk(policy, last - first, [&](size_t, size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            func(*(first + i));
+        }
+    });
+}
+
+template<class It, class ItTo, class TFunc>
+ItTo transform(const execution_policy& policy, It first, It last, ItTo d_first, TFunc func) {
+    size_t n_elems = last - first;
+
+    detail::for_each_chunk(policy, n_elems, [&](size_t, size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            *(d_first + i) = func(*(first + i));
+        }
+    });
+
+    return d_first + n_elems;
+}
+
+template<class It, class T, class TReduce, class TTransform>
+T transform_reduce(const execution_policy& policy, It first, It last, T init, TReduce reduce_op, TTransform transform_op) {
+    size_t n_elems = last - first;
+    if(n_elems == 0) return init;
+
+    vector<T> partials(policy.n_chunks(n_elems), init);
+
+    size_t n_chunks = detail::for_each_chunk(policy, n_elems, [&](size_t n_chunk, size_t begin, size_t end) {
+        T acc = transform_op(*(first + begin));
+        for(size_t i = begin + 1; i < end; i++) {
+            acc = reduce_op(acc, transform_op(*(first + i)));
+        }
+        partials[n_chunk] = acc;
+    });
+
+    for(size_t n_chunk = 0; n_chunk < n_chunks; n_chunk++) {
+        init = reduce_op(init, partials[n_chunk]);
+    }
+
+    return init;
+}
+
+template<class It, class T, class TReduce>
+T reduce(const execution_policy& policy, It first, It last, T init, TReduce reduce_op) {
+    typedef typename std::iterator_traits<It>::reference reference;
+
+    return transform_reduce(policy, first, last, init, reduce_op, [](reference x) -> T { return x; });
+}
+
+template<class It, class T>
+T reduce(const execution_policy& policy, It first, It last, T init)
+{ return reduce(policy, first, last, init, std::plus<>()); }
+
+/// two passes: sums of the chunks, then every chunk is scanned from the prefix of the previous ones
+template<class It, class ItTo, class TOp>
+ItTo inclusive_scan(const execution_policy& policy, It first, It last, ItTo d_first, TOp op) {
+    typedef typename std::iterator_traits<It>::value_type value_type;
+
+    size_t n_elems  = last - first;
+    size_t n_chunks = policy.n_chunks(n_elems);
+    if(n_elems == 0) return d_first;
+
+    if(n_chunks == 1) {
+        value_type acc = *first;
+        *d_first = acc;
+        for(size_t i = 1; i < n_elems; i++) {
+            acc = op(acc, *(first + i));
+            *(d_first + i) = acc;
+        }
+        return d_first + n_elems;
+    }
+
+    vector<value_type> sums(n_chunks, *first);
+
+    detail::for_each_chunk(policy, n_elems, [&](size_t n_chunk, size_t begin, size_t end) {
+        value_type acc = *(first + begin);
+        for(size_t i = begin + 1; i < end; i++) {
+            acc = op(acc, *(first + i));
+        }
+        sums[n_chunk] = acc;
+    });
+
+    for(size_t n_chunk = 1; n_chunk < n_chunks; n_chunk++) {
+        sums[n_chunk] = op(sums[n_chunk - 1], sums[n_chunk]);
+    }
+
+    detail::for_each_chunk(policy, n_elems, [&](size_t n_chunk, size_t begin, size_t end) {
+        value_type acc = n_chunk ? op(sums[n_chunk - 1], *(first + begin)) : *(first + begin);
+        *(d_first + begin) = acc;
+
+        for(size_t i = begin + 1; i < end; i++) {
+            acc = op(acc, *(first + i));
+            *(d_first + i) = acc;
+        }
+    });
+
+    return d_first + n_elems;
+}
+
+template<class It, class ItTo>
+ItTo inclusive_scan(const execution_policy& policy, It first, It last, ItTo d_first)
+{ return inclusive_scan(policy, first, last, d_first, std::plus<>()); }
+
+template<class It, class TPred>
+size_t count_if(const execution_policy& policy, It first, It last, TPred pred) {
+    typedef typename std::iterator_traits<It>::reference reference;
+
+    return transform_reduce(policy, first, last, size_t(0), std::plus<>(),
+                            [&pred](reference x) -> size_t { return pred(x) ? 1 : 0; });
+}
+
+/// returns the first matching element, chunks after the already found one are skipped
+template<class It, class TPred>
+It find_if(const execution_policy& policy, It first, It last, TPred pred) {
+    size_t n_elems = last - first;
+    std::atomic<size_t> found(n_elems);
+
+    detail::for_each_chunk(policy, n_elems, [&](size_t, size_t begin, size_t end) {
+        for(size_t i = begin; i < end && i < found.load(std::memory_order_relaxed); i++) {
+            if(!pred(*(first + i))) continue;
+
+            size_t cur_found = found.load();
+            while(i < cur_found && !found.compare_exchange_weak(cur_found, i)) {}
+            return;
+        }
+    });
+
+    return first + found.load();
+}
+
+/// parallel quicksort: left parts are spawned as tasks, parts shorter than the chunk are sorted by std::sort
+template<class It, class Comp>
+void sort(const execution_policy& policy, It first, It last, Comp comp) {
+    size_t n_elems  = last - first;
+    size_t n_chunks = policy.n_chunks(n_elems);
+
+    if(n_chunks <= 1) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    task_group group(*policy.pool);
+    detail::sort_subrange(group, first, last, comp, n_elems / n_chunks + 1);
+    group.wait();
+}
+
+template<class It>
+void sort(const execution_policy& policy, It first, It last)
+{ sort(policy, first, last, std::less<>()); }
+
+}; // namespace par
+}; // namespace nstd
+
+#endif // NSTD_PARALLEL_H
@@ -0,0 +1,246 @@
+#ifndef NSTD_RANK_SELECT_H
+#define NSTD_RANK_SELECT_H
+
+#include <cstdlib>
+#include <stdexcept>
+#include <stdint.h>
+#include <algorithm>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+#include "vector.hpp"
+#include "vector_bool.hpp"
+#include "move_semantics.hpp"
+
+// Succinct rank/select index over an immutable bit vector, in the layout of poppy
+// (Zhou, Andersen, Kaminsky, "Space-efficient, high-performance rank and select structures on uncompressed bit sequences"):
+// - superblock of 2048 bits has one 64-bit entry: 32-bit rank of its start relative to the 2^32-bit region it is in,
+//   and the ones before its 2nd, 3rd and 4th 512-bit block in 10, 11 and 11 bits. The counts are cumulative
+//   (poppy keeps them per block), so a query picks one of them instead of summing
+// - every 2^32-bit region has a 64-bit absolute rank
+// - every SELECT_SAMPLE-th one has the index of its superblock sampled, select searches between two samples
+// Index takes 64 / 2048 = 3.1% of the bits for rank and at most 32 / 8192 = 0.4% for select.
+// Queries use __builtin_popcountll and pdep, so they become single instructions with -mpopcnt / -mbmi2,
+// with popcnt the words of a 512-bit block are counted without branches.
+
+namespace nstd{
+
+/// index of the n_bit-th (from 0) set bit of word, which must have more than n_bit set bits
+inline size_t select_in_word(uint64_t word, size_t n_bit) {
+#if defined(__BMI2__)
+    return __builtin_ctzll(_pdep_u64(uint64_t(1) << n_bit, word));
+#else
+    // halves, which have too few ones, are skipped, the last byte is scanned
+    size_t res = 0;
+    for(size_t width = 32; width >= 8; width /= 2) {
+        size_t n_low = __builtin_popcountll(word & ((uint64_t(1) << width) - 1));
+        if(n_bit >= n_low) {
+            n_bit -= n_low;
+            word >>= width;
+            res += width;
+        }
+    }
+    for(; n_bit; n_bit--) word &= word - 1;
+
+    return res + __builtin_ctzll(word);
+#endif
+}
+
+/// rank1(i) is the number of ones before bit i, select1(k) is the position of the one with rank k.
+/// rank is constant time. select binary searches the superblocks between two neighbour samples,
+/// that is constant for dense bits and logarithmic in the gap for sparse ones.
+/// The bits are owned by the index and can't be changed, up to 2^43 bits are supported
+template<class CapacityPolicy = default_capacity_policy, class CheckPolicy = default_check_policy>
+class rank_select{
+public:
+    typedef vector<bool, std::allocator, CapacityPolicy, CheckPolicy> bits_type;
+
+    static const size_t BLOCK_BITS      = 512;
+    static const size_t SUPERBLOCK_BITS = 2048;
+    static const size_t REGION_BITS     = size_t(1) << 32;
+    static const size_t SELECT_SAMPLE   = 8192;
+
+    /// position and width of the count of ones before block n of the superblock in its entry
+    static constexpr uint8_t  BLOCK_SHIFTS[4] = {0, 32, 42, 53};
+    static constexpr uint64_t BLOCK_MASKS[4]  = {0, 0x3FF, 0x7FF, 0x7FF};
+
+public:
+    rank_select():
+        rank_select(bits_type()){}
+
+    /// builds the index in one pass over the words
+    explicit rank_select(bits_type bits):
+        bits_(nstd::move(bits)),
+        n_ones_(0)
+    { build(); }
+
+    const bits_type& bits() const
+    { return bits_; }
+
+    size_t size() const
+    { return bits_.size(); }
+
+    /// number of set bits
+    size_t count() const
+    { return n_ones_; }
+
+    bool operator[](size_t n_bit) const
+    { return bits_[n_bit]; }
+
+    /// number of ones in [0, n_bit), n_bit <= size()
+    size_t rank1(size_t n_bit) const {
+        CheckPolicy::check(n_bit, bits_.size() + 1);
+
+        const bit_word_t* words = bits_.data();
+        uint64_t entry = superblocks_[n_bit / SUPERBLOCK_BITS];
+
+        size_t n_block = n_bit / BLOCK_BITS % (SUPERBLOCK_BITS / BLOCK_BITS);
+        size_t res = regions_[n_bit / REGION_BITS] + (entry & 0xFFFFFFFF) +
+                     ((entry >> BLOCK_SHIFTS[n_block]) & BLOCK_MASKS[n_block]);
+
+        const size_t WORDS_PER_BLOCK = BLOCK_BITS / BITS_PER_WORD;
+        size_t n_first = n_bit / BLOCK_BITS * WORDS_PER_BLOCK;
+
+#if defined(__POPCNT__)
+        // all the words of a whole block are counted under masks: a loop up to n_bit mispredicts its exit
+        size_t n_left = n_bit % BLOCK_BITS;
+        if(n_first + WORDS_PER_BLOCK <= bits_.n_words()) {
+            for(size_t i = 0; i < WORDS_PER_BLOCK; i++) {
+                size_t n_word_bits = n_left > i * BITS_PER_WORD ? n_left - i * BITS_PER_WORD : 0;
+                n_word_bits = n_word_bits < BITS_PER_WORD ? n_word_bits : BITS_PER_WORD;
+
+                // n_word_bits low ones, all ones for 64, without a branch
+                bit_word_t mask = (bit_word_t(n_word_bits < BITS_PER_WORD) << (n_word_bits % BITS_PER_WORD)) - 1;
+                res += __builtin_popcountll(words[n_first + i] & mask);
+            }
+            return res;
+        }
+#endif
+
+        size_t n_word = n_bit / BITS_PER_WORD;
+        for(size_t i = n_first; i < n_word; i++) res += __builtin_popcountll(words[i]);
+        if(n_bit % BITS_PER_WORD) res += __builtin_popcountll(words[n_word] & bit_low_mask(n_bit % BITS_PER_WORD));
+
+        return res;
+    }
+
+    /// number of zeros in [0, n_bit)
+    size_t rank0(size_t n_bit) const
+    { return n_bit - rank1(n_bit); }
+
+    /// position of the one with n_ones ones before it, size() if there are not so many ones
+    size_t select1(size_t n_ones) const {
+        if(n_ones >= n_ones_) return bits_.size();
+
+        // the last superblock starting with at most n_ones ones before it, searched without branches
+        size_t n_sample = n_ones / SELECT_SAMPLE;
+        size_t n_superblock = samples_[n_sample];
+        size_t n_candidates = (n_sample + 1 < samples_.size() ? samples_[n_sample + 1] : superblocks_.size() - 1) -
+                              n_superblock + 1;
+        while(n_candidates > 1) {
+            size_t half = n_candidates / 2;
+            n_superblock  = superblock_rank(n_superblock + half) <= n_ones ? n_superblock + half : n_superblock;
+            n_candidates -= half;
+        }
+
+        uint64_t entry = superblocks_[n_superblock];
+        size_t rest    = n_ones - superblock_rank(n_superblock);
+
+        size_t n_block = 0;
+        for(size_t i = 1; i < SUPERBLOCK_BITS / BLOCK_BITS; i++) n_block += rest >= ((entry >> BLOCK_SHIFTS[i]) & BLOCK_MASKS[i]);
+        rest -= (entry >> BLOCK_SHIFTS[n_block]) & BLOCK_MASKS[n_block];
+
+        size_t n_word = (n_superblock * (SUPERBLOCK_BITS / BLOCK_BITS) + n_block) * (BLOCK_BITS / BITS_PER_WORD);
+
+        const bit_word_t* words = bits_.data();
+#if defined(__POPCNT__)
+        // words of a whole block, which end with at most rest ones, are skipped without branches
+        const size_t WORDS_PER_BLOCK = BLOCK_BITS / BITS_PER_WORD;
+        if(n_word + WORDS_PER_BLOCK <= bits_.n_words()) {
+            size_t n_skipped = 0, n_skipped_ones = 0, n_block_ones = 0;
+            for(size_t i = 0; i < WORDS_PER_BLOCK; i++) {
+                size_t n_word_ones = __builtin_popcountll(words[n_word + i]);
+                n_block_ones += n_word_ones;
+
+                bool is_skipped = n_block_ones <= rest;
+                n_skipped      += is_skipped;
+                n_skipped_ones += is_skipped ? n_word_ones : 0;
+            }
+
+            n_word += n_skipped;
+            return n_word * BITS_PER_WORD + select_in_word(words[n_word], rest - n_skipped_ones);
+        }
+#endif
+        for(;; n_word++) {
+            size_t n_word_ones = __builtin_popcountll(words[n_word]);
+            if(rest < n_word_ones) break;
+
+            rest -= n_word_ones;
+        }
+
+        return n_word * BITS_PER_WORD + select_in_word(words[n_word], rest);
+    }
+
+    /// index size in bytes, without the bits themselves
+    size_t index_bytes() const {
+        return superblocks_.size() * sizeof(uint64_t) + regions_.size() * sizeof(uint64_t) +
+               samples_.size() * sizeof(uint32_t);
+    }
+
+private:
+    bits_type        bits_;
+    size_t           n_ones_;
+    /// rank of the start of the superblock in its region and ones before its 2nd, 3rd and 4th block
+    vector<uint64_t> superblocks_;
+    /// absolute rank of the start of every region
+    vector<uint64_t> regions_;
+    /// superblock, which holds the one with rank n * SELECT_SAMPLE
+    vector<uint32_t> samples_;
+
+private:
+    size_t superblock_rank(size_t n_superblock) const
+    { return regions_[n_superblock * SUPERBLOCK_BITS / REGION_BITS] + (superblocks_[n_superblock] & 0xFFFFFFFF); }
+
+    void build() {
+        const size_t WORDS_PER_BLOCK      = BLOCK_BITS / BITS_PER_WORD;
+        const size_t BLOCKS_PER_SUPERBLOCK = SUPERBLOCK_BITS / BLOCK_BITS;
+
+        const bit_word_t* words = bits_.data();
+        size_t n_words = bits_.n_words();
+        size_t size    = bits_.size();
+
+        // one entry more than needed, so rank1(size()) needs no special case
+        superblocks_.reserve(size / SUPERBLOCK_BITS + 1);
+        regions_.reserve(size / REGION_BITS + 1);
+
+        size_t n_ones = 0, region_start = 0;
+        for(size_t n_superblock = 0; n_superblock <= size / SUPERBLOCK_BITS; n_superblock++) {
+            if(n_superblock % (REGION_BITS / SUPERBLOCK_BITS) == 0) {
+                regions_.push_back(n_ones);
+                region_start = n_ones;
+            }
+
+            uint64_t entry = n_ones - region_start;
+            size_t superblock_start = n_ones;
+
+            for(size_t n_block = 0; n_block < BLOCKS_PER_SUPERBLOCK; n_block++) {
+                entry |= uint64_t(n_ones - superblock_start) << BLOCK_SHIFTS[n_block];
+
+                size_t n_first = (n_superblock * BLOCKS_PER_SUPERBLOCK + n_block) * WORDS_PER_BLOCK;
+                if(n_first < n_words) n_ones += simd::bit_words_popcount(words + n_first, std::min(WORDS_PER_BLOCK, n_words - n_first));
+            }
+            superblocks_.push_back(entry);
+
+            // a superblock holds less than SELECT_SAMPLE ones, so at most one sample starts in it
+            if(n_ones > samples_.size() * SELECT_SAMPLE && superblock_start <= samples_.size() * SELECT_SAMPLE) {
+                samples_.push_back(uint32_t(n_superblock));
+            }
+        }
+
+        n_ones_ = n_ones;
+    }
+};
+
+}; // namespace nstd
+
+#endif // NSTD_RANK_SELECT_H
@@ -0,0 +1,935 @@
+#ifndef NSTD_ROARING_BITMAP_H
+#define NSTD_ROARING_BITMAP_H
+
+#include <cstdlib>
+#include <stdexcept>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include "vector.hpp"
+#include "vector_bool.hpp"
+#include "flat_set.hpp"
+#include "move_semantics.hpp"
+
+// Compressed bitmap of uint32_t values in the layout of Roaring
+// (Lemire et al., "Consistently faster and smaller compressed bitmaps with Roaring"):
+// values are split by their high 16 bits into chunks, the low 16 bits of a chunk are kept in a container:
+// - array:  sorted uint16_t, for at most 4096 values
+// - bitmap: 65536-bit vector<bool>, for more values, so its word-parallel code does the dense work
+// - run:    sorted runs of consecutive values, when they are smaller than both (optimize(), add_range(), set algebra)
+// serialize() and deserialize() use the portable Roaring format (little endian), shared with the other implementations.
+
+namespace nstd{
+
+/// values [start, start + length]
+struct roaring_run{
+    uint16_t start;
+    uint16_t length;
+};
+
+/// low 16 bits of the values of one chunk. Never empty inside roaring_bitmap,
+/// array holds at most MAX_ARRAY values and bitmap more than that, as the serialized format requires
+class roaring_container{
+public:
+    enum type_t : uint8_t {
+        ARRAY,
+        BITMAP,
+        RUN
+    };
+
+    static const size_t MAX_ARRAY  = 4096;
+    static const size_t CHUNK_BITS = 65536;
+
+public:
+    roaring_container():
+        type_(ARRAY),
+        cardinality_(0){}
+
+    /// one run [first, last]
+    roaring_container(uint16_t first, uint16_t last):
+        type_(RUN),
+        cardinality_(uint32_t(last) - first + 1)
+    { runs_.push_back(roaring_run{first, uint16_t(last - first)}); }
+
+    type_t type() const
+    { return type_; }
+
+    size_t cardinality() const
+    { return cardinality_; }
+
+    bool contains(uint16_t low) const {
+        switch(type_) {
+            case ARRAY: {
+                size_t pos = flat_lower_bound(array_.data(), array_.size(), low, std::less<uint16_t>());
+                return pos < array_.size() && array_[pos] == low;
+            }
+            case BITMAP:
+                return (bitmap_.data()[low / BITS_PER_WORD] >> (low % BITS_PER_WORD)) & 1;
+            default: {
+                size_t n_run = runs_before(low);
+                return n_run && size_t(runs_[n_run - 1].start) + runs_[n_run - 1].length >= low;
+            }
+        }
+    }
+
+    /// whether low was not there. Run containers are unpacked by changes, optimize() packs them again
+    bool add(uint16_t low) {
+        if(type_ == RUN) unpack();
+
+        if(type_ == ARRAY) {
+            // sorted input is appended without a search
+            size_t pos = array_.empty() || low > array_.back() ? array_.size() :
+                         flat_lower_bound(array_.data(), array_.size(), low, std::less<uint16_t>());
+            if(pos < array_.size() && array_[pos] == low) return false;
+
+            if(array_.size() < MAX_ARRAY) {
+                array_.insert(array_.begin() + pos, low);
+                cardinality_++;
+                return true;
+            }
+            to_bitmap();
+        }
+
+        bit_word_t& word = bitmap_.data()[low / BITS_PER_WORD];
+        bit_word_t  mask = bit_word_t(1) << (low % BITS_PER_WORD);
+        if(word & mask) return false;
+
+        word |= mask;
+        cardinality_++;
+        return true;
+    }
+
+    /// whether low was there
+    bool remove(uint16_t low) {
+        if(type_ == RUN) unpack();
+
+        if(type_ == ARRAY) {
+            size_t pos = flat_lower_bound(array_.data(), array_.size(), low, std::less<uint16_t>());
+            if(pos == array_.size() || array_[pos] != low) return false;
+
+            array_.erase(array_.begin() + pos);
+            cardinality_--;
+            return true;
+        }
+
+        bit_word_t& word = bitmap_.data()[low / BITS_PER_WORD];
+        bit_word_t  mask = bit_word_t(1) << (low % BITS_PER_WORD);
+        if(!(word & mask)) return false;
+
+        word &= ~mask;
+        if(--cardinality_ <= MAX_ARRAY) to_array();
+        return true;
+    }
+
+    /// calls visit(base | low) for every value in ascending order
+    template<typename Visitor>
+    void for_each(uint32_t base, Visitor& visit) const {
+        switch(type_) {
+            case ARRAY:
+                for(size_t i = 0; i < array_.size(); i++) visit(base | array_[i]);
+                break;
+            case BITMAP:
+                bitmap_.for_each_set_bit([&](size_t low){ visit(base | uint32_t(low)); });
+                break;
+            default:
+                // counted by the offset, the last run of the last chunk ends at UINT32_MAX
+                for(size_t i = 0; i < runs_.size(); i++) {
+                    uint32_t first = base | runs_[i].start;
+                    for(uint32_t offset = 0; offset <= runs_[i].length; offset++) visit(first + offset);
+                }
+        }
+    }
+
+    // Cursor of iteration: pos is the array index, the bit or the run index, offset is the offset in the run.
+    // cursor_next() returns false after the last value
+
+    void cursor_first(size_t& pos, size_t& offset) const {
+        pos    = type_ == BITMAP ? bitmap_.find_first() : 0;
+        offset = 0;
+    }
+
+    bool cursor_next(size_t& pos, size_t& offset) const {
+        switch(type_) {
+            case ARRAY:
+                return ++pos < array_.size();
+            case BITMAP:
+                pos = bitmap_.find_next(pos);
+                return pos < CHUNK_BITS;
+            default:
+                if(++offset <= runs_[pos].length) return true;
+
+                offset = 0;
+                return ++pos < runs_.size();
+        }
+    }
+
+    uint16_t cursor_value(size_t pos, size_t offset) const {
+        switch(type_) {
+            case ARRAY:  return array_[pos];
+            case BITMAP: return uint16_t(pos);
+            default:     return uint16_t(runs_[pos].start + offset);
+        }
+    }
+
+    bool operator==(const roaring_container& other) const {
+        if(cardinality_ != other.cardinality_) return false;
+
+        if(type_ == other.type_) {
+            switch(type_) {
+                case ARRAY:  return std::equal(array_.data(), array_.data() + array_.size(), other.array_.data());
+                case BITMAP: return memcmp(bitmap_.data(), other.bitmap_.data(), CHUNK_BITS / 8) == 0;
+                default:     break;
+            }
+        }
+
+        size_t pos, offset, other_pos, other_offset;
+        cursor_first(pos, offset);
+        other.cursor_first(other_pos, other_offset);
+        for(size_t i = 0; i < cardinality_; i++) {
+            if(cursor_value(pos, offset) != other.cursor_value(other_pos, other_offset)) return false;
+
+            cursor_next(pos, offset);
+            other.cursor_next(other_pos, other_offset);
+        }
+        return true;
+    }
+
+    bool operator!=(const roaring_container& other) const
+    { return !(*this == other); }
+
+    static roaring_container intersect(const roaring_container& lhs, const roaring_container& rhs) {
+        if(lhs.type_ > rhs.type_) return intersect(rhs, lhs);
+
+        roaring_container res;
+        if(lhs.type_ == ARRAY) {
+            // the result is an array, its values are filtered by the other container
+            res.array_.reserve(std::min(lhs.cardinality_, rhs.cardinality_));
+            if(rhs.type_ == ARRAY) {
+                std::set_intersection(lhs.array_.data(), lhs.array_.data() + lhs.array_.size(),
+                                      rhs.array_.data(), rhs.array_.data() + rhs.array_.size(), std::back_inserter(res.array_));
+            }
+            else {
+                for(size_t i = 0; i < lhs.array_.size(); i++) {
+                    if(rhs.contains(lhs.array_[i])) res.array_.push_back(lhs.array_[i]);
+                }
+            }
+            res.cardinality_ = res.array_.size();
+        }
+        else if(lhs.type_ == BITMAP) {
+            res.type_ = BITMAP;
+            if(rhs.type_ == BITMAP) res.bitmap_ = lhs.bitmap_ & rhs.bitmap_;
+            else {
+                // bits between the runs are cleared
+                res.bitmap_ = lhs.bitmap_;
+                size_t n_first = 0;
+                for(size_t i = 0; i < rhs.runs_.size(); i++) {
+                    bits_fill(res.bitmap_.data(), n_first, rhs.runs_[i].start, false);
+                    n_first = size_t(rhs.runs_[i].start) + rhs.runs_[i].length + 1;
+                }
+                bits_fill(res.bitmap_.data(), n_first, CHUNK_BITS, false);
+            }
+            res.cardinality_ = res.bitmap_.count();
+        }
+        else {
+            res.type_ = RUN;
+            size_t i = 0, j = 0;
+            while(i < lhs.runs_.size() && j < rhs.runs_.size()) {
+                size_t lhs_last = size_t(lhs.runs_[i].start) + lhs.runs_[i].length;
+                size_t rhs_last = size_t(rhs.runs_[j].start) + rhs.runs_[j].length;
+                size_t first = std::max(lhs.runs_[i].start, rhs.runs_[j].start);
+                size_t last  = std::min(lhs_last, rhs_last);
+
+                if(first <= last) res.push_run(first, last);
+                if(lhs_last < rhs_last) i++;
+                else                    j++;
+            }
+        }
+
+        res.repack();
+        return res;
+    }
+
+    static roaring_container unite(const roaring_container& lhs, const roaring_container& rhs) {
+        if(lhs.type_ < rhs.type_) return unite(rhs, lhs);
+
+        roaring_container res;
+        if(lhs.type_ == RUN && rhs.type_ != BITMAP) {
+            // runs are merged, an array is taken as runs of single values
+            res.type_ = RUN;
+            roaring_container array_runs;
+            const vector<roaring_run>* other_runs = &rhs.runs_;
+            if(rhs.type_ == ARRAY) {
+                array_runs.runs_from_array(rhs);
+                other_runs = &array_runs.runs_;
+            }
+
+            const vector<roaring_run>& runs = lhs.runs_;
+            size_t i = 0, j = 0;
+            while(i < runs.size() || j < other_runs->size()) {
+                bool is_lhs = j == other_runs->size() || (i < runs.size() && runs[i].start <= (*other_runs)[j].start);
+                const roaring_run& run = is_lhs ? runs[i++] : (*other_runs)[j++];
+                res.merge_run(run.start, size_t(run.start) + run.length);
+            }
+        }
+        else if(lhs.type_ == ARRAY) {
+            // both are arrays
+            if(lhs.cardinality_ + rhs.cardinality_ <= MAX_ARRAY) {
+                res.array_.reserve(lhs.cardinality_ + rhs.cardinality_);
+                std::set_union(lhs.array_.data(), lhs.array_.data() + lhs.array_.size(),
+                               rhs.array_.data(), rhs.array_.data() + rhs.array_.size(), std::back_inserter(res.array_));
+                res.cardinality_ = res.array_.size();
+            }
+            else {
+                res = lhs;
+                res.to_bitmap();
+                res.set_bits(rhs);
+            }
+        }
+        else {
+            // a bitmap with anything, lhs is the bitmap unless rhs is one too
+            const roaring_container& bitmap = rhs.type_ == BITMAP ? rhs : lhs;
+            const roaring_container& other  = rhs.type_ == BITMAP ? lhs : rhs;
+
+            res.type_ = BITMAP;
+            if(other.type_ == BITMAP) {
+                res.bitmap_      = bitmap.bitmap_ | other.bitmap_;
+                res.cardinality_ = res.bitmap_.count();
+            }
+            else {
+                res.bitmap_      = bitmap.bitmap_;
+                res.cardinality_ = bitmap.cardinality_;
+                res.set_bits(other);
+            }
+        }
+
+        res.repack();
+        return res;
+    }
+
+    /// turns into runs, if they are smaller, and gives back unused capacity
+    void optimize() {
+        if(type_ == RUN)                                         repack();
+        else if(run_bytes(count_runs()) < serialized_bytes())    to_runs();
+
+        array_.shrink_to_fit();
+        runs_.shrink_to_fit();
+    }
+
+    size_t memory_bytes() const {
+        return array_.capacity() * sizeof(uint16_t) + bitmap_.capacity() / 8 +
+               runs_.capacity() * sizeof(roaring_run);
+    }
+
+    /// in the portable format, without the header
+    size_t serialized_bytes() const {
+        switch(type_) {
+            case ARRAY:  return cardinality_ * sizeof(uint16_t);
+            case BITMAP: return CHUNK_BITS / 8;
+            default:     return run_bytes(runs_.size());
+        }
+    }
+
+    uint8_t* serialize(uint8_t* out) const {
+        switch(type_) {
+            case ARRAY:
+                for(size_t i = 0; i < array_.size(); i++) out = put_le(out, array_[i], 2);
+                break;
+            case BITMAP:
+                for(size_t i = 0; i < CHUNK_BITS / BITS_PER_WORD; i++) out = put_le(out, bitmap_.data()[i], 8);
+                break;
+            default:
+                out = put_le(out, runs_.size(), 2);
+                for(size_t i = 0; i < runs_.size(); i++) {
+                    out = put_le(out, runs_[i].start, 2);
+                    out = put_le(out, runs_[i].length, 2);
+                }
+        }
+        return out;
+    }
+
+    /// reads a container of cardinality values from [in, in_end), returns the end of it
+    const uint8_t* deserialize(const uint8_t* in, const uint8_t* in_end, size_t cardinality, bool is_run) {
+        if(is_run) {
+            type_ = RUN;
+            if(in_end - in < 2) throw std::invalid_argument("truncated roaring bitmap");
+            size_t n_runs = get_le(in, 2);
+            in += 2;
+
+            if(size_t(in_end - in) < n_runs * 4) throw std::invalid_argument("truncated roaring bitmap");
+            size_t n_next = 0;
+            for(size_t i = 0; i < n_runs; i++, in += 4) {
+                size_t first = get_le(in, 2);
+                size_t last  = first + get_le(in + 2, 2);
+                if(first < n_next || last >= CHUNK_BITS) throw std::invalid_argument("malformed roaring run container");
+
+                push_run(first, last);
+                n_next = last + 1;
+            }
+        }
+        else if(cardinality <= MAX_ARRAY) {
+            type_ = ARRAY;
+            if(size_t(in_end - in) < cardinality * 2) throw std::invalid_argument("truncated roaring bitmap");
+
+            array_.reserve(cardinality);
+            for(size_t i = 0; i < cardinality; i++, in += 2) {
+                uint16_t low = uint16_t(get_le(in, 2));
+                if(i && low <= array_.back()) throw std::invalid_argument("malformed roaring array container");
+
+                array_.push_back(low);
+            }
+            cardinality_ = cardinality;
+        }
+        else {
+            type_ = BITMAP;
+            if(size_t(in_end - in) < CHUNK_BITS / 8) throw std::invalid_argument("truncated roaring bitmap");
+
+            bitmap_.assign(CHUNK_BITS, false);
+            for(size_t i = 0; i < CHUNK_BITS / BITS_PER_WORD; i++, in += 8) bitmap_.data()[i] = get_le(in, 8);
+            cardinality_ = bitmap_.count();
+        }
+
+        if(cardinality_ != cardinality) throw std::invalid_argument("malformed roaring bitmap cardinality");
+        return in;
+    }
+
+    static uint8_t* put_le(uint8_t* out, uint64_t value, size_t n_bytes) {
+        for(size_t i = 0; i < n_bytes; i++) out[i] = uint8_t(value >> (8 * i));
+        return out + n_bytes;
+    }
+
+    static uint64_t get_le(const uint8_t* in, size_t n_bytes) {
+        uint64_t value = 0;
+        for(size_t i = 0; i < n_bytes; i++) value |= uint64_t(in[i]) << (8 * i);
+        return value;
+    }
+
+private:
+    type_t              type_;
+    uint32_t            cardinality_;
+    vector<uint16_t>    array_;
+    vector<bool>        bitmap_;
+    vector<roaring_run> runs_;
+
+private:
+    static size_t run_bytes(size_t n_runs)
+    { return 2 + n_runs * sizeof(roaring_run); }
+
+    /// number of runs, which start at or before low
+    size_t runs_before(uint16_t low) const {
+        return std::upper_bound(runs_.data(), runs_.data() + runs_.size(), low,
+                                [](uint16_t value, const roaring_run& run){ return value < run.start; }) - runs_.data();
+    }
+
+    /// appends [first, last] after the runs
+    void push_run(size_t first, size_t last) {
+        runs_.push_back(roaring_run{uint16_t(first), uint16_t(last - first)});
+        cardinality_ += last - first + 1;
+    }
+
+    /// adds [first, last], which starts not before the last run, joining it when they touch
+    void merge_run(size_t first, size_t last) {
+        if(!runs_.empty()) {
+            roaring_run& back = runs_.back();
+            size_t back_last  = size_t(back.start) + back.length;
+            if(first <= back_last + 1) {
+                if(last > back_last) {
+                    back.length   = uint16_t(last - back.start);
+                    cardinality_ += last - back_last;
+                }
+                return;
+            }
+        }
+        push_run(first, last);
+    }
+
+    void runs_from_array(const roaring_container& array) {
+        type_ = RUN;
+        for(size_t i = 0; i < array.array_.size(); i++) merge_run(array.array_[i], array.array_[i]);
+    }
+
+    size_t count_runs() const {
+        if(type_ == RUN) return runs_.size();
+
+        size_t n_runs = 0;
+        if(type_ == ARRAY) {
+            for(size_t i = 0; i < array_.size(); i++) n_runs += i == 0 || array_[i] != array_[i - 1] + 1;
+        }
+        else {
+            // a run starts at every set bit, which follows an unset one
+            bit_word_t carry = 0;
+            for(size_t i = 0; i < CHUNK_BITS / BITS_PER_WORD; i++) {
+                bit_word_t word = bitmap_.data()[i];
+                n_runs += __builtin_popcountll(word & ~((word << 1) | carry));
+                carry = word >> (BITS_PER_WORD - 1);
+            }
+        }
+        return n_runs;
+    }
+
+    /// sets the values of an array or run container in the bitmap
+    void set_bits(const roaring_container& other) {
+        bit_word_t* words = bitmap_.data();
+        if(other.type_ == ARRAY) {
+            for(size_t i = 0; i < other.array_.size(); i++) {
+                words[other.array_[i] / BITS_PER_WORD] |= bit_word_t(1) << (other.array_[i] % BITS_PER_WORD);
+            }
+        }
+        else {
+            for(size_t i = 0; i < other.runs_.size(); i++) {
+                bits_fill(words, other.runs_[i].start, size_t(other.runs_[i].start) + other.runs_[i].length + 1, true);
+            }
+        }
+        cardinality_ = bitmap_.count();
+    }
+
+    void to_bitmap() {
+        bitmap_.assign(CHUNK_BITS, false);
+        set_bits(*this);
+
+        type_   = BITMAP;
+        array_  = vector<uint16_t>();
+        runs_   = vector<roaring_run>();
+    }
+
+    void to_array() {
+        vector<uint16_t> array;
+        array.reserve(cardinality_);
+        auto push = [&](uint32_t low){ array.push_back(uint16_t(low)); };
+        for_each(0, push);
+
+        type_   = ARRAY;
+        array_  = nstd::move(array);
+        bitmap_ = vector<bool>();
+        runs_   = vector<roaring_run>();
+    }
+
+    void to_runs() {
+        vector<roaring_run> runs;
+        runs.reserve(count_runs());
+
+        if(type_ == ARRAY) {
+            roaring_container packed;
+            packed.runs_from_array(*this);
+            runs = nstd::move(packed.runs_);
+        }
+        else {
+            // set bits are found by the word scans of vector<bool>
+            for(size_t first = bitmap_.find_first(); first < CHUNK_BITS; ) {
+                size_t end = bitmap_.find_next_unset(first);
+                runs.push_back(roaring_run{uint16_t(first), uint16_t(end - 1 - first)});
+                first = end < CHUNK_BITS ? bitmap_.find_next(end) : CHUNK_BITS;
+            }
+        }
+
+        type_   = RUN;
+        runs_   = nstd::move(runs);
+        array_  = vector<uint16_t>();
+        bitmap_ = vector<bool>();
+    }
+
+    void unpack() {
+        if(cardinality_ <= MAX_ARRAY) to_array();
+        else                          to_bitmap();
+    }
+
+    /// array or bitmap by cardinality, runs are kept only while they are smaller
+    void repack() {
+        if(type_ == RUN) {
+            size_t plain_bytes = cardinality_ <= MAX_ARRAY ? cardinality_ * sizeof(uint16_t) : CHUNK_BITS / 8;
+            if(run_bytes(runs_.size()) >= plain_bytes) unpack();
+        }
+        else if(type_ == ARRAY && cardinality_ > MAX_ARRAY)   to_bitmap();
+        else if(type_ == BITMAP && cardinality_ <= MAX_ARRAY) to_array();
+    }
+};
+
+/// set of uint32_t as sorted chunk keys and their containers. Lookups binary search the keys,
+/// set algebra walks both key lists and combines containers of equal keys by their types
+class roaring_bitmap{
+public:
+    class const_iterator{
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef uint32_t                  value_type;
+        typedef ptrdiff_t                 difference_type;
+        typedef const uint32_t*           pointer;
+        typedef uint32_t                  reference;
+
+    public:
+        const_iterator():
+            owner_(NULL),
+            n_container_(0),
+            pos_(0),
+            offset_(0){}
+
+        const_iterator(const roaring_bitmap* owner, size_t n_container):
+            owner_(owner),
+            n_container_(n_container),
+            pos_(0),
+            offset_(0)
+        {
+            if(n_container_ < owner_->containers_.size()) owner_->containers_[n_container_].cursor_first(pos_, offset_);
+        }
+
+        uint32_t operator*() const {
+            return (uint32_t(owner_->keys_[n_container_]) << 16) |
+                   owner_->containers_[n_container_].cursor_value(pos_, offset_);
+        }
+
+        const_iterator& operator++() {
+            if(owner_->containers_[n_container_].cursor_next(pos_, offset_)) return *this;
+
+            if(++n_container_ < owner_->containers_.size()) owner_->containers_[n_container_].cursor_first(pos_, offset_);
+            else                                             pos_ = offset_ = 0;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator& other) const
+        { return n_container_ == other.n_container_ && pos_ == other.pos_ && offset_ == other.offset_; }
+
+        bool operator!=(const const_iterator& other) const
+        { return !(*this == other); }
+
+    private:
+        const roaring_bitmap* owner_;
+        size_t                n_container_;
+        size_t                pos_;
+        size_t                offset_;
+    };
+
+    typedef const_iterator iterator;
+
+    static const uint32_t SERIAL_COOKIE_NO_RUNS = 12346;
+    static const uint32_t SERIAL_COOKIE         = 12347;
+
+public:
+    roaring_bitmap():
+        size_(0){}
+
+    template<legacy_input_iterator ItFrom>
+    roaring_bitmap(ItFrom start, ItFrom last):
+        size_(0)
+    {
+        for(; start != last; ++start) add(*start);
+    }
+
+    size_t size() const
+    { return size_; }
+
+    bool empty() const
+    { return size_ == 0; }
+
+    /// number of chunks in use
+    size_t n_containers() const
+    { return containers_.size(); }
+
+    void clear() {
+        keys_.clear();
+        containers_.clear();
+        size_ = 0;
+    }
+
+    bool contains(uint32_t value) const {
+        size_t pos = find_key(value >> 16);
+        return pos < keys_.size() && keys_[pos] == value >> 16 && containers_[pos].contains(uint16_t(value));
+    }
+
+    /// whether value was not there
+    bool add(uint32_t value) {
+        // sorted input stays in the last chunk, it is checked before the search
+        size_t pos = !keys_.empty() && keys_.back() == value >> 16 ? keys_.size() - 1 : find_or_insert(value >> 16);
+
+        bool is_added = containers_[pos].add(uint16_t(value));
+        size_ += is_added;
+        return is_added;
+    }
+
+    /// adds [first, last), whole chunks become single runs
+    void add_range(uint64_t first, uint64_t last) {
+        if(last > (uint64_t(1) << 32))
+            throw std::out_of_range("roaring_bitmap range out of range");
+
+        while(first < last) {
+            uint64_t chunk_last = std::min(last, (first | 0xFFFF) + 1) - 1;
+            size_t pos = find_or_insert(uint16_t(first >> 16));
+
+            roaring_container range{uint16_t(first), uint16_t(chunk_last)};
+            size_ -= containers_[pos].cardinality();
+            containers_[pos] = roaring_container::unite(containers_[pos], range);
+            size_ += containers_[pos].cardinality();
+
+            first = chunk_last + 1;
+        }
+    }
+
+    /// whether value was there
+    bool remove(uint32_t value) {
+        size_t pos = find_key(value >> 16);
+        if(pos == keys_.size() || keys_[pos] != value >> 16) return false;
+
+        if(!containers_[pos].remove(uint16_t(value))) return false;
+        if(containers_[pos].cardinality() == 0) {
+            keys_.erase(keys_.begin() + pos);
+            containers_.erase(containers_.begin() + pos);
+        }
+        size_--;
+        return true;
+    }
+
+    /// turns containers into runs, where they are smaller, and gives back unused capacity
+    void optimize() {
+        for(size_t i = 0; i < containers_.size(); i++) containers_[i].optimize();
+
+        keys_.shrink_to_fit();
+        containers_.shrink_to_fit();
+    }
+
+    roaring_bitmap& operator&=(const roaring_bitmap& other)
+    { return *this = *this & other; }
+
+    roaring_bitmap& operator|=(const roaring_bitmap& other)
+    { return *this = *this | other; }
+
+    friend roaring_bitmap operator&(const roaring_bitmap& lhs, const roaring_bitmap& rhs) {
+        roaring_bitmap res;
+
+        size_t i = 0, j = 0;
+        while(i < lhs.keys_.size() && j < rhs.keys_.size()) {
+            if(lhs.keys_[i] < rhs.keys_[j])      i++;
+            else if(rhs.keys_[j] < lhs.keys_[i]) j++;
+            else {
+                roaring_container both = roaring_container::intersect(lhs.containers_[i], rhs.containers_[j]);
+                if(both.cardinality()) res.push_container(lhs.keys_[i], nstd::move(both));
+                i++;
+                j++;
+            }
+        }
+        return res;
+    }
+
+    friend roaring_bitmap operator|(const roaring_bitmap& lhs, const roaring_bitmap& rhs) {
+        roaring_bitmap res;
+        res.keys_.reserve(lhs.keys_.size() + rhs.keys_.size());
+        res.containers_.reserve(lhs.keys_.size() + rhs.keys_.size());
+
+        size_t i = 0, j = 0;
+        while(i < lhs.keys_.size() || j < rhs.keys_.size()) {
+            if(j == rhs.keys_.size() || (i < lhs.keys_.size() && lhs.keys_[i] < rhs.keys_[j])) {
+                res.push_container(lhs.keys_[i], lhs.containers_[i]);
+                i++;
+            }
+            else if(i == lhs.keys_.size() || rhs.keys_[j] < lhs.keys_[i]) {
+                res.push_container(rhs.keys_[j], rhs.containers_[j]);
+                j++;
+            }
+            else {
+                res.push_container(lhs.keys_[i], roaring_container::unite(lhs.containers_[i], rhs.containers_[j]));
+                i++;
+                j++;
+            }
+        }
+        return res;
+    }
+
+    bool operator==(const roaring_bitmap& other) const {
+        if(size_ != other.size_ || keys_.size() != other.keys_.size()) return false;
+
+        for(size_t i = 0; i < keys_.size(); i++) {
+            if(keys_[i] != other.keys_[i] || containers_[i] != other.containers_[i]) return false;
+        }
+        return true;
+    }
+
+    bool operator!=(const roaring_bitmap& other) const
+    { return !(*this == other); }
+
+    /// calls visit(value) for every value in ascending order, faster than the iterators
+    template<typename Visitor>
+    void for_each(Visitor visit) const {
+        for(size_t i = 0; i < containers_.size(); i++) containers_[i].for_each(uint32_t(keys_[i]) << 16, visit);
+    }
+
+    const_iterator begin() const
+    { return const_iterator(this, 0); }
+
+    const_iterator end() const
+    { return const_iterator(this, containers_.size()); }
+
+    const_iterator cbegin() const
+    { return begin(); }
+
+    const_iterator cend() const
+    { return end(); }
+
+    /// heap and object bytes
+    size_t memory_bytes() const {
+        size_t res = sizeof(*this) + keys_.capacity() * sizeof(uint16_t) + containers_.capacity() * sizeof(roaring_container);
+        for(size_t i = 0; i < containers_.size(); i++) res += containers_[i].memory_bytes();
+
+        return res;
+    }
+
+    /// size of serialize() output
+    size_t serialized_size() const {
+        bool has_runs = this->has_runs();
+        size_t n = containers_.size();
+
+        size_t res = has_runs ? 4 + (n + 7) / 8 : 8;
+        res += n * 4;
+        if(!has_runs || n >= NO_OFFSET_THRESHOLD) res += n * 4;
+        for(size_t i = 0; i < n; i++) res += containers_[i].serialized_bytes();
+
+        return res;
+    }
+
+    /// the portable Roaring format: cookie, run flags, keys and cardinalities, offsets, containers
+    vector<uint8_t> serialize() const {
+        vector<uint8_t> res(serialized_size());
+        uint8_t* out = res.data();
+
+        bool has_runs = this->has_runs();
+        size_t n = containers_.size();
+
+        if(has_runs) {
+            out = roaring_container::put_le(out, SERIAL_COOKIE | ((n - 1) << 16), 4);
+            memset(out, 0, (n + 7) / 8);
+            for(size_t i = 0; i < n; i++) {
+                if(containers_[i].type() == roaring_container::RUN) out[i / 8] |= uint8_t(1 << (i % 8));
+            }
+            out += (n + 7) / 8;
+        }
+        else {
+            out = roaring_container::put_le(out, SERIAL_COOKIE_NO_RUNS, 4);
+            out = roaring_container::put_le(out, n, 4);
+        }
+
+        for(size_t i = 0; i < n; i++) {
+            out = roaring_container::put_le(out, keys_[i], 2);
+            out = roaring_container::put_le(out, containers_[i].cardinality() - 1, 2);
+        }
+
+        if(!has_runs || n >= NO_OFFSET_THRESHOLD) {
+            size_t offset = (out - res.data()) + n * 4;
+            for(size_t i = 0; i < n; i++) {
+                out = roaring_container::put_le(out, offset, 4);
+                offset += containers_[i].serialized_bytes();
+            }
+        }
+
+        for(size_t i = 0; i < n; i++) out = containers_[i].serialize(out);
+
+        return res;
+    }
+
+    /// throws std::invalid_argument for malformed or truncated input
+    static roaring_bitmap deserialize(const uint8_t* data, size_t n_bytes) {
+        const uint8_t* in     = data;
+        const uint8_t* in_end = data + n_bytes;
+        auto require = [&](size_t n_needed) {
+            if(size_t(in_end - in) < n_needed) throw std::invalid_argument("truncated roaring bitmap");
+        };
+
+        require(4);
+        uint32_t cookie = uint32_t(roaring_container::get_le(in, 4));
+        in += 4;
+
+        size_t n;
+        const uint8_t* run_flags = NULL;
+        if((cookie & 0xFFFF) == SERIAL_COOKIE) {
+            n = (cookie >> 16) + 1;
+            require((n + 7) / 8);
+            run_flags = in;
+            in += (n + 7) / 8;
+        }
+        else if(cookie == SERIAL_COOKIE_NO_RUNS) {
+            require(4);
+            n = roaring_container::get_le(in, 4);
+            in += 4;
+            if(n > (size_t(1) << 16)) throw std::invalid_argument("malformed roaring bitmap");
+        }
+        else throw std::invalid_argument("unknown roaring bitmap cookie");
+
+        require(n * 4);
+        const uint8_t* header = in;
+        in += n * 4;
+        if(!run_flags || n >= NO_OFFSET_THRESHOLD) {
+            require(n * 4);
+            in += n * 4;
+        }
+
+        roaring_bitmap res;
+        res.keys_.reserve(n);
+        res.containers_.reserve(n);
+        for(size_t i = 0; i < n; i++) {
+            uint16_t key       = uint16_t(roaring_container::get_le(header + 4 * i, 2));
+            size_t cardinality = roaring_container::get_le(header + 4 * i + 2, 2) + 1;
+            bool is_run        = run_flags && (run_flags[i / 8] >> (i % 8)) & 1;
+            if(i && key <= res.keys_.back()) throw std::invalid_argument("malformed roaring bitmap keys");
+
+            roaring_container container;
+            in = container.deserialize(in, in_end, cardinality, is_run);
+            res.push_container(key, nstd::move(container));
+        }
+        return res;
+    }
+
+    template<typename Range>
+    static roaring_bitmap deserialize(const Range& bytes)
+    { return deserialize(bytes.data(), bytes.size()); }
+
+    void swap(roaring_bitmap& other) {
+        keys_.swap(other.keys_);
+        containers_.swap(other.containers_);
+        std::swap(size_, other.size_);
+    }
+
+private:
+    /// with fewer run containers the format has no offsets
+    static const size_t NO_OFFSET_THRESHOLD = 4;
+
+    vector<uint16_t>          keys_;
+    vector<roaring_container> containers_;
+    size_t                    size_;
+
+private:
+    size_t find_key(uint16_t key) const
+    { return flat_lower_bound(keys_.data(), keys_.size(), key, std::less<uint16_t>()); }
+
+    size_t find_or_insert(uint16_t key) {
+        size_t pos = find_key(key);
+        if(pos == keys_.size() || keys_[pos] != key) {
+            keys_.insert(keys_.begin() + pos, key);
+            containers_.insert(containers_.begin() + pos, roaring_container());
+        }
+        return pos;
+    }
+
+    /// appends a container with a key after all the others
+    void push_container(uint16_t key, roaring_container container) {
+        size_ += container.cardinality();
+        keys_.push_back(key);
+        containers_.push_back(nstd::move(container));
+    }
+
+    bool has_runs() const {
+        for(size_t i = 0; i < containers_.size(); i++) {
+            if(containers_[i].type() == roaring_container::RUN) return true;
+        }
+        return false;
+    }
+};
+
+inline void swap(roaring_bitmap& lhs, roaring_bitmap& rhs)
+{ lhs.swap(rhs); }
+
+}; // namespace nstd
+
+#endif // NSTD_ROARING_BITMAP_H
@@ -0,0 +1,460 @@
+#ifndef NSTD_SEGMENTED_VECTOR_H
+#define NSTD_SEGMENTED_VECTOR_H
+
+#include <cstdlib>
+#include <stdexcept>
+#include <stdint.h>
+#include <memory>
+#include "construction.hpp"
+#include "iterator.hpp"
+#include "move_semantics.hpp"
+#include "check_policy.hpp"
+
+namespace nstd{
+
+/// random access over the block table of segmented_vector: index is kept, element address is computed on access
+template<typename Pt, size_t LogFirst>
+class segmented_iterator
+{
+public:
+    typedef std::random_access_iterator_tag                          iterator_category;
+    typedef typename std::iterator_traits<Pt>::value_type            value_type;
+    typedef ptrdiff_t                                                difference_type;
+    typedef Pt                                                       pointer;
+    typedef typename std::iterator_traits<Pt>::reference             reference;
+
+    template<typename PtOther, size_t LogFirstOther> friend class segmented_iterator;
+
+public:
+    segmented_iterator():
+        blocks_(NULL),
+        n_elem_(0){}
+
+    segmented_iterator(const Pt* blocks, size_t n_elem):
+        blocks_(blocks),
+        n_elem_(n_elem){}
+
+    segmented_iterator(const segmented_iterator& other) = default;
+
+    /// iterator to const_iterator
+    template<typename PtOther>
+        requires (!std::is_same_v<Pt, PtOther> && std::is_convertible_v<PtOther, Pt>)
+    segmented_iterator(const segmented_iterator<PtOther, LogFirst>& other):
+        blocks_(other.blocks_),
+        n_elem_(other.n_elem_){}
+
+    segmented_iterator& operator =(const segmented_iterator& other) = default;
+
+    ~segmented_iterator() = default;
+
+    reference operator *() const
+    { return *address(n_elem_); }
+
+    pointer operator ->() const
+    { return address(n_elem_); }
+
+    reference operator [](difference_type idx) const
+    { return *address(n_elem_ + idx); }
+
+    segmented_iterator& operator ++() {
+        n_elem_++;
+        return *this;
+    }
+
+    segmented_iterator operator ++(int)
+    { return segmented_iterator(blocks_, n_elem_++); }
+
+    segmented_iterator& operator --() {
+        n_elem_--;
+        return *this;
+    }
+
+    segmented_iterator operator --(int)
+    { return segmented_iterator(blocks_, n_elem_--); }
+
+    segmented_iterator  operator +(difference_type offset) const
+    { return segmented_iterator(blocks_, n_elem_ + offset); }
+
+    segmented_iterator& operator +=(difference_type offset){
+        n_elem_ += offset;
+        return *this;
+    }
+
+    segmented_iterator operator -(difference_type offset) const
+    { return segmented_iterator(blocks_, n_elem_ - offset); }
+
+    segmented_iterator& operator -=(difference_type offset) {
+        n_elem_ -= offset;
+        return *this;
+    }
+
+    difference_type operator -(const segmented_iterator& other) const
+    { return difference_type(n_elem_ - other.n_elem_); }
+
+    bool operator ==(const segmented_iterator& other) const
+    { return n_elem_ == other.n_elem_; }
+
+    bool operator !=(const segmented_iterator& other) const
+    { return n_elem_ != other.n_elem_; }
+
+    bool operator >(const segmented_iterator& other) const
+    { return n_elem_ > other.n_elem_; }
+
+    bool operator >=(const segmented_iterator& other) const
+    { return n_elem_ >= other.n_elem_; }
+
+    bool operator <(const segmented_iterator& other) const
+    { return n_elem_ < other.n_elem_; }
+
+    bool operator <=(const segmented_iterator& other) const
+    { return n_elem_ <= other.n_elem_; }
+
+    /// block number and offset in it: elements are numbered from FIRST_BLOCK, so block k starts at 2^(k + LogFirst)
+    static void locate(size_t n_elem, size_t& n_block, size_t& offset) {
+        size_t shifted = n_elem + (size_t(1) << LogFirst);
+        size_t log     = 63 - __builtin_clzll(shifted);
+
+        n_block = log - LogFirst;
+        offset  = shifted - (size_t(1) << log);
+    }
+
+private:
+    Pt address(size_t n_elem) const {
+        size_t n_block = 0, offset = 0;
+        locate(n_elem, n_block, offset);
+
+        return blocks_[n_block] + offset;
+    }
+
+private:
+    const Pt* blocks_;
+    size_t    n_elem_;
+};
+
+/// vector, which never moves its elements: storage is a table of blocks of 2^LogFirst, 2^(LogFirst + 1), ... elements,
+/// so growth allocates one more block and never copies. References, pointers and iterators stay valid
+/// until the element is removed (iterators refer to the block table, so they don't survive moves and swaps),
+/// push_back has no O(n) worst case.
+/// Elements are not contiguous, data() is absent, indexing costs one clz and one extra load
+template<typename T, template <typename> class Alloc = std::allocator, class CheckPolicy = default_check_policy,
+         size_t LogFirst = 4>
+class segmented_vector : public Alloc<T>{
+public:
+    typedef segmented_iterator<T*, LogFirst>                             iterator;
+    typedef segmented_iterator<const T*, LogFirst>                       const_iterator;
+    typedef reverse_ra_iterator_default<iterator>                        reverse_iterator;
+    typedef reverse_ra_iterator_default<const_iterator>                  const_reverse_iterator;
+
+    typedef T&                                                           reference;
+    typedef const T&                                                     const_reference;
+
+    static const size_t FIRST_BLOCK = size_t(1) << LogFirst;
+    /// enough blocks to address whole size_t
+    static const size_t MAX_BLOCKS  = 64 - LogFirst;
+
+public:
+    segmented_vector():
+        blocks_(),
+        n_blocks_(0),
+        size_(0){}
+
+    explicit segmented_vector(size_t size, const T& def_val = T()):
+        segmented_vector()
+    {
+        // constructor is delegated, so the destructor cleans up if an element throws
+        reserve(size);
+        for(size_t i = 0; i < size; i++) emplace_back(def_val);
+    }
+
+    segmented_vector(const segmented_vector& other):
+        Alloc<T>(other),
+        blocks_(),
+        n_blocks_(0),
+        size_(0)
+    {
+        try {
+            reserve(other.size_);
+            for(size_t i = 0; i < other.size_; i++) emplace_back(other[i]);
+        } catch(...) {
+            destroy_all();
+            throw;
+        }
+    }
+
+    segmented_vector(segmented_vector&& other):
+        segmented_vector()
+    { steal(other); }
+
+    template<legacy_input_iterator ItFrom>
+    segmented_vector(ItFrom start, ItFrom last):
+        segmented_vector()
+    {
+        if constexpr(legacy_forward_iterator<ItFrom>) reserve(std::distance(start, last));
+
+        for(; start != last; ++start) emplace_back(*start);
+    }
+
+    ~segmented_vector()
+    { destroy_all(); }
+
+    segmented_vector& operator=(const segmented_vector& other) {
+        segmented_vector tmp = other;
+        *this = nstd::move(tmp);
+
+        return *this;
+    }
+
+    segmented_vector& operator=(segmented_vector&& other) {
+        if(this == &other) return *this;
+
+        clear();
+        steal(other);
+
+        return *this;
+    }
+
+    void swap(segmented_vector& other) {
+        if constexpr(IS_ALLOC_ALWAYS_EQUAL) {
+            std::swap(blocks_,   other.blocks_);
+            std::swap(n_blocks_, other.n_blocks_);
+            std::swap(size_,     other.size_);
+        }
+        else {
+            segmented_vector tmp(nstd::move(other));
+            other = nstd::move(*this);
+            *this = nstd::move(tmp);
+        }
+    }
+
+    reference at(size_t n_elem) {
+        if(n_elem >= size_)
+            throw std::out_of_range("out of range");
+
+        return *address(n_elem);
+    }
+
+    const_reference at(size_t n_elem) const {
+        if(n_elem >= size_)
+            throw std::out_of_range("out of range");
+
+        return *address(n_elem);
+    }
+
+    reference operator[](size_t n_elem) {
+        CheckPolicy::check(n_elem, size_);
+        return *address(n_elem);
+    }
+
+    const_reference operator[](size_t n_elem) const {
+        CheckPolicy::check(n_elem, size_);
+        return *address(n_elem);
+    }
+
+    reference front() {
+        CheckPolicy::check(0, size_);
+        return *blocks_[0];
+    }
+
+    const_reference front() const {
+        CheckPolicy::check(0, size_);
+        return *blocks_[0];
+    }
+
+    reference back() {
+        CheckPolicy::check(size_ - 1, size_);
+        return *address(size_ - 1);
+    }
+
+    const_reference back() const {
+        CheckPolicy::check(size_ - 1, size_);
+        return *address(size_ - 1);
+    }
+
+    bool empty() const
+    { return size_ == 0; }
+
+    size_t size() const
+    { return size_; }
+
+    size_t capacity() const
+    { return n_blocks_ ? block_begin(n_blocks_) : 0; }
+
+    /// allocates blocks up front, no element is moved
+    void reserve(size_t capacity) {
+        while(this->capacity() < capacity) add_block();
+    }
+
+    /// gives back the blocks above the last element
+    void shrink_to_fit() {
+        while(n_blocks_ && block_begin(n_blocks_ - 1) >= size_) remove_block();
+    }
+
+    void clear() {
+        destroy_elements();
+    }
+
+    void push_back(const T& val)
+    { emplace_back(val); }
+
+    void push_back(T&& val)
+    { emplace_back(nstd::move(val)); }
+
+    template<typename... Args>
+    reference emplace_back(Args&&... args) {
+        // existing elements never move, so args referring to them stay valid
+        if(size_ == capacity()) add_block();
+
+        T* place = address(size_);
+        new (place) T(nstd::forward<Args>(args)...);
+        size_++;
+
+        return *place;
+    }
+
+    /// storage is kept, only shrink_to_fit() frees blocks
+    T pop_back() {
+        if(size_ == 0)
+            throw std::out_of_range("pop_back on empty vector");
+
+        T* place = address(size_ - 1);
+        T val = nstd::move(*place);
+        place->~T();
+        size_--;
+
+        return val;
+    }
+
+    void resize(size_t n_elems) {
+        while(size_ > n_elems) pop_last();
+
+        reserve(n_elems);
+        while(size_ < n_elems) emplace_back();
+    }
+
+    void resize(size_t n_elems, const T& val) {
+        while(size_ > n_elems) pop_last();
+
+        reserve(n_elems);
+        while(size_ < n_elems) emplace_back(val);
+    }
+
+    iterator begin()
+    { return iterator(blocks_, 0); }
+
+    const_iterator begin() const
+    { return const_iterator(blocks_, 0); }
+
+    const_iterator cbegin() const
+    { return const_iterator(blocks_, 0); }
+
+    reverse_iterator rbegin()
+    { return reverse_iterator(end()); }
+
+    const_reverse_iterator crbegin() const
+    { return const_reverse_iterator(cend()); }
+
+    iterator end()
+    { return iterator(blocks_, size_); }
+
+    const_iterator end() const
+    { return const_iterator(blocks_, size_); }
+
+    const_iterator cend() const
+    { return const_iterator(blocks_, size_); }
+
+    reverse_iterator rend()
+    { return reverse_iterator(begin()); }
+
+    const_reverse_iterator crend() const
+    { return const_reverse_iterator(cbegin()); }
+
+protected:
+    static constexpr bool IS_ALLOC_ALWAYS_EQUAL = std::allocator_traits<Alloc<T>>::is_always_equal::value;
+
+    static size_t block_size(size_t n_block)
+    { return FIRST_BLOCK << n_block; }
+
+    static size_t block_begin(size_t n_block)
+    { return (FIRST_BLOCK << n_block) - FIRST_BLOCK; }
+
+    T* address(size_t n_elem) const {
+        size_t n_block = 0, offset = 0;
+        iterator::locate(n_elem, n_block, offset);
+
+        return blocks_[n_block] + offset;
+    }
+
+    void add_block() {
+        if(n_blocks_ == MAX_BLOCKS)
+            throw std::length_error("segmented_vector is too long");
+
+        blocks_[n_blocks_] = this->allocate(block_size(n_blocks_));
+        n_blocks_++;
+    }
+
+    void remove_block() {
+        n_blocks_--;
+        this->deallocate(blocks_[n_blocks_], block_size(n_blocks_));
+        blocks_[n_blocks_] = NULL;
+    }
+
+    void pop_last() {
+        address(size_ - 1)->~T();
+        size_--;
+    }
+
+    void destroy_elements() {
+        for(size_t n_block = 0; n_block < n_blocks_ && block_begin(n_block) < size_; n_block++) {
+            size_t n_elems = size_ - block_begin(n_block);
+            destroy_n(blocks_[n_block], n_elems < block_size(n_block) ? n_elems : block_size(n_block));
+        }
+        size_ = 0;
+    }
+
+    void destroy_all() {
+        destroy_elements();
+        while(n_blocks_) remove_block();
+    }
+
+    // this must be empty
+    void steal(segmented_vector& other) {
+        if constexpr(IS_ALLOC_ALWAYS_EQUAL) {
+            while(n_blocks_) remove_block();
+
+            for(size_t n_block = 0; n_block < other.n_blocks_; n_block++) {
+                blocks_[n_block]       = other.blocks_[n_block];
+                other.blocks_[n_block] = NULL;
+            }
+            n_blocks_ = other.n_blocks_;
+            size_     = other.size_;
+
+            other.n_blocks_ = 0;
+            other.size_     = 0;
+        }
+        else {
+            // blocks belong to the other's allocator, so elements are relocated block by block
+            reserve(other.size_);
+
+            for(size_t n_block = 0; n_block < other.n_blocks_ && block_begin(n_block) < other.size_; n_block++) {
+                size_t n_elems = other.size_ - block_begin(n_block);
+                uninitialized_relocate_n(other.blocks_[n_block], n_elems < block_size(n_block) ? n_elems : block_size(n_block),
+                                         blocks_[n_block]);
+            }
+            size_       = other.size_;
+            other.size_ = 0;
+        }
+    }
+
+protected:
+    T*      blocks_[MAX_BLOCKS];
+    size_t  n_blocks_;
+    size_t  size_;
+};
+
+template<typename T, template <typename> class Alloc, class CheckPolicy, size_t LogFirst>
+void swap(segmented_vector<T, Alloc, CheckPolicy, LogFirst>& lhs, segmented_vector<T, Alloc, CheckPolicy, LogFirst>& rhs)
+{ lhs.swap(rhs); }
+
+}; // namespace nstd
+
+#endif // NSTD_SEGMENTED_VECTOR_H
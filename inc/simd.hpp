@@ -0,0 +1,818 @@
+#ifndef NSTD_SIMD_H
+#define NSTD_SIMD_H
+
+#include <string.h>
+#include <stdint.h>
+#include <cmath>
+#include <stdexcept>
+#include <concepts>
+#include <immintrin.h>
+#include "vector.hpp"
+
+// Numeric kernels over contiguous arrays of int32_t, int64_t, float and double.
+// Every kernel has scalar, SSE4.2, AVX2 and AVX-512 versions, the best one supported by the cpu
+// is chosen at runtime (cpuid), any of them could be requested explicitly by isa argument.
+// Float sums and dot products are accumulated lane-wise, so they differ from the scalar order
+// in rounding; min/max don't define the result for NaNs.
+// Bit kernels combine, count and scan arrays of uint64_t words, they back the set algebra and
+// the searches of vector<bool>.
+
+namespace nstd{
+namespace simd{
+
+enum isa_t {
+    ISA_SCALAR,
+    ISA_SSE42,
+    ISA_AVX2,
+    ISA_AVX512
+};
+
+inline bool is_supported(isa_t isa) {
+    switch(isa) {
+        case ISA_SCALAR: return true;
+        case ISA_SSE42:  return __builtin_cpu_supports("sse4.2");
+        case ISA_AVX2:   return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case ISA_AVX512: return __builtin_cpu_supports("avx512f");
+    }
+    return false;
+}
+
+inline isa_t best_isa() {
+    static const isa_t isa = is_supported(ISA_AVX512) ? ISA_AVX512 :
+                             is_supported(ISA_AVX2)   ? ISA_AVX2   :
+                             is_supported(ISA_SSE42)  ? ISA_SSE42  : ISA_SCALAR;
+    return isa;
+}
+
+/// word-wise operations of the bit kernels, ANDNOT is lhs & ~rhs
+enum bit_op_t {
+    BIT_AND,
+    BIT_OR,
+    BIT_XOR,
+    BIT_ANDNOT
+};
+
+template<typename T>
+concept kernel_type = std::same_as<T, int32_t> || std::same_as<T, int64_t> ||
+                      std::same_as<T, float>   || std::same_as<T, double>;
+
+namespace detail{
+
+#define NSTD_SIMD_INLINE inline __attribute__((always_inline))
+
+/// lhs = lhs OP rhs, for words and vectors of words. Vectors go by reference: passing them by value
+/// out of their ISA would change the ABI
+template<bit_op_t OP, typename V>
+NSTD_SIMD_INLINE void bit_apply(V& lhs, const V& rhs) {
+    if constexpr(OP == BIT_AND)      lhs &= rhs;
+    else if constexpr(OP == BIT_OR)  lhs |= rhs;
+    else if constexpr(OP == BIT_XOR) lhs ^= rhs;
+    else                             lhs &= ~rhs;
+}
+
+/// scalar reference versions
+struct scalar{
+    template<typename T>
+    static T sum(const T* data, size_t n_elems) {
+        T res = 0;
+        for(size_t i = 0; i < n_elems; i++) res += data[i];
+        return res;
+    }
+
+    template<typename T>
+    static T dot(const T* lhs, const T* rhs, size_t n_elems) {
+        T res = 0;
+        for(size_t i = 0; i < n_elems; i++) res += lhs[i] * rhs[i];
+        return res;
+    }
+
+    template<typename T>
+    static T min(const T* data, size_t n_elems) {
+        T res = data[0];
+        for(size_t i = 1; i < n_elems; i++) res = data[i] < res ? data[i] : res;
+        return res;
+    }
+
+    template<typename T>
+    static T max(const T* data, size_t n_elems) {
+        T res = data[0];
+        for(size_t i = 1; i < n_elems; i++) res = data[i] > res ? data[i] : res;
+        return res;
+    }
+
+    template<typename T>
+    static void add(const T* lhs, const T* rhs, T* out, size_t n_elems) {
+        for(size_t i = 0; i < n_elems; i++) out[i] = lhs[i] + rhs[i];
+    }
+
+    template<typename T>
+    static void mul(const T* lhs, const T* rhs, T* out, size_t n_elems) {
+        for(size_t i = 0; i < n_elems; i++) out[i] = lhs[i] * rhs[i];
+    }
+
+    template<typename T>
+    static void fma(const T* lhs, const T* rhs, const T* addend, T* out, size_t n_elems) {
+        for(size_t i = 0; i < n_elems; i++) {
+            if constexpr(std::is_floating_point_v<T>) out[i] = std::fma(lhs[i], rhs[i], addend[i]);
+            else                                      out[i] = lhs[i] * rhs[i] + addend[i];
+        }
+    }
+
+    template<typename T>
+    static size_t find_first_equal(const T* data, size_t n_elems, T key) {
+        for(size_t i = 0; i < n_elems; i++) {
+            if(data[i] == key) return i;
+        }
+        return n_elems;
+    }
+
+    template<typename T>
+    static size_t count_equal(const T* data, size_t n_elems, T key) {
+        size_t res = 0;
+        for(size_t i = 0; i < n_elems; i++) res += data[i] == key;
+        return res;
+    }
+
+    template<bit_op_t OP>
+    static void bit_words(const uint64_t* lhs, const uint64_t* rhs, uint64_t* out, size_t n_words) {
+        for(size_t i = 0; i < n_words; i++) {
+            uint64_t word = lhs[i];
+            bit_apply<OP>(word, rhs[i]);
+            out[i] = word;
+        }
+    }
+
+    static void bit_words_not(const uint64_t* data, uint64_t* out, size_t n_words) {
+        for(size_t i = 0; i < n_words; i++) out[i] = ~data[i];
+    }
+
+    template<bit_op_t OP>
+    static bool bit_words_any(const uint64_t* lhs, const uint64_t* rhs, size_t n_words) {
+        for(size_t i = 0; i < n_words; i++) {
+            uint64_t word = lhs[i];
+            bit_apply<OP>(word, rhs[i]);
+            if(word) return true;
+        }
+        return false;
+    }
+
+    static size_t bit_words_popcount(const uint64_t* data, size_t n_words) {
+        size_t res = 0;
+        for(size_t i = 0; i < n_words; i++) res += __builtin_popcountll(data[i]);
+        return res;
+    }
+
+    static size_t bit_words_find(const uint64_t* data, size_t n_words, uint64_t flip) {
+        for(size_t i = 0; i < n_words; i++) {
+            if(data[i] ^ flip) return i;
+        }
+        return n_words;
+    }
+};
+
+/// W-byte wide versions written with gcc vector extensions, the ISA comes from the target of the caller
+template<typename T, size_t W>
+struct lanes{
+    typedef T vec_t __attribute__((vector_size(W)));
+    typedef decltype(vec_t() == vec_t()) mask_t;
+
+    static const size_t N_LANES = W / sizeof(T);
+
+    static NSTD_SIMD_INLINE T sum(const T* data, size_t n_elems) {
+        vec_t acc0 = {}, acc1 = {}, cur0, cur1;
+        size_t i = 0;
+
+        for(; i + 2 * N_LANES <= n_elems; i += 2 * N_LANES) {
+            memcpy(&cur0, data + i, W);
+            memcpy(&cur1, data + i + N_LANES, W);
+            acc0 += cur0;
+            acc1 += cur1;
+        }
+        acc0 += acc1;
+
+        T res = 0;
+        for(size_t lane = 0; lane < N_LANES; lane++) res += acc0[lane];
+        for(; i < n_elems; i++) res += data[i];
+
+        return res;
+    }
+
+    static NSTD_SIMD_INLINE T dot(const T* lhs, const T* rhs, size_t n_elems) {
+        vec_t acc0 = {}, acc1 = {}, l0, l1, r0, r1;
+        size_t i = 0;
+
+        for(; i + 2 * N_LANES <= n_elems; i += 2 * N_LANES) {
+            memcpy(&l0, lhs + i, W);
+            memcpy(&l1, lhs + i + N_LANES, W);
+            memcpy(&r0, rhs + i, W);
+            memcpy(&r1, rhs + i + N_LANES, W);
+            acc0 += l0 * r0;
+            acc1 += l1 * r1;
+        }
+        acc0 += acc1;
+
+        T res = 0;
+        for(size_t lane = 0; lane < N_LANES; lane++) res += acc0[lane];
+        for(; i < n_elems; i++) res += lhs[i] * rhs[i];
+
+        return res;
+    }
+
+    template<bool IS_MIN>
+    static NSTD_SIMD_INLINE T extremum(const T* data, size_t n_elems) {
+        vec_t acc = vec_t{} + data[0], cur;
+        size_t i = 0;
+
+        for(; i + N_LANES <= n_elems; i += N_LANES) {
+            memcpy(&cur, data + i, W);
+            if constexpr(IS_MIN) acc = cur < acc ? cur : acc;
+            else                 acc = cur > acc ? cur : acc;
+        }
+
+        T res = acc[0];
+        for(size_t lane = 1; lane < N_LANES; lane++) {
+            if constexpr(IS_MIN) res = acc[lane] < res ? acc[lane] : res;
+            else                 res = acc[lane] > res ? acc[lane] : res;
+        }
+        for(; i < n_elems; i++) {
+            if constexpr(IS_MIN) res = data[i] < res ? data[i] : res;
+            else                 res = data[i] > res ? data[i] : res;
+        }
+
+        return res;
+    }
+
+    static NSTD_SIMD_INLINE void add(const T* lhs, const T* rhs, T* out, size_t n_elems) {
+        vec_t l, r;
+        size_t i = 0;
+
+        for(; i + N_LANES <= n_elems; i += N_LANES) {
+            memcpy(&l, lhs + i, W);
+            memcpy(&r, rhs + i, W);
+            l += r;
+            memcpy(out + i, &l, W);
+        }
+        for(; i < n_elems; i++) out[i] = lhs[i] + rhs[i];
+    }
+
+    static NSTD_SIMD_INLINE void mul(const T* lhs, const T* rhs, T* out, size_t n_elems) {
+        vec_t l, r;
+        size_t i = 0;
+
+        for(; i + N_LANES <= n_elems; i += N_LANES) {
+            memcpy(&l, lhs + i, W);
+            memcpy(&r, rhs + i, W);
+            l *= r;
+            memcpy(out + i, &l, W);
+        }
+        for(; i < n_elems; i++) out[i] = lhs[i] * rhs[i];
+    }
+
+    /// integer multiply-add, floating point versions need fused instructions of the exact ISA
+    static NSTD_SIMD_INLINE void fma(const T* lhs, const T* rhs, const T* addend, T* out, size_t n_elems) {
+        static_assert(std::is_integral_v<T>, "floating fma is implemented by the ISA kernels");
+        vec_t l, r, a;
+        size_t i = 0;
+
+        for(; i + N_LANES <= n_elems; i += N_LANES) {
+            memcpy(&l, lhs + i, W);
+            memcpy(&r, rhs + i, W);
+            memcpy(&a, addend + i, W);
+            l = l * r + a;
+            memcpy(out + i, &l, W);
+        }
+        for(; i < n_elems; i++) out[i] = lhs[i] * rhs[i] + addend[i];
+    }
+
+    static NSTD_SIMD_INLINE size_t find_first_equal(const T* data, size_t n_elems, T key) {
+        vec_t keys = vec_t{} + key, cur;
+        size_t i = 0;
+
+        for(; i + N_LANES <= n_elems; i += N_LANES) {
+            memcpy(&cur, data + i, W);
+            mask_t is_equal = cur == keys;
+
+            uint64_t words[W / 8], any = 0;
+            memcpy(words, &is_equal, W);
+            for(size_t n_word = 0; n_word < W / 8; n_word++) any |= words[n_word];
+
+            if(!any) continue;
+            for(size_t lane = 0; lane < N_LANES; lane++) {
+                if(is_equal[lane]) return i + lane;
+            }
+        }
+        for(; i < n_elems; i++) {
+            if(data[i] == key) return i;
+        }
+
+        return n_elems;
+    }
+
+    static NSTD_SIMD_INLINE size_t count_equal(const T* data, size_t n_elems, T key) {
+        // lanes of the mask are -1 for equal elements, lane counters are flushed before they could overflow
+        const size_t FLUSH_PERIOD = size_t(1) << 24;
+
+        vec_t keys = vec_t{} + key, cur;
+        size_t res = 0, i = 0;
+
+        while(i + N_LANES <= n_elems) {
+            mask_t counters = {};
+            size_t block_end = (n_elems - i) / N_LANES > FLUSH_PERIOD ? i + FLUSH_PERIOD * N_LANES : n_elems;
+
+            for(; i + N_LANES <= block_end; i += N_LANES) {
+                memcpy(&cur, data + i, W);
+                counters -= (cur == keys);
+            }
+            for(size_t lane = 0; lane < N_LANES; lane++) res += counters[lane];
+        }
+        for(; i < n_elems; i++) res += data[i] == key;
+
+        return res;
+    }
+
+    template<bit_op_t OP>
+    static NSTD_SIMD_INLINE void bit_words(const T* lhs, const T* rhs, T* out, size_t n_words) {
+        vec_t l0, l1, r0, r1;
+        size_t i = 0;
+
+        for(; i + 2 * N_LANES <= n_words; i += 2 * N_LANES) {
+            memcpy(&l0, lhs + i, W);
+            memcpy(&l1, lhs + i + N_LANES, W);
+            memcpy(&r0, rhs + i, W);
+            memcpy(&r1, rhs + i + N_LANES, W);
+            bit_apply<OP>(l0, r0);
+            bit_apply<OP>(l1, r1);
+            memcpy(out + i, &l0, W);
+            memcpy(out + i + N_LANES, &l1, W);
+        }
+        for(; i < n_words; i++) {
+            T word = lhs[i];
+            bit_apply<OP>(word, rhs[i]);
+            out[i] = word;
+        }
+    }
+
+    static NSTD_SIMD_INLINE void bit_words_not(const T* data, T* out, size_t n_words) {
+        vec_t cur;
+        size_t i = 0;
+
+        for(; i + N_LANES <= n_words; i += N_LANES) {
+            memcpy(&cur, data + i, W);
+            cur = ~cur;
+            memcpy(out + i, &cur, W);
+        }
+        for(; i < n_words; i++) out[i] = ~data[i];
+    }
+
+    /// results are or-ed over blocks of BLOCK words, the block is checked at once
+    template<bit_op_t OP>
+    static NSTD_SIMD_INLINE bool bit_words_any(const T* lhs, const T* rhs, size_t n_words) {
+        const size_t BLOCK = 8 * N_LANES;
+        vec_t acc, l, r;
+        size_t i = 0;
+
+        while(i + BLOCK <= n_words) {
+            acc = vec_t{};
+            for(size_t block_end = i + BLOCK; i < block_end; i += N_LANES) {
+                memcpy(&l, lhs + i, W);
+                memcpy(&r, rhs + i, W);
+                bit_apply<OP>(l, r);
+                acc |= l;
+            }
+
+            T any = 0;
+            for(size_t lane = 0; lane < N_LANES; lane++) any |= acc[lane];
+            if(any) return true;
+        }
+        for(; i < n_words; i++) {
+            T word = lhs[i];
+            bit_apply<OP>(word, rhs[i]);
+            if(word) return true;
+        }
+
+        return false;
+    }
+
+    /// popcnt on words, four counters keep the instructions independent
+    static NSTD_SIMD_INLINE size_t bit_words_popcount(const T* data, size_t n_words) {
+        size_t res0 = 0, res1 = 0, res2 = 0, res3 = 0;
+        size_t i = 0;
+
+        for(; i + 4 <= n_words; i += 4) {
+            res0 += __builtin_popcountll(data[i]);
+            res1 += __builtin_popcountll(data[i + 1]);
+            res2 += __builtin_popcountll(data[i + 2]);
+            res3 += __builtin_popcountll(data[i + 3]);
+        }
+        for(; i < n_words; i++) res0 += __builtin_popcountll(data[i]);
+
+        return res0 + res1 + res2 + res3;
+    }
+
+    /// blocks of 4 vectors, where all the words equal flip, are skipped by one test
+    static NSTD_SIMD_INLINE size_t bit_words_find(const T* data, size_t n_words, T flip) {
+        const size_t BLOCK = 4 * N_LANES;
+        vec_t flips = vec_t{} + flip, acc, cur;
+        size_t i = 0;
+
+        for(; i + BLOCK <= n_words; i += BLOCK) {
+            acc = vec_t{};
+            for(size_t n_vec = 0; n_vec < BLOCK; n_vec += N_LANES) {
+                memcpy(&cur, data + i + n_vec, W);
+                acc |= cur ^ flips;
+            }
+
+            T any = 0;
+            for(size_t lane = 0; lane < N_LANES; lane++) any |= acc[lane];
+            if(any) break;
+        }
+        for(; i < n_words; i++) {
+            if(data[i] ^ flip) return i;
+        }
+
+        return n_words;
+    }
+};
+
+template<isa_t ISA>
+struct kernels;
+
+template<>
+struct kernels<ISA_SCALAR> : scalar {};
+
+#define NSTD_SIMD_TARGET(isa) __attribute__((target(isa)))
+
+/// popcount of 256-bit blocks by 4-bit table lookups (pshufb), byte counts are summed by psadbw
+NSTD_SIMD_TARGET("avx2") NSTD_SIMD_INLINE size_t bit_words_popcount_avx2(const uint64_t* data, size_t n_words) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_nibbles = _mm256_set1_epi8(0x0F);
+
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for(; i + 4 <= n_words; i += 4) {
+        __m256i cur = _mm256_loadu_si256((const __m256i*)(data + i));
+        __m256i lo  = _mm256_shuffle_epi8(lookup, _mm256_and_si256(cur, low_nibbles));
+        __m256i hi  = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(cur, 4), low_nibbles));
+
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+    }
+
+    uint64_t lanes_acc[4];
+    _mm256_storeu_si256((__m256i*)lanes_acc, acc);
+
+    size_t res = lanes_acc[0] + lanes_acc[1] + lanes_acc[2] + lanes_acc[3];
+    for(; i < n_words; i++) res += __builtin_popcountll(data[i]);
+
+    return res;
+}
+
+template<>
+struct kernels<ISA_SSE42>{
+    template<typename T> NSTD_SIMD_TARGET("sse4.2") static T sum(const T* data, size_t n_elems)
+    { return lanes<T, 16>::sum(data, n_elems); }
+
+    template<typename T> NSTD_SIMD_TARGET("sse4.2") static T dot(const T* lhs, const T* rhs, size_t n_elems)
+    { return lanes<T, 16>::dot(lhs, rhs, n_elems); }
+
+    template<typename T> NSTD_SIMD_TARGET("sse4.2") static T min(const T* data, size_t n_elems)
+    { return lanes<T, 16>::template extremum<true>(data, n_elems); }
+
+    template<typename T> NSTD_SIMD_TARGET("sse4.2") static T max(const T* data, size_t n_elems)
+    { return lanes<T, 16>::template extremum<false>(data, n_elems); }
+
+    template<typename T> NSTD_SIMD_TARGET("sse4.2") static void add(const T* lhs, const T* rhs, T* out, size_t n_elems)
+    { lanes<T, 16>::add(lhs, rhs, out, n_elems); }
+
+    template<typename T> NSTD_SIMD_TARGET("sse4.2") static void mul(const T* lhs, const T* rhs, T* out, size_t n_elems)
+    { lanes<T, 16>::mul(lhs, rhs, out, n_elems); }
+
+    // SSE has no fused multiply-add, floating versions stay scalar to give the same results
+    template<typename T> NSTD_SIMD_TARGET("sse4.2") static void fma(const T* lhs, const T* rhs, const T* addend, T* out, size_t n_elems) {
+        if constexpr(std::is_integral_v<T>) lanes<T, 16>::fma(lhs, rhs, addend, out, n_elems);
+        else                                scalar::fma(lhs, rhs, addend, out, n_elems);
+    }
+
+    template<typename T> NSTD_SIMD_TARGET("sse4.2") static size_t find_first_equal(const T* data, size_t n_elems, T key)
+    { return lanes<T, 16>::find_first_equal(data, n_elems, key); }
+
+    template<typename T> NSTD_SIMD_TARGET("sse4.2") static size_t count_equal(const T* data, size_t n_elems, T key)
+    { return lanes<T, 16>::count_equal(data, n_elems, key); }
+
+    template<bit_op_t OP> NSTD_SIMD_TARGET("sse4.2") static void bit_words(const uint64_t* lhs, const uint64_t* rhs, uint64_t* out, size_t n_words)
+    { lanes<uint64_t, 16>::template bit_words<OP>(lhs, rhs, out, n_words); }
+
+    NSTD_SIMD_TARGET("sse4.2") static void bit_words_not(const uint64_t* data, uint64_t* out, size_t n_words)
+    { lanes<uint64_t, 16>::bit_words_not(data, out, n_words); }
+
+    template<bit_op_t OP> NSTD_SIMD_TARGET("sse4.2") static bool bit_words_any(const uint64_t* lhs, const uint64_t* rhs, size_t n_words)
+    { return lanes<uint64_t, 16>::template bit_words_any<OP>(lhs, rhs, n_words); }
+
+    NSTD_SIMD_TARGET("sse4.2") static size_t bit_words_popcount(const uint64_t* data, size_t n_words)
+    { return lanes<uint64_t, 16>::bit_words_popcount(data, n_words); }
+
+    NSTD_SIMD_TARGET("sse4.2") static size_t bit_words_find(const uint64_t* data, size_t n_words, uint64_t flip)
+    { return lanes<uint64_t, 16>::bit_words_find(data, n_words, flip); }
+};
+
+template<>
+struct kernels<ISA_AVX2>{
+    template<typename T> NSTD_SIMD_TARGET("avx2,fma") static T sum(const T* data, size_t n_elems)
+    { return lanes<T, 32>::sum(data, n_elems); }
+
+    template<typename T> NSTD_SIMD_TARGET("avx2,fma") static T dot(const T* lhs, const T* rhs, size_t n_elems)
+    { return lanes<T, 32>::dot(lhs, rhs, n_elems); }
+
+    template<typename T> NSTD_SIMD_TARGET("avx2,fma") static T min(const T* data, size_t n_elems)
+    { return lanes<T, 32>::template extremum<true>(data, n_elems); }
+
+    template<typename T> NSTD_SIMD_TARGET("avx2,fma") static T max(const T* data, size_t n_elems)
+    { return lanes<T, 32>::template extremum<false>(data, n_elems); }
+
+    template<typename T> NSTD_SIMD_TARGET("avx2,fma") static void add(const T* lhs, const T* rhs, T* out, size_t n_elems)
+    { lanes<T, 32>::add(lhs, rhs, out, n_elems); }
+
+    template<typename T> NSTD_SIMD_TARGET("avx2,fma") static void mul(const T* lhs, const T* rhs, T* out, size_t n_elems)
+    { lanes<T, 32>::mul(lhs, rhs, out, n_elems); }
+
+    template<typename T> NSTD_SIMD_TARGET("avx2,fma") static void fma(const T* lhs, const T* rhs, const T* addend, T* out, size_t n_elems) {
+        size_t i = 0;
+
+        if constexpr(std::is_same_v<T, float>) {
+            for(; i + 8 <= n_elems; i += 8) {
+                __m256 res = _mm256_fmadd_ps(_mm256_loadu_ps(lhs + i), _mm256_loadu_ps(rhs + i), _mm256_loadu_ps(addend + i));
+                _mm256_storeu_ps(out + i, res);
+            }
+        }
+        else if constexpr(std::is_same_v<T, double>) {
+            for(; i + 4 <= n_elems; i += 4) {
+                __m256d res = _mm256_fmadd_pd(_mm256_loadu_pd(lhs + i), _mm256_loadu_pd(rhs + i), _mm256_loadu_pd(addend + i));
+                _mm256_storeu_pd(out + i, res);
+            }
+        }
+        else {
+            lanes<T, 32>::fma(lhs, rhs, addend, out, n_elems);
+            return;
+        }
+
+        scalar::fma(lhs + i, rhs + i, addend + i, out + i, n_elems - i);
+    }
+
+    template<typename T> NSTD_SIMD_TARGET("avx2,fma") static size_t find_first_equal(const T* data, size_t n_elems, T key)
+    { return lanes<T, 32>::find_first_equal(data, n_elems, key); }
+
+    template<typename T> NSTD_SIMD_TARGET("avx2,fma") static size_t count_equal(const T* data, size_t n_elems, T key)
+    { return lanes<T, 32>::count_equal(data, n_elems, key); }
+
+    template<bit_op_t OP> NSTD_SIMD_TARGET("avx2,fma") static void bit_words(const uint64_t* lhs, const uint64_t* rhs, uint64_t* out, size_t n_words)
+    { lanes<uint64_t, 32>::template bit_words<OP>(lhs, rhs, out, n_words); }
+
+    NSTD_SIMD_TARGET("avx2,fma") static void bit_words_not(const uint64_t* data, uint64_t* out, size_t n_words)
+    { lanes<uint64_t, 32>::bit_words_not(data, out, n_words); }
+
+    template<bit_op_t OP> NSTD_SIMD_TARGET("avx2,fma") static bool bit_words_any(const uint64_t* lhs, const uint64_t* rhs, size_t n_words)
+    { return lanes<uint64_t, 32>::template bit_words_any<OP>(lhs, rhs, n_words); }
+
+    NSTD_SIMD_TARGET("avx2,fma") static size_t bit_words_popcount(const uint64_t* data, size_t n_words)
+    { return bit_words_popcount_avx2(data, n_words); }
+
+    NSTD_SIMD_TARGET("avx2,fma") static size_t bit_words_find(const uint64_t* data, size_t n_words, uint64_t flip)
+    { return lanes<uint64_t, 32>::bit_words_find(data, n_words, flip); }
+};
+
+template<>
+struct kernels<ISA_AVX512>{
+    template<typename T> NSTD_SIMD_TARGET("avx512f") static T sum(const T* data, size_t n_elems)
+    { return lanes<T, 64>::sum(data, n_elems); }
+
+    template<typename T> NSTD_SIMD_TARGET("avx512f") static T dot(const T* lhs, const T* rhs, size_t n_elems)
+    { return lanes<T, 64>::dot(lhs, rhs, n_elems); }
+
+    template<typename T> NSTD_SIMD_TARGET("avx512f") static T min(const T* data, size_t n_elems)
+    { return lanes<T, 64>::template extremum<true>(data, n_elems); }
+
+    template<typename T> NSTD_SIMD_TARGET("avx512f") static T max(const T* data, size_t n_elems)
+    { return lanes<T, 64>::template extremum<false>(data, n_elems); }
+
+    template<typename T> NSTD_SIMD_TARGET("avx512f") static void add(const T* lhs, const T* rhs, T* out, size_t n_elems)
+    { lanes<T, 64>::add(lhs, rhs, out, n_elems); }
+
+    template<typename T> NSTD_SIMD_TARGET("avx512f") static void mul(const T* lhs, const T* rhs, T* out, size_t n_elems)
+    { lanes<T, 64>::mul(lhs, rhs, out, n_elems); }
+
+    template<typename T> NSTD_SIMD_TARGET("avx512f") static void fma(const T* lhs, const T* rhs, const T* addend, T* out, size_t n_elems) {
+        size_t i = 0;
+
+        if constexpr(std::is_same_v<T, float>) {
+            for(; i + 16 <= n_elems; i += 16) {
+                __m512 res = _mm512_fmadd_ps(_mm512_loadu_ps(lhs + i), _mm512_loadu_ps(rhs + i), _mm512_loadu_ps(addend + i));
+                _mm512_storeu_ps(out + i, res);
+            }
+        }
+        else if constexpr(std::is_same_v<T, double>) {
+            for(; i + 8 <= n_elems; i += 8) {
+                __m512d res = _mm512_fmadd_pd(_mm512_loadu_pd(lhs + i), _mm512_loadu_pd(rhs + i), _mm512_loadu_pd(addend + i));
+                _mm512_storeu_pd(out + i, res);
+            }
+        }
+        else {
+            lanes<T, 64>::fma(lhs, rhs, addend, out, n_elems);
+            return;
+        }
+
+        scalar::fma(lhs + i, rhs + i, addend + i, out + i, n_elems - i);
+    }
+
+    template<typename T> NSTD_SIMD_TARGET("avx512f") static size_t find_first_equal(const T* data, size_t n_elems, T key)
+    { return lanes<T, 64>::find_first_equal(data, n_elems, key); }
+
+    template<typename T> NSTD_SIMD_TARGET("avx512f") static size_t count_equal(const T* data, size_t n_elems, T key)
+    { return lanes<T, 64>::count_equal(data, n_elems, key); }
+
+    template<bit_op_t OP> NSTD_SIMD_TARGET("avx512f") static void bit_words(const uint64_t* lhs, const uint64_t* rhs, uint64_t* out, size_t n_words)
+    { lanes<uint64_t, 64>::template bit_words<OP>(lhs, rhs, out, n_words); }
+
+    NSTD_SIMD_TARGET("avx512f") static void bit_words_not(const uint64_t* data, uint64_t* out, size_t n_words)
+    { lanes<uint64_t, 64>::bit_words_not(data, out, n_words); }
+
+    template<bit_op_t OP> NSTD_SIMD_TARGET("avx512f") static bool bit_words_any(const uint64_t* lhs, const uint64_t* rhs, size_t n_words)
+    { return lanes<uint64_t, 64>::template bit_words_any<OP>(lhs, rhs, n_words); }
+
+    // without the VPOPCNTDQ extension there is no 512-bit popcount, the AVX2 lookup is as fast
+    NSTD_SIMD_TARGET("avx512f") static size_t bit_words_popcount(const uint64_t* data, size_t n_words)
+    { return bit_words_popcount_avx2(data, n_words); }
+
+    NSTD_SIMD_TARGET("avx512f") static size_t bit_words_find(const uint64_t* data, size_t n_words, uint64_t flip)
+    { return lanes<uint64_t, 64>::bit_words_find(data, n_words, flip); }
+};
+
+#undef NSTD_SIMD_TARGET
+#undef NSTD_SIMD_INLINE
+
+/// calls func(kernels<isa>()) with the kernel set of isa
+template<class TFunc>
+auto dispatch(isa_t isa, TFunc func) {
+    switch(isa) {
+        case ISA_AVX512: return func(kernels<ISA_AVX512>());
+        case ISA_AVX2:   return func(kernels<ISA_AVX2>());
+        case ISA_SSE42:  return func(kernels<ISA_SSE42>());
+        default:         return func(kernels<ISA_SCALAR>());
+    }
+}
+
+}; // namespace detail
+
+// ------------------------------------ pointer interface ------------------------------------ //
+
+template<kernel_type T>
+T sum(const T* data, size_t n_elems, isa_t isa = best_isa())
+{ return detail::dispatch(isa, [&](auto kernel){ return kernel.sum(data, n_elems); }); }
+
+template<kernel_type T>
+T dot(const T* lhs, const T* rhs, size_t n_elems, isa_t isa = best_isa())
+{ return detail::dispatch(isa, [&](auto kernel){ return kernel.dot(lhs, rhs, n_elems); }); }
+
+/// n_elems must be positive
+template<kernel_type T>
+T min(const T* data, size_t n_elems, isa_t isa = best_isa())
+{ return detail::dispatch(isa, [&](auto kernel){ return kernel.min(data, n_elems); }); }
+
+/// n_elems must be positive
+template<kernel_type T>
+T max(const T* data, size_t n_elems, isa_t isa = best_isa())
+{ return detail::dispatch(isa, [&](auto kernel){ return kernel.max(data, n_elems); }); }
+
+template<kernel_type T>
+size_t find_first_equal(const T* data, size_t n_elems, T key, isa_t isa = best_isa())
+{ return detail::dispatch(isa, [&](auto kernel){ return kernel.find_first_equal(data, n_elems, key); }); }
+
+template<kernel_type T>
+size_t count_equal(const T* data, size_t n_elems, T key, isa_t isa = best_isa())
+{ return detail::dispatch(isa, [&](auto kernel){ return kernel.count_equal(data, n_elems, key); }); }
+
+/// index of the first minimal element, found by two vector passes
+template<kernel_type T>
+size_t argmin(const T* data, size_t n_elems, isa_t isa = best_isa())
+{ return find_first_equal(data, n_elems, min(data, n_elems, isa), isa); }
+
+template<kernel_type T>
+size_t argmax(const T* data, size_t n_elems, isa_t isa = best_isa())
+{ return find_first_equal(data, n_elems, max(data, n_elems, isa), isa); }
+
+template<kernel_type T>
+void add(const T* lhs, const T* rhs, T* out, size_t n_elems, isa_t isa = best_isa())
+{ detail::dispatch(isa, [&](auto kernel){ kernel.add(lhs, rhs, out, n_elems); }); }
+
+template<kernel_type T>
+void mul(const T* lhs, const T* rhs, T* out, size_t n_elems, isa_t isa = best_isa())
+{ detail::dispatch(isa, [&](auto kernel){ kernel.mul(lhs, rhs, out, n_elems); }); }
+
+/// out = lhs * rhs + addend, fused (single rounding) for floating types
+template<kernel_type T>
+void fma(const T* lhs, const T* rhs, const T* addend, T* out, size_t n_elems, isa_t isa = best_isa())
+{ detail::dispatch(isa, [&](auto kernel){ kernel.fma(lhs, rhs, addend, out, n_elems); }); }
+
+/// out[i] = lhs[i] OP rhs[i], out may be one of the operands
+template<bit_op_t OP>
+void bit_words(const uint64_t* lhs, const uint64_t* rhs, uint64_t* out, size_t n_words, isa_t isa = best_isa())
+{ detail::dispatch(isa, [&](auto kernel){ kernel.template bit_words<OP>(lhs, rhs, out, n_words); }); }
+
+inline void bit_words_not(const uint64_t* data, uint64_t* out, size_t n_words, isa_t isa = best_isa())
+{ detail::dispatch(isa, [&](auto kernel){ kernel.bit_words_not(data, out, n_words); }); }
+
+/// whether any lhs[i] OP rhs[i] is not zero, stops at the first such block
+template<bit_op_t OP>
+bool bit_words_any(const uint64_t* lhs, const uint64_t* rhs, size_t n_words, isa_t isa = best_isa())
+{ return detail::dispatch(isa, [&](auto kernel){ return kernel.template bit_words_any<OP>(lhs, rhs, n_words); }); }
+
+inline size_t bit_words_popcount(const uint64_t* data, size_t n_words, isa_t isa = best_isa())
+{ return detail::dispatch(isa, [&](auto kernel){ return kernel.bit_words_popcount(data, n_words); }); }
+
+/// index of the first word, which differs from flip (0 finds set bits, ~0 unset ones), n_words if there is none
+inline size_t bit_words_find(const uint64_t* data, size_t n_words, uint64_t flip, isa_t isa = best_isa())
+{ return detail::dispatch(isa, [&](auto kernel){ return kernel.bit_words_find(data, n_words, flip); }); }
+
+// ------------------------------------ vector interface ------------------------------------- //
+
+template<kernel_type T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+T sum(const vector<T, Alloc, CapacityPolicy, CheckPolicy>& vec)
+{ return sum(vec.data(), vec.size()); }
+
+template<kernel_type T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+T dot(const vector<T, Alloc, CapacityPolicy, CheckPolicy>& lhs, const vector<T, Alloc, CapacityPolicy, CheckPolicy>& rhs) {
+    if(lhs.size() != rhs.size())
+        throw std::invalid_argument("dot of vectors of different sizes");
+
+    return dot(lhs.data(), rhs.data(), lhs.size());
+}
+
+template<kernel_type T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+T min(const vector<T, Alloc, CapacityPolicy, CheckPolicy>& vec) {
+    if(vec.empty())
+        throw std::out_of_range("min of empty vector");
+
+    return min(vec.data(), vec.size());
+}
+
+template<kernel_type T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+T max(const vector<T, Alloc, CapacityPolicy, CheckPolicy>& vec) {
+    if(vec.empty())
+        throw std::out_of_range("max of empty vector");
+
+    return max(vec.data(), vec.size());
+}
+
+/// returns size() for empty vector
+template<kernel_type T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+size_t argmin(const vector<T, Alloc, CapacityPolicy, CheckPolicy>& vec)
+{ return vec.empty() ? 0 : argmin(vec.data(), vec.size()); }
+
+template<kernel_type T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+size_t argmax(const vector<T, Alloc, CapacityPolicy, CheckPolicy>& vec)
+{ return vec.empty() ? 0 : argmax(vec.data(), vec.size()); }
+
+/// returns size() if there is no key
+template<kernel_type T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+size_t find_first_equal(const vector<T, Alloc, CapacityPolicy, CheckPolicy>& vec, T key)
+{ return find_first_equal(vec.data(), vec.size(), key); }
+
+template<kernel_type T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+size_t count_equal(const vector<T, Alloc, CapacityPolicy, CheckPolicy>& vec, T key)
+{ return count_equal(vec.data(), vec.size(), key); }
+
+/// out is resized to the size of the operands
+template<kernel_type T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+void add(const vector<T, Alloc, CapacityPolicy, CheckPolicy>& lhs, const vector<T, Alloc, CapacityPolicy, CheckPolicy>& rhs,
+         vector<T, Alloc, CapacityPolicy, CheckPolicy>& out) {
+    if(lhs.size() != rhs.size())
+        throw std::invalid_argument("add of vectors of different sizes");
+
+    out.resize(lhs.size());
+    add(lhs.data(), rhs.data(), out.data(), lhs.size());
+}
+
+template<kernel_type T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+void mul(const vector<T, Alloc, CapacityPolicy, CheckPolicy>& lhs, const vector<T, Alloc, CapacityPolicy, CheckPolicy>& rhs,
+         vector<T, Alloc, CapacityPolicy, CheckPolicy>& out) {
+    if(lhs.size() != rhs.size())
+        throw std::invalid_argument("mul of vectors of different sizes");
+
+    out.resize(lhs.size());
+    mul(lhs.data(), rhs.data(), out.data(), lhs.size());
+}
+
+template<kernel_type T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+void fma(const vector<T, Alloc, CapacityPolicy, CheckPolicy>& lhs, const vector<T, Alloc, CapacityPolicy, CheckPolicy>& rhs,
+         const vector<T, Alloc, CapacityPolicy, CheckPolicy>& addend, vector<T, Alloc, CapacityPolicy, CheckPolicy>& out) {
+    if(lhs.size() != rhs.size() || lhs.size() != addend.size())
+        throw std::invalid_argument("fma of vectors of different sizes");
+
+    out.resize(lhs.size());
+    fma(lhs.data(), rhs.data(), addend.data(), out.data(), lhs.size());
+}
+
+}; // namespace simd
+}; // namespace nstd
+
+#endif // NSTD_SIMD_H
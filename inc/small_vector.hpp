@@ -0,0 +1,90 @@
+#ifndef NSTD_SMALL_VECTOR_H
+#define NSTD_SMALL_VECTOR_H
+
+#include "vector.hpp"
+#include "allocator.hpp"
+
+namespace nstd{
+
+/// vector, which keeps up to N elements inside the object and goes to the heap only past that.
+/// All the logic is inherited from nstd::vector over InlineAllocator, here only moves and swaps are
+/// specialized: heap blocks are stolen, inline elements are relocated
+template<typename T, size_t N>
+class small_vector : public vector<T, InlineBuffer<N>::template allocator>{
+    typedef vector<T, InlineBuffer<N>::template allocator> base;
+
+public:
+    using base::base;
+
+    small_vector() = default;
+    small_vector(const small_vector& other) = default;
+
+    small_vector(small_vector&& other):
+        base()
+    { steal(other); }
+
+    small_vector& operator=(const small_vector& other) {
+        base::operator=(other);
+        return *this;
+    }
+
+    small_vector& operator=(small_vector&& other) {
+        if(this == &other) return *this;
+
+        this->clear();
+        steal(other);
+
+        return *this;
+    }
+
+    void swap(small_vector& other) {
+        if(!is_inline() && !other.is_inline()) {
+            std::swap(this->data_,     other.data_);
+            std::swap(this->size_,     other.size_);
+            std::swap(this->capacity_, other.capacity_);
+            return;
+        }
+
+        small_vector tmp(nstd::move(other));
+        other = nstd::move(*this);
+        *this = nstd::move(tmp);
+    }
+
+    /// true while elements are kept in the object itself
+    bool is_inline() const
+    { return this->owns(this->data_); }
+
+    static constexpr size_t inline_capacity()
+    { return N; }
+
+private:
+    // this must be empty
+    void steal(small_vector& other) {
+        if(other.is_inline()) {
+            this->reserve(other.size_);
+
+            uninitialized_relocate_n(other.data_, other.size_, this->data_);
+            this->size_  = other.size_;
+            other.size_  = 0;
+            return;
+        }
+
+        this->release_storage();
+
+        this->data_     = other.data_;
+        this->size_     = other.size_;
+        this->capacity_ = other.capacity_;
+
+        // other's inline block is free, because its elements were on the heap
+        other.data_ = other.allocate_storage(0);
+        other.size_ = 0;
+    }
+};
+
+template<typename T, size_t N>
+void swap(small_vector<T, N>& lhs, small_vector<T, N>& rhs)
+{ lhs.swap(rhs); }
+
+}; // namespace nstd
+
+#endif // NSTD_SMALL_VECTOR_H
@@ -0,0 +1,552 @@
+#ifndef NSTD_SOA_VECTOR_H
+#define NSTD_SOA_VECTOR_H
+
+#include <cstdlib>
+#include <stdexcept>
+#include <stdint.h>
+#include <tuple>
+#include <utility>
+#include <memory>
+#include "construction.hpp"
+#include "iterator.hpp"
+#include "move_semantics.hpp"
+#include "capacity_policy.hpp"
+#include "check_policy.hpp"
+
+// Structure of arrays: every field of the record lives in its own contiguous column, so a scan of one field
+// reads only that field. Columns are cut from one allocation and start at cache line (SIMD) boundaries.
+// Element access goes through soa_reference, a proxy like bit_reference, which holds pointers to the fields.
+
+namespace nstd{
+
+/// proxy to one record, behaves as a tuple of references: get<I>(), structured bindings,
+/// assignment from and conversion to std::tuple<Ts...>
+template<bool IS_CONST, typename... Ts>
+struct soa_reference{
+    typedef std::tuple<Ts...>                                                     value_type;
+    typedef std::tuple<std::conditional_t<IS_CONST, const Ts*, Ts*>...>           pointers_t;
+
+    soa_reference(const pointers_t& fields):
+        fields_(fields){}
+
+    soa_reference(const soa_reference& other) = default;
+
+    /// writes through, as bit_reference does
+    soa_reference& operator=(const soa_reference& other) {
+        assign(other.values(), std::index_sequence_for<Ts...>());
+        return *this;
+    }
+
+    soa_reference& operator=(const value_type& val) {
+        assign(val, std::index_sequence_for<Ts...>());
+        return *this;
+    }
+
+    soa_reference& operator=(value_type&& val) {
+        assign(nstd::move(val), std::index_sequence_for<Ts...>());
+        return *this;
+    }
+
+    /// copies the fields out
+    operator value_type() const
+    { return values(); }
+
+    template<size_t I>
+    auto& get() const
+    { return *std::get<I>(fields_); }
+
+    bool operator==(const value_type& val) const
+    { return values() == val; }
+
+    friend void swap(soa_reference lhs, soa_reference rhs) {
+        static_assert(!IS_CONST, "const records could not be swapped");
+        swap_fields(lhs, rhs, std::index_sequence_for<Ts...>());
+    }
+
+    pointers_t fields_;
+
+private:
+    value_type values() const
+    { return values(std::index_sequence_for<Ts...>()); }
+
+    template<size_t... Is>
+    value_type values(std::index_sequence<Is...>) const
+    { return value_type(*std::get<Is>(fields_)...); }
+
+    template<typename Tuple, size_t... Is>
+    void assign(Tuple&& val, std::index_sequence<Is...>) {
+        static_assert(!IS_CONST, "const records could not be assigned");
+        ((*std::get<Is>(fields_) = std::get<Is>(nstd::forward<Tuple>(val))), ...);
+    }
+
+    template<size_t... Is>
+    static void swap_fields(soa_reference& lhs, soa_reference& rhs, std::index_sequence<Is...>) {
+        using std::swap;
+        (swap(*std::get<Is>(lhs.fields_), *std::get<Is>(rhs.fields_)), ...);
+    }
+};
+
+/// found by ADL, so generic code could use get<I>(x) for both records and std::tuple (with using std::get)
+template<size_t I, bool IS_CONST, typename... Ts>
+auto& get(const soa_reference<IS_CONST, Ts...>& ref)
+{ return ref.template get<I>(); }
+
+/// zip iterator over the columns: keeps the column pointers and the index
+template<bool IS_CONST, typename... Ts>
+class soa_iterator
+{
+public:
+    typedef std::random_access_iterator_tag                          iterator_category;
+    typedef std::tuple<Ts...>                                        value_type;
+    typedef ptrdiff_t                                                difference_type;
+    typedef soa_reference<IS_CONST, Ts...>                           reference;
+    typedef void                                                     pointer;
+
+    typedef typename reference::pointers_t                           pointers_t;
+
+public:
+    soa_iterator():
+        columns_(),
+        n_elem_(0){}
+
+    soa_iterator(const pointers_t& columns, size_t n_elem):
+        columns_(columns),
+        n_elem_(n_elem){}
+
+    soa_iterator(const soa_iterator& other) = default;
+
+    soa_iterator& operator =(const soa_iterator& other) = default;
+
+    ~soa_iterator() = default;
+
+    reference operator *() const
+    { return at(n_elem_, std::index_sequence_for<Ts...>()); }
+
+    reference operator [](difference_type idx) const
+    { return at(n_elem_ + idx, std::index_sequence_for<Ts...>()); }
+
+    soa_iterator& operator ++() {
+        n_elem_++;
+        return *this;
+    }
+
+    soa_iterator operator ++(int)
+    { return soa_iterator(columns_, n_elem_++); }
+
+    soa_iterator& operator --() {
+        n_elem_--;
+        return *this;
+    }
+
+    soa_iterator operator --(int)
+    { return soa_iterator(columns_, n_elem_--); }
+
+    soa_iterator  operator +(difference_type offset) const
+    { return soa_iterator(columns_, n_elem_ + offset); }
+
+    soa_iterator& operator +=(difference_type offset){
+        n_elem_ += offset;
+        return *this;
+    }
+
+    soa_iterator operator -(difference_type offset) const
+    { return soa_iterator(columns_, n_elem_ - offset); }
+
+    soa_iterator& operator -=(difference_type offset) {
+        n_elem_ -= offset;
+        return *this;
+    }
+
+    difference_type operator -(const soa_iterator& other) const
+    { return difference_type(n_elem_ - other.n_elem_); }
+
+    bool operator ==(const soa_iterator& other) const
+    { return n_elem_ == other.n_elem_; }
+
+    bool operator !=(const soa_iterator& other) const
+    { return n_elem_ != other.n_elem_; }
+
+    bool operator >(const soa_iterator& other) const
+    { return n_elem_ > other.n_elem_; }
+
+    bool operator >=(const soa_iterator& other) const
+    { return n_elem_ >= other.n_elem_; }
+
+    bool operator <(const soa_iterator& other) const
+    { return n_elem_ < other.n_elem_; }
+
+    bool operator <=(const soa_iterator& other) const
+    { return n_elem_ <= other.n_elem_; }
+
+private:
+    template<size_t... Is>
+    reference at(size_t n_elem, std::index_sequence<Is...>) const
+    { return reference(pointers_t((std::get<Is>(columns_) + n_elem)...)); }
+
+private:
+    pointers_t columns_;
+    size_t     n_elem_;
+};
+
+/// storage unit of soa_vector, columns start at its boundaries
+struct alignas(64) soa_line{
+    uint8_t bytes_[64];
+};
+
+/// columns grow together: one allocation of CapacityPolicy capacity for all of them.
+/// Alloc is rebound to soa_line, so the block is cache line aligned
+template<template <typename> class Alloc, class CapacityPolicy, class CheckPolicy, typename... Ts>
+class basic_soa_vector : public Alloc<soa_line>{
+    static_assert(sizeof...(Ts) > 0, "soa_vector needs at least one column");
+
+public:
+    typedef std::tuple<Ts...>                       value_type;
+    typedef soa_reference<false, Ts...>             reference;
+    typedef soa_reference<true, Ts...>              const_reference;
+    typedef soa_iterator<false, Ts...>              iterator;
+    typedef soa_iterator<true, Ts...>               const_iterator;
+
+    static const size_t N_COLUMNS  = sizeof...(Ts);
+    static const size_t LINE_SIZE  = sizeof(soa_line);
+
+    template<size_t I>
+    using column_type = std::tuple_element_t<I, value_type>;
+
+public:
+    basic_soa_vector():
+        lines_(NULL),
+        n_lines_(0),
+        columns_(),
+        size_(0),
+        capacity_(0){}
+
+    explicit basic_soa_vector(size_t size, const value_type& def_val = value_type()):
+        basic_soa_vector()
+    {
+        reserve(size);
+        for(size_t i = 0; i < size; i++) push_back(def_val);
+    }
+
+    basic_soa_vector(const basic_soa_vector& other):
+        Alloc<soa_line>(other),
+        lines_(NULL),
+        n_lines_(0),
+        columns_(),
+        size_(0),
+        capacity_(0)
+    {
+        reallocate(other.size_);
+
+        try {
+            copy_columns(other, std::index_sequence_for<Ts...>());
+        } catch(...) {
+            release_storage();
+            throw;
+        }
+        size_ = other.size_;
+    }
+
+    basic_soa_vector(basic_soa_vector&& other):
+        basic_soa_vector()
+    { swap(other); }
+
+    ~basic_soa_vector() {
+        clear();
+        release_storage();
+    }
+
+    basic_soa_vector& operator=(const basic_soa_vector& other) {
+        basic_soa_vector tmp = other;
+        swap(tmp);
+
+        return *this;
+    }
+
+    basic_soa_vector& operator=(basic_soa_vector&& other) {
+        basic_soa_vector tmp(nstd::move(other));
+        swap(tmp);
+
+        return *this;
+    }
+
+    /// stateful allocators aren't supported: blocks are swapped with their owners
+    void swap(basic_soa_vector& other) {
+        std::swap(lines_,    other.lines_);
+        std::swap(n_lines_,  other.n_lines_);
+        std::swap(columns_,  other.columns_);
+        std::swap(size_,     other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    /// contiguous column of the I-th field, aligned to the cache line
+    template<size_t I>
+    column_type<I>* data()
+    { return std::get<I>(columns_); }
+
+    template<size_t I>
+    const column_type<I>* data() const
+    { return std::get<I>(columns_); }
+
+    reference at(size_t n_elem) {
+        if(n_elem >= size_)
+            throw std::out_of_range("out of range");
+
+        return begin()[n_elem];
+    }
+
+    const_reference at(size_t n_elem) const {
+        if(n_elem >= size_)
+            throw std::out_of_range("out of range");
+
+        return cbegin()[n_elem];
+    }
+
+    reference operator[](size_t n_elem) {
+        CheckPolicy::check(n_elem, size_);
+        return begin()[n_elem];
+    }
+
+    const_reference operator[](size_t n_elem) const {
+        CheckPolicy::check(n_elem, size_);
+        return cbegin()[n_elem];
+    }
+
+    reference front()
+    { return (*this)[0]; }
+
+    const_reference front() const
+    { return (*this)[0]; }
+
+    reference back()
+    { return (*this)[size_ - 1]; }
+
+    const_reference back() const
+    { return (*this)[size_ - 1]; }
+
+    bool empty() const
+    { return size_ == 0; }
+
+    size_t size() const
+    { return size_; }
+
+    size_t capacity() const
+    { return capacity_; }
+
+    void reserve(size_t capacity) {
+        if(capacity > capacity_) reallocate(capacity);
+    }
+
+    void shrink_to_fit() {
+        if(size_ < capacity_) reallocate(size_);
+    }
+
+    void clear() {
+        destroy_columns(std::index_sequence_for<Ts...>());
+        size_ = 0;
+    }
+
+    void push_back(const value_type& val)
+    { emplace_from_tuple(val, std::index_sequence_for<Ts...>()); }
+
+    void push_back(value_type&& val)
+    { emplace_from_tuple(nstd::move(val), std::index_sequence_for<Ts...>()); }
+
+    /// one argument per column, every field is constructed from its argument in place
+    template<typename... Args>
+        requires (sizeof...(Args) == sizeof...(Ts))
+    reference emplace_back(Args&&... args) {
+        if(size_ < capacity_) {
+            construct_fields(columns_, size_, std::index_sequence_for<Ts...>(), nstd::forward<Args>(args)...);
+        }
+        else {
+            // new element is built before the relocation, so args referring to the old columns stay valid
+            size_t new_capacity   = CapacityPolicy::grow(capacity_, size_ + 1, ELEM_SIZE);
+            size_t new_n_lines    = total_lines(new_capacity);
+            soa_line* new_lines   = this->allocate(new_n_lines);
+            columns_t new_columns = layout(new_lines, new_capacity, std::index_sequence_for<Ts...>());
+
+            try {
+                construct_fields(new_columns, size_, std::index_sequence_for<Ts...>(), nstd::forward<Args>(args)...);
+            } catch(...) {
+                this->deallocate(new_lines, new_n_lines);
+                throw;
+            }
+
+            install_storage(new_lines, new_n_lines, new_columns, new_capacity);
+        }
+        size_++;
+
+        return back();
+    }
+
+    value_type pop_back() {
+        if(size_ == 0)
+            throw std::out_of_range("pop_back on empty vector");
+
+        value_type val = move_out(size_ - 1, std::index_sequence_for<Ts...>());
+        size_--;
+        destroy_fields(size_, std::index_sequence_for<Ts...>());
+
+        size_t new_capacity = CapacityPolicy::shrink(capacity_, size_);
+        if(new_capacity < capacity_) reallocate(new_capacity);
+
+        return val;
+    }
+
+    void resize(size_t n_elems, const value_type& val = value_type()) {
+        while(size_ > n_elems) {
+            size_--;
+            destroy_fields(size_, std::index_sequence_for<Ts...>());
+        }
+
+        reserve(n_elems);
+        while(size_ < n_elems) push_back(val);
+    }
+
+    iterator begin()
+    { return iterator(columns_, 0); }
+
+    const_iterator begin() const
+    { return cbegin(); }
+
+    const_iterator cbegin() const
+    { return const_iterator(const_columns(std::index_sequence_for<Ts...>()), 0); }
+
+    iterator end()
+    { return iterator(columns_, size_); }
+
+    const_iterator end() const
+    { return cend(); }
+
+    const_iterator cend() const
+    { return const_iterator(const_columns(std::index_sequence_for<Ts...>()), size_); }
+
+private:
+    static const size_t ELEM_SIZE = (sizeof(Ts) + ...);
+
+    typedef std::tuple<Ts*...> columns_t;
+
+    static size_t column_lines(size_t n_bytes)
+    { return (n_bytes + LINE_SIZE - 1) / LINE_SIZE; }
+
+    template<size_t... Is>
+    typename const_iterator::pointers_t const_columns(std::index_sequence<Is...>) const
+    { return typename const_iterator::pointers_t(std::get<Is>(columns_)...); }
+
+    /// every column takes the whole number of lines
+    template<size_t... Is>
+    static columns_t layout(soa_line* lines, size_t capacity, std::index_sequence<Is...>) {
+        columns_t columns;
+        size_t n_line = 0;
+
+        ((std::get<Is>(columns) = reinterpret_cast<column_type<Is>*>(lines + n_line),
+          n_line += column_lines(capacity * sizeof(column_type<Is>))), ...);
+
+        return columns;
+    }
+
+    static size_t total_lines(size_t capacity)
+    { return (column_lines(capacity * sizeof(Ts)) + ...); }
+
+    void reallocate(size_t new_capacity) {
+        if(new_capacity < size_) new_capacity = size_;
+
+        size_t new_n_lines    = new_capacity ? total_lines(new_capacity) : 0;
+        soa_line* new_lines   = new_n_lines ? this->allocate(new_n_lines) : NULL;
+        columns_t new_columns = layout(new_lines, new_capacity, std::index_sequence_for<Ts...>());
+
+        install_storage(new_lines, new_n_lines, new_columns, new_capacity);
+    }
+
+    /// relocates the elements into the new block and frees the old one
+    void install_storage(soa_line* new_lines, size_t new_n_lines, columns_t& new_columns, size_t new_capacity) {
+        relocate_columns(new_columns, std::index_sequence_for<Ts...>());
+        release_storage();
+
+        lines_    = new_lines;
+        n_lines_  = new_n_lines;
+        columns_  = new_columns;
+        capacity_ = new_capacity;
+    }
+
+    void release_storage() {
+        if(lines_) this->deallocate(lines_, n_lines_);
+
+        lines_    = NULL;
+        n_lines_  = 0;
+        columns_  = columns_t();
+        capacity_ = 0;
+    }
+
+    template<size_t... Is>
+    void relocate_columns(columns_t& to, std::index_sequence<Is...>)
+    { (uninitialized_relocate_n(std::get<Is>(columns_), size_, std::get<Is>(to)), ...); }
+
+    template<size_t... Is>
+    void copy_columns(const basic_soa_vector& other, std::index_sequence<Is...>) {
+        size_t n_copied = 0;
+
+        // columns are copied one by one, already copied ones are destroyed if the next throws
+        try {
+            ((uninitialized_copy_n(std::get<Is>(other.columns_), other.size_, std::get<Is>(columns_)), n_copied++), ...);
+        } catch(...) {
+            ((Is < n_copied ? (void)destroy_n(std::get<Is>(columns_), other.size_) : void()), ...);
+            throw;
+        }
+    }
+
+    template<size_t... Is>
+    void destroy_columns(std::index_sequence<Is...>)
+    { (destroy_n(std::get<Is>(columns_), size_), ...); }
+
+    template<size_t... Is>
+    void destroy_fields(size_t n_elem, std::index_sequence<Is...>)
+    { (destroy_n(std::get<Is>(columns_) + n_elem, 1), ...); }
+
+    template<size_t... Is>
+    value_type move_out(size_t n_elem, std::index_sequence<Is...>)
+    { return value_type(nstd::move(std::get<Is>(columns_)[n_elem])...); }
+
+    template<typename Tuple, size_t... Is>
+    void emplace_from_tuple(Tuple&& val, std::index_sequence<Is...>)
+    { emplace_back(std::get<Is>(nstd::forward<Tuple>(val))...); }
+
+    template<size_t... Is, typename... Args>
+    static void construct_fields(columns_t& columns, size_t n_elem, std::index_sequence<Is...>, Args&&... args) {
+        size_t n_constructed = 0;
+
+        try {
+            ((new (std::get<Is>(columns) + n_elem) column_type<Is>(nstd::forward<Args>(args)), n_constructed++), ...);
+        } catch(...) {
+            ((Is < n_constructed ? (void)destroy_n(std::get<Is>(columns) + n_elem, 1) : void()), ...);
+            throw;
+        }
+    }
+
+private:
+    soa_line*  lines_;
+    size_t     n_lines_;
+    columns_t  columns_;
+    size_t     size_;
+    size_t     capacity_;
+};
+
+template<typename... Ts>
+using soa_vector = basic_soa_vector<std::allocator, default_capacity_policy, default_check_policy, Ts...>;
+
+template<template <typename> class Alloc, class CapacityPolicy, class CheckPolicy, typename... Ts>
+void swap(basic_soa_vector<Alloc, CapacityPolicy, CheckPolicy, Ts...>& lhs, basic_soa_vector<Alloc, CapacityPolicy, CheckPolicy, Ts...>& rhs)
+{ lhs.swap(rhs); }
+
+}; // namespace nstd
+
+template<bool IS_CONST, typename... Ts>
+struct std::tuple_size<nstd::soa_reference<IS_CONST, Ts...>> : std::integral_constant<size_t, sizeof...(Ts)> {};
+
+template<size_t I, bool IS_CONST, typename... Ts>
+struct std::tuple_element<I, nstd::soa_reference<IS_CONST, Ts...>> {
+    typedef std::conditional_t<IS_CONST, const std::tuple_element_t<I, std::tuple<Ts...>>,
+                                         std::tuple_element_t<I, std::tuple<Ts...>>>& type;
+};
+
+#endif // NSTD_SOA_VECTOR_H
@@ -0,0 +1,211 @@
+#ifndef NSTD_THREAD_POOL_H
+#define NSTD_THREAD_POOL_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <exception>
+#include <chrono>
+#include "function.hpp"
+#include "vector.hpp"
+
+namespace nstd{
+
+/// work-stealing pool: every worker has its own deque, takes tasks from its back (LIFO, cache-warm)
+/// and steals from the front of the others when empty. Threads waiting for tasks help to run them,
+/// so fork-join inside tasks doesn't deadlock
+class thread_pool{
+public:
+    typedef function<void ()> task_t;
+
+public:
+    explicit thread_pool(size_t n_threads = std::thread::hardware_concurrency()):
+        queues_(),
+        threads_(),
+        stop_(false),
+        n_pending_(0),
+        next_queue_(0)
+    {
+        if(n_threads == 0) n_threads = 1;
+
+        for(size_t i = 0; i < n_threads; i++) {
+            queues_.emplace_back(new worker_queue);
+        }
+        for(size_t i = 0; i < n_threads; i++) {
+            threads_.emplace_back([this, i]{ worker_loop(i); });
+        }
+    }
+
+    thread_pool(const thread_pool& other) = delete;
+    thread_pool& operator=(const thread_pool& other) = delete;
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stop_ = true;
+        }
+        sleep_cv_.notify_all();
+
+        for(size_t i = 0; i < threads_.size(); i++) {
+            threads_[i].join();
+        }
+    }
+
+    size_t size() const
+    { return threads_.size(); }
+
+    /// tasks submitted from a worker go to its own deque, others are spread round-robin
+    void submit(task_t task) {
+        size_t n_queue = (current_pool_ == this) ? worker_index_ : next_queue_++ % queues_.size();
+
+        {
+            std::lock_guard<std::mutex> lock(queues_[n_queue]->mutex_);
+            queues_[n_queue]->tasks_.push_back(nstd::move(task));
+        }
+        n_pending_++;
+
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+        }
+        sleep_cv_.notify_one();
+    }
+
+    /// runs one queued task in the calling thread, returns false if there was nothing to run
+    bool run_pending_task() {
+        if(n_pending_ == 0) return false;
+
+        task_t task;
+        size_t n_own = (current_pool_ == this) ? worker_index_ : next_queue_ % queues_.size();
+
+        if(!pop_back(n_own, task)) {
+            bool is_stolen = false;
+            for(size_t i = 1; i < queues_.size() && !is_stolen; i++) {
+                is_stolen = pop_front((n_own + i) % queues_.size(), task);
+            }
+            if(!is_stolen) return false;
+        }
+
+        n_pending_--;
+        task();
+
+        return true;
+    }
+
+    /// pool shared by the parallel algorithms by default
+    static thread_pool& global() {
+        static thread_pool pool;
+        return pool;
+    }
+
+private:
+    struct worker_queue{
+        std::mutex          mutex_;
+        std::deque<task_t>  tasks_;
+    };
+
+    bool pop_back(size_t n_queue, task_t& task) {
+        std::lock_guard<std::mutex> lock(queues_[n_queue]->mutex_);
+        if(queues_[n_queue]->tasks_.empty()) return false;
+
+        task = nstd::move(queues_[n_queue]->tasks_.back());
+        queues_[n_queue]->tasks_.pop_back();
+        return true;
+    }
+
+    bool pop_front(size_t n_queue, task_t& task) {
+        std::lock_guard<std::mutex> lock(queues_[n_queue]->mutex_);
+        if(queues_[n_queue]->tasks_.empty()) return false;
+
+        task = nstd::move(queues_[n_queue]->tasks_.front());
+        queues_[n_queue]->tasks_.pop_front();
+        return true;
+    }
+
+    void worker_loop(size_t index) {
+        current_pool_ = this;
+        worker_index_ = index;
+
+        while(!stop_) {
+            if(run_pending_task()) continue;
+
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            sleep_cv_.wait_for(lock, std::chrono::milliseconds(10), [this]{ return stop_ || n_pending_ > 0; });
+        }
+    }
+
+private:
+    vector<std::unique_ptr<worker_queue>> queues_;
+    vector<std::thread>                   threads_;
+
+    std::atomic<bool>    stop_;
+    std::atomic<size_t>  n_pending_;
+    std::atomic<size_t>  next_queue_;
+
+    std::mutex               sleep_mutex_;
+    std::condition_variable  sleep_cv_;
+
+    static inline thread_local thread_pool* current_pool_ = NULL;
+    static inline thread_local size_t       worker_index_ = 0;
+};
+
+/// fork-join helper: run() spawns tasks, wait() helps the pool until all of them are done
+/// and rethrows the first exception thrown by them
+class task_group{
+public:
+    explicit task_group(thread_pool& pool):
+        pool_(pool),
+        n_running_(0),
+        exception_(){}
+
+    task_group(const task_group& other) = delete;
+    task_group& operator=(const task_group& other) = delete;
+
+    ~task_group()
+    { wait_all(); }
+
+    template<class TFunc>
+    void run(TFunc func) {
+        n_running_++;
+
+        pool_.submit([this, func]() {
+            try {
+                func();
+            } catch(...) {
+                std::lock_guard<std::mutex> lock(exception_mutex_);
+                if(!exception_) exception_ = std::current_exception();
+            }
+            n_running_--;
+        });
+    }
+
+    void wait() {
+        wait_all();
+
+        if(exception_) {
+            std::exception_ptr exception = exception_;
+            exception_ = std::exception_ptr();
+            std::rethrow_exception(exception);
+        }
+    }
+
+private:
+    void wait_all() {
+        while(n_running_ != 0) {
+            if(!pool_.run_pending_task()) std::this_thread::yield();
+        }
+    }
+
+private:
+    thread_pool&         pool_;
+    std::atomic<size_t>  n_running_;
+
+    std::mutex           exception_mutex_;
+    std::exception_ptr   exception_;
+};
+
+}; // namespace nstd
+
+#endif // NSTD_THREAD_POOL_H
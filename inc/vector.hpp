@@ -5,22 +5,31 @@
 #include <string>
 #include <stdexcept>
 #include <stdint.h>
+#include <assert.h>
 #include "construction.hpp"
 #include "iterator.hpp"
 #include "move_semantics.hpp"
 #include "allocator.hpp"
+#include "capacity_policy.hpp"
+#include "check_policy.hpp"
 #include <concepts>
+#include <algorithm>
+#include <memory>
+#include <array>
 
 //? Base class to bit reference (for reference at())
 //? #if _cplusplus > 2020L
 
-const size_t DEF_CAPACITY    = 1 << 4;
-const size_t GROWTH_FACTOR   = 1 << 1;
-const size_t DECREASE_FACTOR = 1 << 3;
-
 namespace nstd{
-    
-template<typename T, template <typename> class Alloc = std::allocator>
+
+/// tag for constructors, which default-initialize elements: trivial types are left uninitialized
+struct default_init_t { explicit default_init_t() = default; };
+inline constexpr default_init_t default_init{};
+
+/// CapacityPolicy decides how storage grows and when pop_back gives it back, see capacity_policy.hpp
+/// CheckPolicy decides how operator[], front() and back() are checked, see check_policy.hpp
+template<typename T, template <typename> class Alloc = std::allocator, class CapacityPolicy = default_capacity_policy,
+         class CheckPolicy = default_check_policy>
 class vector : public Alloc<T>{
 public:
     typedef ptlike_iterator<T*>                                     iterator;
@@ -28,6 +37,7 @@ public:
     typedef reverse_ra_iterator_default<ptlike_iterator<T*>>        reverse_iterator;
     typedef reverse_ra_iterator_default<ptlike_iterator<const T*>>  const_reverse_iterator;
 
+    typedef T                                                       value_type;
     typedef typename ptlike_iterator<T*>::reference                 reference;
     typedef typename ptlike_iterator<const T*>::reference           const_reference;
 
@@ -35,9 +45,13 @@ public:
 
     constexpr vector();
     constexpr explicit vector(size_t size, const T& def_val = T());
+    constexpr vector(size_t size, default_init_t);
     constexpr vector(const vector& other);
     constexpr vector(vector&& other);
 
+    template<legacy_input_iterator ItFrom>
+    constexpr vector(ItFrom start, ItFrom last);
+
     constexpr ~vector();
 
     constexpr vector& operator=(const vector& other);
@@ -45,6 +59,9 @@ public:
 
     constexpr void assign(size_t n_elems, const T& val);
 
+    template<legacy_input_iterator ItFrom>
+    constexpr void assign(ItFrom start, ItFrom last);
+
     // TODO: remove copypaste
     // TODO: static_cast???
 
@@ -79,28 +96,52 @@ public:
     constexpr iterator erase(iterator pos);
     constexpr iterator erase(iterator start, iterator last);
 
+    /// removes elements, for which pred is true, in one stable pass, returns the number of removed ones.
+    /// Runs of trivially relocatable survivors are moved by memmove
+    template<typename Pred>
+    constexpr size_t erase_if(Pred pred);
+
     // TODO: remove copypaste
 
     constexpr iterator insert(iterator pos, const T& val);
     constexpr iterator insert(iterator pos, T&& val);
     constexpr iterator insert(iterator pos, size_t count, const T& val) ;
 
-    // TODO:
-    //template<class ItFrom>
-    //constexpr iterator        insert(iterator pos, ItFrom start, ItFrom last);
-    
-    // TODO: emplace
+    /// forward ranges are measured first, so at most one reallocation and one tail move are done
+    template<legacy_input_iterator ItFrom>
+    constexpr iterator insert(iterator pos, ItFrom start, ItFrom last);
+
+    template<typename Range>
+    constexpr void append_range(Range&& range);
+
+    /// constructs element in place before pos, args may refer to elements of the vector
+    template<typename... Args>
+    constexpr iterator emplace(iterator pos, Args&&... args);
 
     constexpr void push_back(const T& val);
     constexpr void push_back(T&& val);
-    // TODO: emplace_back
+
+    /// constructs element in place at the end, args may refer to elements of the vector
+    template<typename... Args>
+    constexpr reference emplace_back(Args&&... args);
 
     constexpr T pop_back();
 
     constexpr void resize(size_t n_elems);
     constexpr void resize(size_t n_elems, const T& val);
 
-    // TODO: constexpr void            swap(vector<T>& other);
+    /// as resize(), but new elements are default-initialized, so buffers of trivial types are not written
+    /// before they are filled (e.g. by read() or recv())
+    constexpr void resize_default_init(size_t n_elems);
+
+    /// gives fill_fn(T* place, size_t n_elems) the raw storage after the last element and commits what was filled:
+    /// fill_fn returns the number of elements it has constructed from the start of place, or nothing if all of them,
+    /// the latter only for trivial types. Trivial types may be simply written. If fill_fn throws, size is unchanged.
+    /// A count above n_elems would be past the capacity, so it throws std::out_of_range whatever the CheckPolicy is
+    template<typename FillFn>
+    constexpr size_t append_uninitialized(size_t n_elems, FillFn&& fill_fn);
+
+    constexpr void swap(vector& other);
 
     constexpr iterator begin();
     constexpr const_iterator cbegin() const;
@@ -112,392 +153,822 @@ public:
     constexpr reverse_iterator rend();
     constexpr const_reverse_iterator crend() const;
 
-private:
+protected:
     T*        data_;
     size_t    size_;
     size_t    capacity_;
 
-private:
-    void increase_capacity(size_t low_limit);
-    void reduce_capacity();
+    // blocks of stateful allocators (stack, pool, inline buffers) can't change their owner
+    static constexpr bool IS_ALLOC_ALWAYS_EQUAL = std::allocator_traits<Alloc<T>>::is_always_equal::value;
+
+protected:
+    constexpr size_t good_capacity(size_t n_elems) const;
+    constexpr T*   allocate_storage(size_t n_elems);
+    constexpr void release_storage();
+
+    constexpr size_t grown_capacity(size_t low_limit) const;
+    constexpr void increase_capacity(size_t low_limit);
+    constexpr void reduce_capacity();
+    constexpr void reallocate(size_t new_capacity);
+    constexpr bool try_expand_storage(size_t new_capacity);
 };
 
-template<typename T, template <typename> class Alloc>
-constexpr vector<T, Alloc>::vector():
-    data_(this->allocate(DEF_CAPACITY)),
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr vector<T, Alloc, CapacityPolicy, CheckPolicy>::vector():
+    data_(NULL),
     size_(0),
-    capacity_(DEF_CAPACITY)
-{}
+    capacity_(0)
+{
+    // heap is touched only on the first insertion, allocators with inline storage give it right away
+    data_ = allocate_storage(0);
+}
 
-template<typename T, template <typename> class Alloc>
-constexpr vector<T, Alloc>::vector(size_t size, const T& def_val):
-    data_(this->allocate(size)),
-    size_(size),
-    capacity_(size)
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr vector<T, Alloc, CapacityPolicy, CheckPolicy>::vector(size_t size, const T& def_val):
+    data_(NULL),
+    size_(0),
+    capacity_(0)
 {
-    set_mem<T>(data_, 0, size, def_val);
+    data_ = allocate_storage(size);
+
+    try {
+        uninitialized_fill_n(data_, size, def_val);
+    } catch(...) {
+        release_storage();
+        throw;
+    }
+    size_ = size;
 }
 
-template<typename T, template <typename> class Alloc>
-constexpr vector<T, Alloc>::vector(const vector<T, Alloc>& other):
-    data_(this->allocate(other.size_)),
-    size_(other.size_),
-    capacity_(other.size_)
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr vector<T, Alloc, CapacityPolicy, CheckPolicy>::vector(size_t size, default_init_t):
+    data_(NULL),
+    size_(0),
+    capacity_(0)
+{
+    data_ = allocate_storage(size);
+
+    try {
+        uninitialized_default_construct_n(data_, size);
+    } catch(...) {
+        release_storage();
+        throw;
+    }
+    size_ = size;
+}
+
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr vector<T, Alloc, CapacityPolicy, CheckPolicy>::vector(const vector<T, Alloc, CapacityPolicy, CheckPolicy>& other):
+    Alloc<T>(other),
+    data_(NULL),
+    size_(0),
+    capacity_(0)
 {   
-    set_mem<T>(data_, 0, other.data_, 0, other.size_);
+    data_ = allocate_storage(other.size_);
+
+    try {
+        uninitialized_copy_n(other.data_, other.size_, data_);
+    } catch(...) {
+        release_storage();
+        throw;
+    }
+    size_ = other.size_;
 }
 
-// TODO: allocator copy issues
-template<typename T, template <typename> class Alloc>
-constexpr vector<T, Alloc>::vector(vector<T, Alloc>&& other):
-    data_(other.data_),
-    size_(other.size_),
-    capacity_(other.capacity_)
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr vector<T, Alloc, CapacityPolicy, CheckPolicy>::vector(vector<T, Alloc, CapacityPolicy, CheckPolicy>&& other):
+    data_(NULL),
+    size_(0),
+    capacity_(0)
 {
-    other.data_ = NULL;
-    other.size_ = other.capacity_ = 0;
+    if constexpr(IS_ALLOC_ALWAYS_EQUAL) {
+        data_     = other.data_;
+        size_     = other.size_;
+        capacity_ = other.capacity_;
+
+        other.data_ = NULL;
+        other.size_ = other.capacity_ = 0;
+    }
+    else {
+        // block belongs to the other's allocator, so elements are relocated one by one
+        data_ = allocate_storage(other.size_);
+
+        uninitialized_relocate_n(other.data_, other.size_, data_);
+        size_       = other.size_;
+        other.size_ = 0;
+    }
 }
 
-template<typename T, template <typename> class Alloc>
-constexpr vector<T, Alloc>::~vector() {
-    clear_mem<T>(data_, 0, size_);
-    this->deallocate(data_, capacity_);
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+template<legacy_input_iterator ItFrom>
+constexpr vector<T, Alloc, CapacityPolicy, CheckPolicy>::vector(ItFrom start, ItFrom last):
+    data_(NULL),
+    size_(0),
+    capacity_(0)
+{
+    if constexpr(legacy_forward_iterator<ItFrom>) {
+        size_t n_elems = std::distance(start, last);
+
+        data_ = allocate_storage(n_elems);
+
+        try {
+            uninitialized_copy_iter_n(start, n_elems, data_);
+        } catch(...) {
+            release_storage();
+            throw;
+        }
+        size_ = n_elems;
+    }
+    else {
+        data_ = allocate_storage(0);
+
+        try {
+            for(; start != last; ++start) {
+                emplace_back(*start);
+            }
+        } catch(...) {
+            destroy_n(data_, size_);
+            release_storage();
+            throw;
+        }
+    }
+}
+
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr vector<T, Alloc, CapacityPolicy, CheckPolicy>::~vector() {
+    destroy_n(data_, size_);
+    release_storage();
     size_ = 0;
-    capacity_ = 0;
 }
 
-template<typename T, template <typename> class Alloc>
-constexpr vector<T, Alloc>& vector<T, Alloc>::operator=(const vector<T, Alloc>& other){
-    vector<T, Alloc> tmp = other;
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr vector<T, Alloc, CapacityPolicy, CheckPolicy>& vector<T, Alloc, CapacityPolicy, CheckPolicy>::operator=(const vector<T, Alloc, CapacityPolicy, CheckPolicy>& other){
+    vector<T, Alloc, CapacityPolicy, CheckPolicy> tmp = other;
     *this = nstd::move(tmp);
     
     return *this;
 }
 
-template<typename T, template <typename> class Alloc>
-constexpr vector<T, Alloc>&  vector<T, Alloc>::operator=(vector<T, Alloc>&& other){
-    //? is ok
-    data_ = other.data_;
-    size_ = other.size_;
-    capacity_ = other.capacity_;
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr vector<T, Alloc, CapacityPolicy, CheckPolicy>&  vector<T, Alloc, CapacityPolicy, CheckPolicy>::operator=(vector<T, Alloc, CapacityPolicy, CheckPolicy>&& other){
+    if(this == &other) return *this;
+
+    if constexpr(IS_ALLOC_ALWAYS_EQUAL) {
+        vector<T, Alloc, CapacityPolicy, CheckPolicy> tmp(nstd::move(other));
+        swap(tmp);
+    }
+    else {
+        clear();
+        reserve(other.size_);
+
+        uninitialized_relocate_n(other.data_, other.size_, data_);
+        size_       = other.size_;
+        other.size_ = 0;
+    }
 
     return *this;
 }
 
-template<typename T, template <typename> class Alloc>
-constexpr void vector<T, Alloc>::assign(size_t n_elems, const T& val) {
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr void vector<T, Alloc, CapacityPolicy, CheckPolicy>::swap(vector<T, Alloc, CapacityPolicy, CheckPolicy>& other) {
+    if constexpr(IS_ALLOC_ALWAYS_EQUAL) {
+        std::swap(data_,     other.data_);
+        std::swap(size_,     other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+    else {
+        vector<T, Alloc, CapacityPolicy, CheckPolicy> tmp(nstd::move(other));
+        other = nstd::move(*this);
+        *this = nstd::move(tmp);
+    }
+}
+
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr void vector<T, Alloc, CapacityPolicy, CheckPolicy>::assign(size_t n_elems, const T& val) {
+    clear();
     reserve(n_elems);
 
-    set_mem<T>(data_, 0, n_elems, val);
+    uninitialized_fill_n(data_, n_elems, val);
+    size_ = n_elems;
+}
+
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+template<legacy_input_iterator ItFrom>
+constexpr void vector<T, Alloc, CapacityPolicy, CheckPolicy>::assign(ItFrom start, ItFrom last) {
+    clear();
+
+    if constexpr(legacy_forward_iterator<ItFrom>) {
+        size_t n_elems = std::distance(start, last);
+        reserve(n_elems);
+
+        uninitialized_copy_iter_n(start, n_elems, data_);
+        size_ = n_elems;
+    }
+    else {
+        for(; start != last; ++start) {
+            emplace_back(*start);
+        }
+    }
 }
 
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::reference vector<T, Alloc>::at(size_t n_elem){
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::reference vector<T, Alloc, CapacityPolicy, CheckPolicy>::at(size_t n_elem){
     if(n_elem >= size_)
         throw std::out_of_range("out of range");
 
     return data()[n_elem];
 }
 
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::const_reference vector<T, Alloc>::at(size_t n_elem) const {
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::const_reference vector<T, Alloc, CapacityPolicy, CheckPolicy>::at(size_t n_elem) const {
     if(n_elem >= size_)
-        throw std::out_of_range("index %lu for vector %p out of range", n_elem, this);
+        throw std::out_of_range("out of range");
 
     return data()[n_elem];
 }
 
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::reference vector<T, Alloc>::operator[](size_t n_elem)
-{ return at(n_elem); }
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::reference vector<T, Alloc, CapacityPolicy, CheckPolicy>::operator[](size_t n_elem) {
+    CheckPolicy::check(n_elem, size_);
+    return data_[n_elem];
+}
 
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::const_reference vector<T, Alloc>::operator[](size_t n_elem) const
-{ return at(n_elem); }
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::const_reference vector<T, Alloc, CapacityPolicy, CheckPolicy>::operator[](size_t n_elem) const {
+    CheckPolicy::check(n_elem, size_);
+    return data_[n_elem];
+}
 
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::reference vector<T, Alloc>::front()
-{ return at(0); }
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::reference vector<T, Alloc, CapacityPolicy, CheckPolicy>::front() {
+    CheckPolicy::check(0, size_);
+    return data_[0];
+}
 
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::const_reference vector<T, Alloc>::front() const
-{ return at(0); }
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::const_reference vector<T, Alloc, CapacityPolicy, CheckPolicy>::front() const {
+    CheckPolicy::check(0, size_);
+    return data_[0];
+}
 
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::reference vector<T, Alloc>::back()
-{ return at(size_ - 1); }
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::reference vector<T, Alloc, CapacityPolicy, CheckPolicy>::back() {
+    CheckPolicy::check(size_ - 1, size_);
+    return data_[size_ - 1];
+}
 
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::const_reference vector<T, Alloc>::back() const
-{ return at(size_ - 1); }
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::const_reference vector<T, Alloc, CapacityPolicy, CheckPolicy>::back() const {
+    CheckPolicy::check(size_ - 1, size_);
+    return data_[size_ - 1];
+}
 
-template<typename T, template <typename> class Alloc>
-constexpr T* vector<T, Alloc>::data()
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr T* vector<T, Alloc, CapacityPolicy, CheckPolicy>::data()
 { return (data_); }
 
-template<typename T, template <typename> class Alloc>
-constexpr const T* vector<T, Alloc>::data() const
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr const T* vector<T, Alloc, CapacityPolicy, CheckPolicy>::data() const
 { return (data_); } //? reinterpret_cast?? }
 
-template<typename T, template <typename> class Alloc>
-constexpr bool vector<T, Alloc>::empty() const
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr bool vector<T, Alloc, CapacityPolicy, CheckPolicy>::empty() const
 { return size_ == 0; }
 
-template<typename T, template <typename> class Alloc>
-constexpr size_t vector<T, Alloc>::size() const
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr size_t vector<T, Alloc, CapacityPolicy, CheckPolicy>::size() const
 { return size_; }
 
 // constexpr size_t          max_size() const; ? how to implement
-template<typename T, template <typename> class Alloc>
-constexpr void vector<T, Alloc>::reserve(size_t capacity) {
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr void vector<T, Alloc, CapacityPolicy, CheckPolicy>::reserve(size_t capacity) {
     if(capacity <= capacity_) return;
 
-    if(capacity_ == 0) {
-        //?
-        data_ = this->allocate(capacity);
-    }
-
-    increase_capacity(capacity);
-    capacity_ = capacity;
+    reallocate(capacity);
 }
 
-template<typename T, template <typename> class Alloc>
-constexpr size_t vector<T, Alloc>::capacity() const
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr size_t vector<T, Alloc, CapacityPolicy, CheckPolicy>::capacity() const
 { return capacity_; }
 
-template<typename T, template <typename> class Alloc>
-constexpr void vector<T, Alloc>::shrink_to_fit() {
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr void vector<T, Alloc, CapacityPolicy, CheckPolicy>::shrink_to_fit() {
     if(capacity_ == size_) return;
 
     // TODO: fix ))
     // not cringe
     // modify by adding allocator shrink to fit method for searching free block
-    vector<T, Alloc> tmp = *this;
-    clear_mem<T>(data_, 0, size_);
-    deallocate(data_, capacity_);
-    *this = nstd::move(tmp);
-    tmp.data_ = NULL;
+    reallocate(size_);
 }
 
-template<typename T, template <typename> class Alloc>
-constexpr void vector<T, Alloc>::clear() {
-    clear_mem<T>(data_, 0, size_);
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr void vector<T, Alloc, CapacityPolicy, CheckPolicy>::clear() {
+    destroy_n(data_, size_);
     size_ = 0;
 }
 
-template<typename T, template <typename> class Alloc>
-constexpr void vector<T, Alloc>::push_back(const T& val) {
-    if(capacity_ == 0) {
-        reserve(1);
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr void vector<T, Alloc, CapacityPolicy, CheckPolicy>::push_back(const T& val)
+{ emplace_back(val); }
+
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr void vector<T, Alloc, CapacityPolicy, CheckPolicy>::push_back(T&& val)
+{ emplace_back(nstd::move(val)); }
+
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+template<typename... Args>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::reference vector<T, Alloc, CapacityPolicy, CheckPolicy>::emplace_back(Args&&... args) {
+    // storage doesn't move when expanded in place, so args stay valid
+    if(size_ < capacity_ || try_expand_storage(grown_capacity(size_ + 1))) {
+        std::construct_at(data_ + size_, nstd::forward<Args>(args)...);
+        return data_[size_++];
     }
-    if(capacity_ == size_) {
-        increase_capacity(capacity_ + 1);
+
+    // new element is built before the relocation, so args referring to the old storage stay valid
+    size_t new_capacity = grown_capacity(size_ + 1);
+    T* new_data = this->allocate(new_capacity);
+
+    try {
+        std::construct_at(new_data + size_, nstd::forward<Args>(args)...);
+    } catch(...) {
+        this->deallocate(new_data, new_capacity);
+        throw;
     }
 
-    *(data_ + (size_++)) = val;
+    uninitialized_relocate_n(data_, size_, new_data);
+    release_storage();
+
+    data_     = new_data;
+    capacity_ = new_capacity;
+
+    return data_[size_++];
 }
 
-template<typename T, template <typename> class Alloc>
-constexpr void vector<T, Alloc>::push_back(T&& val) {
-    if(capacity_ == 0) {
-        reserve(1);
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+template<typename... Args>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::iterator vector<T, Alloc, CapacityPolicy, CheckPolicy>::emplace(typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::iterator pos, Args&&... args) {
+    size_t n_pos = pos - begin();
+
+    if(n_pos == size_) {
+        emplace_back(nstd::forward<Args>(args)...);
+        return begin() + n_pos;
     }
-    if(capacity_ == size_) {
-        increase_capacity(capacity_ + 1);
+
+    if(size_ < capacity_ || try_expand_storage(grown_capacity(size_ + 1))) {
+        // args could refer to the tail, which is going to be shifted
+        T tmp(nstd::forward<Args>(args)...);
+
+        uninitialized_relocate_n(data_ + n_pos, size_ - n_pos, data_ + n_pos + 1);
+        std::construct_at(data_ + n_pos, nstd::move(tmp));
+        size_++;
+
+        return begin() + n_pos;
     }
 
-    *(data_ + (size_++)) = nstd::move(val);
+    size_t new_capacity = grown_capacity(size_ + 1);
+    T* new_data = this->allocate(new_capacity);
+
+    try {
+        std::construct_at(new_data + n_pos, nstd::forward<Args>(args)...);
+    } catch(...) {
+        this->deallocate(new_data, new_capacity);
+        throw;
+    }
+
+    uninitialized_relocate_n(data_, n_pos, new_data);
+    uninitialized_relocate_n(data_ + n_pos, size_ - n_pos, new_data + n_pos + 1);
+    release_storage();
+
+    data_     = new_data;
+    capacity_ = new_capacity;
+    size_++;
+
+    return begin() + n_pos;
 }
-// TODO: emplace_back
 
-template<typename T, template <typename> class Alloc>
-constexpr T vector<T, Alloc>::pop_back(){
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr T vector<T, Alloc, CapacityPolicy, CheckPolicy>::pop_back(){
     if(size_ == 0)
-        throw std::out_of_range("pop_back on empty vector %p", this);
+        throw std::out_of_range("pop_back on empty vector");
 
-    T val = data()[size_ - 1];
-    data_[--size_].~T();
+    T val = nstd::move(data_[size_ - 1]);
+    size_--;
+    std::destroy_at(data_ + size_);
 
-    if((size_ - 1) * DECREASE_FACTOR >= capacity_ ) {
-        reduce_capacity();
-    }
+    reduce_capacity();
 
     return val;
 }
 
-template<typename T, template <typename> class Alloc>
-constexpr void vector<T, Alloc>::resize(size_t n_elems) {
-    reserve(n_elems);
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr void vector<T, Alloc, CapacityPolicy, CheckPolicy>::resize(size_t n_elems) {
+    // grows as push_back does, so resize(size() + 1) in a loop is amortized
+    if(n_elems > capacity_) increase_capacity(n_elems);
 
     if(size_ > n_elems) {
-        clear_mem<T>(data_, n_elems, size_ - n_elems);
+        destroy_n(data_ + n_elems, size_ - n_elems);
     }
     else if(size_ < n_elems) {
-        set_mem<T>(data_, size_, n_elems - size_);
+        uninitialized_value_construct_n(data_ + size_, n_elems - size_);
     }
     size_ = n_elems;
 }
 
-template<typename T, template <typename> class Alloc>
-constexpr void vector<T, Alloc>::resize(size_t n_elems, const T& val) {
-    reserve(n_elems);
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr void vector<T, Alloc, CapacityPolicy, CheckPolicy>::resize(size_t n_elems, const T& val) {
+    if(n_elems > capacity_) increase_capacity(n_elems);
 
     if(size_ > n_elems) {
-        clear_mem<T>(data_, n_elems, size_ - n_elems);
+        destroy_n(data_ + n_elems, size_ - n_elems);
     }
     else if(size_ < n_elems) {
-        set_mem<T>(data_, size_, n_elems - size_, val);
+        uninitialized_fill_n(data_ + size_, n_elems - size_, val);
     }
 
     size_ = n_elems;
 }
 
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr void vector<T, Alloc, CapacityPolicy, CheckPolicy>::resize_default_init(size_t n_elems) {
+    if(n_elems > capacity_) increase_capacity(n_elems);
+
+    if(size_ > n_elems) {
+        destroy_n(data_ + n_elems, size_ - n_elems);
+    }
+    else if(size_ < n_elems) {
+        uninitialized_default_construct_n(data_ + size_, n_elems - size_);
+    }
+    size_ = n_elems;
+}
+
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+template<typename FillFn>
+constexpr size_t vector<T, Alloc, CapacityPolicy, CheckPolicy>::append_uninitialized(size_t n_elems, FillFn&& fill_fn) {
+    // storage grows as with push_back, so repeated appends of small chunks are amortized
+    if(size_ + n_elems > capacity_) {
+        increase_capacity(size_ + n_elems);
+    }
+
+    size_t n_filled = n_elems;
+    if constexpr(std::is_void_v<std::invoke_result_t<FillFn&, T*, size_t>>) {
+        // nothing tells which elements were constructed, so all of them must be valid when just written
+        static_assert(std::is_trivially_default_constructible_v<T>,
+                      "append_uninitialized: fill_fn must return the number of constructed elements for non-trivial types");
+        fill_fn(data_ + size_, n_elems);
+    }
+    else {
+        n_filled = fill_fn(data_ + size_, n_elems);
+        // once per call, so it stays even with check_never
+        if(n_filled > n_elems)
+            throw std::out_of_range("append_uninitialized: fill_fn returned more than n_elems");
+    }
+
+    size_ += n_filled;
+    return n_filled;
+}
+
 //? why in standart const_iterator used and what would be realization of erase with it :|
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::iterator vector<T, Alloc>::erase(typename vector<T, Alloc>::iterator pos)
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::iterator vector<T, Alloc, CapacityPolicy, CheckPolicy>::erase(typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::iterator pos)
 { return erase(pos, pos + 1); }
 
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::iterator vector<T, Alloc>::erase(typename vector<T, Alloc>::iterator start, typename vector<T, Alloc>::iterator last){
-    auto offset = last - start;
-    
-    for(typename vector<T, Alloc>::iterator it = start; it + offset != end(); it++) {
-        *(it) = nstd::move(*(it + offset));
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::iterator vector<T, Alloc, CapacityPolicy, CheckPolicy>::erase(typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::iterator start, typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::iterator last){
+    size_t n_first  = start - begin();
+    size_t n_erased = last - start;
+    if(n_erased == 0) return start;
+
+    if constexpr(is_trivially_relocatable_v<T>) {
+        if(!std::is_constant_evaluated()) {
+            destroy_n(data_ + n_first, n_erased);
+            uninitialized_relocate_n(data_ + n_first + n_erased, size_ - n_first - n_erased, data_ + n_first);
+            size_ -= n_erased;
+
+            return start;
+        }
     }
 
-    clear_mem<T>(data_, size_ - offset, offset);
-    size_--;
+    std::move(data_ + n_first + n_erased, data_ + size_, data_ + n_first);
+
+    destroy_n(data_ + size_ - n_erased, n_erased);
+    size_ -= n_erased;
 
     return start;
 }
 
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+template<typename Pred>
+constexpr size_t vector<T, Alloc, CapacityPolicy, CheckPolicy>::erase_if(Pred pred) {
+    T* last = data_ + size_;
+
+    if constexpr(is_trivially_relocatable_v<T>) {
+        if(!std::is_constant_evaluated()) {
+            // [data_, kept) are the survivors, [kept, run) is raw memory, [run, cur) are the checked survivors
+            // waiting for the move, [cur, last) is not checked yet. pred is called once per element
+            T* kept = data_;
+            T* run  = data_;
+            T* cur  = data_;
+
+            try {
+                for(; cur != last; cur++) {
+                    if(!pred(*cur)) continue;
+
+                    uninitialized_relocate_n(run, cur - run, kept);
+                    kept += cur - run;
+
+                    std::destroy_at(cur);
+                    run = cur + 1;
+                }
+            } catch(...) {
+                // pred has thrown, the waiting survivors and the unchecked tail close the gap
+                uninitialized_relocate_n(run, last - run, kept);
+                size_ = (kept - data_) + (last - run);
+                throw;
+            }
+
+            uninitialized_relocate_n(run, last - run, kept);
+            kept += last - run;
+
+            size_t n_removed = last - kept;
+            size_ = kept - data_;
+
+            return n_removed;
+        }
+    }
+
+    T* kept = std::remove_if(data_, last, pred);
+    size_t n_removed = last - kept;
+
+    destroy_n(kept, n_removed);
+    size_ -= n_removed;
+
+    return n_removed;
+}
+
 // TODO: remove copypaste
 
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::iterator vector<T, Alloc>::insert(typename vector<T, Alloc>::iterator pos, const T& val)
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::iterator vector<T, Alloc, CapacityPolicy, CheckPolicy>::insert(typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::iterator pos, const T& val)
 { return insert(pos, 1, val); }
 
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::iterator vector<T, Alloc>::insert(typename vector<T, Alloc>::iterator pos, T&& val) {
-    reserve(size_ + 1);
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::iterator vector<T, Alloc, CapacityPolicy, CheckPolicy>::insert(typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::iterator pos, T&& val)
+{ return emplace(pos, nstd::move(val)); }
 
-    set_mem<T>(data_, size_, 1);
-    size_++;
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::iterator vector<T, Alloc, CapacityPolicy, CheckPolicy>::insert(typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::iterator pos, size_t count, const T& val) {
+    if(count == 0) return pos;
 
-    reverse_iterator last_pos = make_default_ra_reverse_iterator(pos);
+    size_t n_pos = pos - begin();
 
-    for(reverse_iterator it = rbegin(); it != last_pos; it++) {
-        *(it) = nstd::move(*(it + 1));
+    // val could be the element of this vector, which is going to be moved
+    if(is_in_range(&val, data_, size_)) {
+        T tmp = val;
+        return insert(pos, count, tmp);
     }
 
-    *pos = nstd::move(val);
+    if(size_ + count <= capacity_ || try_expand_storage(grown_capacity(size_ + count))) {
+        uninitialized_relocate_n(data_ + n_pos, size_ - n_pos, data_ + n_pos + count);
 
-    return pos;
-}
-
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::iterator vector<T, Alloc>::insert(typename vector<T, Alloc>::iterator pos, size_t count, const T& val) {
-    if(count == 0) return pos;
-
-    reserve(size_ + count);
+        try {
+            uninitialized_fill_n(data_ + n_pos, count, val);
+        } catch(...) {
+            uninitialized_relocate_n(data_ + n_pos + count, size_ - n_pos, data_ + n_pos);
+            throw;
+        }
+    }
+    else {
+        // copies are built into the new block first, so every element is relocated once
+        size_t new_capacity = grown_capacity(size_ + count);
+        T* new_data = this->allocate(new_capacity);
+
+        try {
+            uninitialized_fill_n(new_data + n_pos, count, val);
+        } catch(...) {
+            this->deallocate(new_data, new_capacity);
+            throw;
+        }
+
+        uninitialized_relocate_n(data_, n_pos, new_data);
+        uninitialized_relocate_n(data_ + n_pos, size_ - n_pos, new_data + n_pos + count);
+        release_storage();
+
+        data_     = new_data;
+        capacity_ = new_capacity;
+    }
 
-    //!
-    // TODO: extra default ctrs calls
-    set_mem<T>(data_, size_, count);
     size_ += count;
+    return begin() + n_pos;
+}
+
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+template<legacy_input_iterator ItFrom>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::iterator vector<T, Alloc, CapacityPolicy, CheckPolicy>::insert(typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::iterator pos, ItFrom start, ItFrom last) {
+    size_t n_pos = pos - begin();
 
-    reverse_iterator last_pos = make_default_ra_reverse_iterator(pos);
+    if constexpr(!legacy_forward_iterator<ItFrom>) {
+        // length is unknown, so elements are appended and rotated into place
+        size_t old_size = size_;
+        for(; start != last; ++start) {
+            emplace_back(*start);
+        }
 
-    for(reverse_iterator it = rbegin(); it + count != pos; it++) {
-        *(it) = nstd::move(*(it + count));
+        std::rotate(data_ + n_pos, data_ + old_size, data_ + size_);
+        return begin() + n_pos;
+    }
+    else {
+        size_t count = std::distance(start, last);
+        if(count == 0) return begin() + n_pos;
+
+        if(size_ + count <= capacity_ || try_expand_storage(grown_capacity(size_ + count))) {
+            uninitialized_relocate_n(data_ + n_pos, size_ - n_pos, data_ + n_pos + count);
+
+            try {
+                uninitialized_copy_iter_n(start, count, data_ + n_pos);
+            } catch(...) {
+                uninitialized_relocate_n(data_ + n_pos + count, size_ - n_pos, data_ + n_pos);
+                throw;
+            }
+        }
+        else {
+            size_t new_capacity = grown_capacity(size_ + count);
+            T* new_data = this->allocate(new_capacity);
+
+            try {
+                uninitialized_copy_iter_n(start, count, new_data + n_pos);
+            } catch(...) {
+                this->deallocate(new_data, new_capacity);
+                throw;
+            }
+
+            uninitialized_relocate_n(data_, n_pos, new_data);
+            uninitialized_relocate_n(data_ + n_pos, size_ - n_pos, new_data + n_pos + count);
+            release_storage();
+
+            data_     = new_data;
+            capacity_ = new_capacity;
+        }
+
+        size_ += count;
+        return begin() + n_pos;
     }
+}
 
-    for(iterator it = pos; it != pos + count; it++){
-        *(it) = val;
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+template<typename Range>
+constexpr void vector<T, Alloc, CapacityPolicy, CheckPolicy>::append_range(Range&& range)
+{ insert(end(), std::begin(range), std::end(range)); }
+
+/// as std::erase_if, single pass
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy, typename Pred>
+constexpr size_t erase_if(vector<T, Alloc, CapacityPolicy, CheckPolicy>& vec, Pred pred)
+{ return vec.erase_if(pred); }
+
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr size_t erase(vector<T, Alloc, CapacityPolicy, CheckPolicy>& vec, const T& value) {
+    // value could be the element of the vector, which is going to be destroyed
+    if(is_in_range(&value, vec.data(), vec.size())) {
+        T tmp = value;
+        return vec.erase_if([&tmp](const T& elem) { return elem == tmp; });
     }
 
-    return pos;
+    return vec.erase_if([&value](const T& elem) { return elem == value; });
 }
 
-template<typename T, template <typename> class Alloc>
-std::ostream& operator<<(std::ostream& stream, const vector<T, Alloc>& v) {
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+std::ostream& operator<<(std::ostream& stream, const vector<T, Alloc, CapacityPolicy, CheckPolicy>& v) {
 
-    for(typename vector<T, Alloc>::const_iterator iter = v.cbegin(); iter != v.cend(); iter++) {
+    for(typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::const_iterator iter = v.cbegin(); iter != v.cend(); iter++) {
         stream << *iter << " ";
     }
 
     return stream;
 }
 
-template<typename T, template <typename> class Alloc>
-void vector<T, Alloc>::increase_capacity(size_t low_limit) {
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr size_t vector<T, Alloc, CapacityPolicy, CheckPolicy>::grown_capacity(size_t low_limit) const {
 
-    size_t new_capacity = capacity_;
-    while(new_capacity < low_limit) {
-        new_capacity *= GROWTH_FACTOR;
-    }
+    return good_capacity(CapacityPolicy::grow(capacity_, low_limit, sizeof(T)));
+}
 
-    // TODO: remove copypaste
-    T* new_data = this->allocate(new_capacity);
-    set_mem<T>(new_data, 0, data_, 0, size_, true);
-    //????? clear_mem(data_, 0, size);
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr void vector<T, Alloc, CapacityPolicy, CheckPolicy>::increase_capacity(size_t low_limit)
+{ reallocate(grown_capacity(low_limit)); }
 
-    this->deallocate(data_, capacity_);
-    data_ = new_data;
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr void vector<T, Alloc, CapacityPolicy, CheckPolicy>::reduce_capacity(){
+    size_t new_capacity = CapacityPolicy::shrink(capacity_, size_);
 
-    capacity_ = new_capacity;
+    if(new_capacity < capacity_) {
+        reallocate(new_capacity);
+    }
 }
 
-template<typename T, template <typename> class Alloc>
-void vector<T, Alloc>::reduce_capacity(){
-    size_t new_capacity = capacity_;
-    while(size_ * DECREASE_FACTOR > new_capacity) { // TODO: optimize
-        new_capacity /= DECREASE_FACTOR;
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr void vector<T, Alloc, CapacityPolicy, CheckPolicy>::reallocate(size_t new_capacity){
+    new_capacity = good_capacity(new_capacity);
+    if(new_capacity == capacity_) return;
+
+    if(new_capacity > capacity_ && try_expand_storage(new_capacity)) return;
+
+    if(new_capacity < capacity_ && new_capacity != 0 && data_ &&
+       allocation_try_shrink(static_cast<Alloc<T>&>(*this), data_, capacity_, new_capacity)) {
+        capacity_ = new_capacity;
+        return;
     }
 
-    uint8_t* new_data = this->allocate(new_capacity);
-    set_mem<T>(new_data, 0, data_, 0, size_, true);
-    //????? clear_mem(data_, 0, size);
+    T* new_data = new_capacity ? this->allocate(new_capacity) : NULL;
+    uninitialized_relocate_n(data_, size_, new_data);
 
-    this->deallocate(data_, capacity_);
+    release_storage();
     data_ = new_data;
 
     capacity_ = new_capacity;
 }
 
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::iterator vector<T, Alloc>::begin()
+/// asks allocator to grow the block without moving it
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr bool vector<T, Alloc, CapacityPolicy, CheckPolicy>::try_expand_storage(size_t new_capacity) {
+    if(data_ == NULL || !allocation_try_expand(static_cast<Alloc<T>&>(*this), data_, capacity_, new_capacity))
+        return false;
+
+    capacity_ = new_capacity;
+    return true;
+}
+
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr size_t vector<T, Alloc, CapacityPolicy, CheckPolicy>::good_capacity(size_t n_elems) const
+{ return allocation_good_size(static_cast<const Alloc<T>&>(*this), n_elems); }
+
+/// allocates block for at least n_elems and sets capacity_, doesn't touch the old block
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr T* vector<T, Alloc, CapacityPolicy, CheckPolicy>::allocate_storage(size_t n_elems) {
+    capacity_ = good_capacity(n_elems);
+
+    return capacity_ ? this->allocate(capacity_) : NULL;
+}
+
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr void vector<T, Alloc, CapacityPolicy, CheckPolicy>::release_storage() {
+    if(data_) {
+        this->deallocate(data_, capacity_);
+    }
+    data_     = NULL;
+    capacity_ = 0;
+}
+
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::iterator vector<T, Alloc, CapacityPolicy, CheckPolicy>::begin()
 { return iterator((data_)); }
 
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::const_iterator vector<T, Alloc>::cbegin() const
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::const_iterator vector<T, Alloc, CapacityPolicy, CheckPolicy>::cbegin() const
 { return const_iterator((data_)); }
 
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::reverse_iterator vector<T, Alloc>::rbegin()
-{ return reverse_iterator((data_) + size_ - 1); }
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::reverse_iterator vector<T, Alloc, CapacityPolicy, CheckPolicy>::rbegin()
+{ return reverse_iterator(end()); }
 
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::const_reverse_iterator vector<T, Alloc>::crbegin() const
-{ return const_reverse_iterator((data_)+ size_ - 1); }
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::const_reverse_iterator vector<T, Alloc, CapacityPolicy, CheckPolicy>::crbegin() const
+{ return const_reverse_iterator(cend()); }
 
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::iterator vector<T, Alloc>::end()
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::iterator vector<T, Alloc, CapacityPolicy, CheckPolicy>::end()
 { return iterator((data_)+ size_); }
 
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::const_iterator  vector<T, Alloc>::cend() const
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::const_iterator  vector<T, Alloc, CapacityPolicy, CheckPolicy>::cend() const
 { return const_iterator((data_) + size_); }
 
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::reverse_iterator vector<T, Alloc>::rend()
-{ return reverse_iterator((data_)  - 1); }
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::reverse_iterator vector<T, Alloc, CapacityPolicy, CheckPolicy>::rend()
+{ return reverse_iterator(begin()); }
 
-template<typename T, template <typename> class Alloc>
-constexpr typename vector<T, Alloc>::const_reverse_iterator vector<T, Alloc>::crend() const
-{ return const_reverse_iterator((data_) - 1); }
+template<typename T, template <typename> class Alloc, class CapacityPolicy, class CheckPolicy>
+constexpr typename vector<T, Alloc, CapacityPolicy, CheckPolicy>::const_reverse_iterator vector<T, Alloc, CapacityPolicy, CheckPolicy>::crend() const
+{ return const_reverse_iterator(cbegin()); }
 
 
+/// compile-time tables: MakeVector is a constexpr callable returning nstd::vector, it is run twice in constant
+/// evaluation (for the length and for the values), so heap memory never leaves the compiler. The result could
+/// initialize a static constexpr std::array:
+///     static constexpr auto SQUARES = nstd::to_static_array([]{ nstd::vector<int> v; ...; return v; });
+template<typename MakeVector>
+consteval auto to_static_array(MakeVector make_vector) {
+    typedef typename decltype(make_vector())::value_type value_type;
+    constexpr size_t N_ELEMS = MakeVector{}().size();
+
+    std::array<value_type, N_ELEMS> table{};
+    auto vec = make_vector();
+
+    for(size_t n_elem = 0; n_elem < N_ELEMS; n_elem++) {
+        table[n_elem] = vec[n_elem];
+    }
+
+    return table;
+}
+
 
 // __________________________________________________________________________________________________________________________________ //
 
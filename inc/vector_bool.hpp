@@ -2,18 +2,139 @@
 #define VECTOR_BOOL_H
 
 #include <vector.hpp>
+#include <simd.hpp>
 #include <iostream>
 
+// Word-parallel primitives of vector<bool>: ranges of bits are given by word arrays and bit positions,
+// whole words are processed at once, partial words at the ends of the range are merged with masks.
+
 namespace nstd{
 
-template <>
-class vector<bool, std::allocator> : public std::allocator<uint8_t>{
+/// n lowest bits set, n <= BITS_PER_WORD
+inline bit_word_t bit_low_mask(size_t n_bits)
+{ return n_bits >= BITS_PER_WORD ? ~bit_word_t(0) : (bit_word_t(1) << n_bits) - 1; }
+
+inline size_t bit_words_for(size_t n_bits)
+{ return (n_bits + BITS_PER_WORD - 1) / BITS_PER_WORD; }
+
+/// n_bits <= BITS_PER_WORD bits starting from bit pos, in the low bits of the result
+inline bit_word_t bits_extract(const bit_word_t* words, size_t pos, size_t n_bits) {
+    size_t n_word = pos / BITS_PER_WORD;
+    size_t shift  = pos % BITS_PER_WORD;
+
+    bit_word_t bits = words[n_word] >> shift;
+    if(shift && shift + n_bits > BITS_PER_WORD) bits |= words[n_word + 1] << (BITS_PER_WORD - shift);
+
+    return bits & bit_low_mask(n_bits);
+}
+
+/// writes n_bits low bits of bits from bit pos on, the range must not cross a word boundary
+inline void bits_store(bit_word_t* words, size_t pos, size_t n_bits, bit_word_t bits) {
+    size_t shift    = pos % BITS_PER_WORD;
+    bit_word_t mask = bit_low_mask(n_bits) << shift;
+
+    bit_word_t& word = words[pos / BITS_PER_WORD];
+    word = (word & ~mask) | ((bits << shift) & mask);
+}
+
+/// sets bits [first, last) to val
+inline void bits_fill(bit_word_t* words, size_t first, size_t last, bool val) {
+    if(first >= last) return;
+
+    size_t n_first = first / BITS_PER_WORD;
+    size_t n_last  = (last - 1) / BITS_PER_WORD;
+    bit_word_t fill = val ? ~bit_word_t(0) : 0;
+
+    bit_word_t head = ~bit_word_t(0) << (first % BITS_PER_WORD);
+    bit_word_t tail = bit_low_mask(last - n_last * BITS_PER_WORD);
+
+    if(n_first == n_last) {
+        bit_word_t mask = head & tail;
+        words[n_first] = (words[n_first] & ~mask) | (fill & mask);
+        return;
+    }
+
+    words[n_first] = (words[n_first] & ~head) | (fill & head);
+    if(n_last > n_first + 1) memset(words + n_first + 1, val ? 0xFF : 0, (n_last - n_first - 1) * sizeof(bit_word_t));
+    words[n_last]  = (words[n_last] & ~tail) | (fill & tail);
+}
+
+/// n_words whole words of dst from the bit stream of src starting at bit shift of src[0], forward or backward.
+/// Each word is two neighbour source words shifted together, so the loop runs at memory speed
+inline void bit_words_shift_copy(const bit_word_t* src, size_t shift, bit_word_t* dst, size_t n_words, bool is_backward) {
+    if(shift == 0) {
+        memmove(dst, src, n_words * sizeof(bit_word_t));
+        return;
+    }
+
+    if(!is_backward) {
+        for(size_t i = 0; i < n_words; i++) {
+            dst[i] = (src[i] >> shift) | (src[i + 1] << (BITS_PER_WORD - shift));
+        }
+    }
+    else {
+        for(size_t i = n_words; i > 0; i--) {
+            dst[i - 1] = (src[i - 1] >> shift) | (src[i] << (BITS_PER_WORD - shift));
+        }
+    }
+}
+
+/// copies n_bits bits from bit from of from_words to bit to of to_words, a word per step: source words are
+/// shifted with the carry of their neighbour. Ranges in one array may overlap, direction is chosen accordingly
+inline void bits_move(const bit_word_t* from_words, size_t from, bit_word_t* to_words, size_t to, size_t n_bits) {
+    if(n_bits == 0 || (from_words == to_words && from == to)) return;
+
+    if(from_words != to_words || to < from) {
+        // head up to the word boundary of the destination
+        size_t chunk = (BITS_PER_WORD - to % BITS_PER_WORD) % BITS_PER_WORD;
+        if(chunk > n_bits) chunk = n_bits;
+        if(chunk) {
+            bits_store(to_words, to, chunk, bits_extract(from_words, from, chunk));
+            from += chunk; to += chunk; n_bits -= chunk;
+        }
+
+        // whole words; with a shift the word after the last one is read too, it still holds bits of the range
+        size_t n_whole = n_bits / BITS_PER_WORD;
+        bit_words_shift_copy(from_words + from / BITS_PER_WORD, from % BITS_PER_WORD,
+                             to_words + to / BITS_PER_WORD, n_whole, false);
+        from += n_whole * BITS_PER_WORD; to += n_whole * BITS_PER_WORD; n_bits -= n_whole * BITS_PER_WORD;
+
+        while(n_bits) {
+            chunk = n_bits < BITS_PER_WORD ? n_bits : BITS_PER_WORD;
+            bits_store(to_words, to, chunk, bits_extract(from_words, from, chunk));
+            from += chunk; to += chunk; n_bits -= chunk;
+        }
+        return;
+    }
+
+    // moving towards the end: from the last bits back, so the source isn't overwritten before it is read
+    size_t chunk = (to + n_bits) % BITS_PER_WORD;
+    if(chunk > n_bits) chunk = n_bits;
+    if(chunk) {
+        n_bits -= chunk;
+        bits_store(to_words, to + n_bits, chunk, bits_extract(from_words, from + n_bits, chunk));
+    }
+
+    size_t n_whole = n_bits / BITS_PER_WORD;
+    n_bits -= n_whole * BITS_PER_WORD;
+    size_t from_first = from + n_bits;
+    bit_words_shift_copy(from_words + from_first / BITS_PER_WORD, from_first % BITS_PER_WORD,
+                         to_words + (to + n_bits) / BITS_PER_WORD, n_whole, true);
+
+    if(n_bits) bits_store(to_words, to, n_bits, bits_extract(from_words, from, n_bits));
+}
+
+/// bits are packed into uint64_t words. Bits after size() in the last word are kept zero,
+/// so whole words could be compared, counted and combined
+template <class CapacityPolicy, class CheckPolicy>
+class vector<bool, std::allocator, CapacityPolicy, CheckPolicy> : public std::allocator<bit_word_t>{
 public:
     typedef bit_iterator<bit_reference>                iterator;
     typedef bit_iterator<bit_reference_const>          const_iterator;
     typedef bit_iterator_reverse<bit_reference>        reverse_iterator;
     typedef bit_iterator_reverse<bit_reference_const>  const_reverse_iterator;
 
+    typedef bool                  value_type;
     typedef bit_reference         reference;
     typedef bit_reference_const   const_reference;
     typedef bit_reference*        pointer;
@@ -22,27 +143,33 @@ public:
 public:
 
     vector():
-        data_(this->allocate(DEF_CAPACITY)),
+        data_(NULL),
         size_(0),
-        capacity_(DEF_CAPACITY){}
-    
+        capacity_(0){}
+
     explicit vector(size_t size, const bool& def_val = false):
-        data_(this->allocate(convert_size(size))),
-        size_(size),
-        capacity_(convert_size(size))
-    {
-        if(def_val)
-            memset(data_, 0xFF, capacity_);
-        else
-            memset(data_, 0, capacity_);
-    }
+        data_(NULL),
+        size_(0),
+        capacity_(0)
+    { assign(size, def_val); }
+
+    template<legacy_input_iterator ItFrom>
+    vector(ItFrom start, ItFrom last):
+        data_(NULL),
+        size_(0),
+        capacity_(0)
+    { insert(end(), start, last); }
 
     vector(const vector& other):
-        data_(this->allocate(convert_size(other.size_))),
-        size_(other.size_),
-        capacity_(convert_size(other.size_))
+        std::allocator<bit_word_t>(other),
+        data_(NULL),
+        size_(0),
+        capacity_(0)
     {
-        memcpy(data_, other.data_, convert_size(other.size_));
+        reallocate(bit_words_for(other.size_));
+
+        if(other.size_) memcpy(data_, other.data_, bit_words_for(other.size_) * sizeof(bit_word_t));
+        size_ = other.size_;
     }
 
     vector(vector&& other):
@@ -55,7 +182,7 @@ public:
     }
 
     ~vector() {
-        this->deallocate(data_, capacity_);
+        if(data_) this->deallocate(data_, capacity_);
         size_ = 0;
         capacity_ = 0;
     }
@@ -63,24 +190,40 @@ public:
     vector& operator=(const vector& other){
         vector tmp = other;
         *this = nstd::move(tmp);
-        
+
         return *this;
     }
 
     vector& operator=(vector&& other){
-        data_ = other.data_;
-        size_ = other.size_;
-        capacity_ = other.capacity_;
+        vector tmp(nstd::move(other));
+        swap(tmp);
 
         return *this;
     }
 
+    void swap(vector& other) {
+        std::swap(data_,     other.data_);
+        std::swap(size_,     other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
     void assign(size_t n_elems, const bool& val){
         reserve(n_elems);
 
-        // TODO: refactor
-        bit_iterator<bit_reference> start = begin();
-        set_mem(start, start + n_elems, val);
+        // whole words are filled, then the bits after n_elems are zeroed back
+        size_t n_words = bit_words_for(n_elems);
+        if(n_words) {
+            memset(data_, val ? 0xFF : 0, n_words * sizeof(bit_word_t));
+            data_[n_words - 1] &= bit_low_mask(n_elems - (n_words - 1) * BITS_PER_WORD);
+        }
+        clear_tail(n_words * BITS_PER_WORD, size_);
+        size_ = n_elems;
+    }
+
+    template<legacy_input_iterator ItFrom>
+    void assign(ItFrom start, ItFrom last) {
+        clear();
+        insert(end(), start, last);
     }
 
     // TODO: remove copypaste
@@ -100,27 +243,37 @@ public:
         return *(cbegin() + n_elem);
     }
 
-    reference       operator[](size_t n_elem)
-    { return at(n_elem); }
+    reference       operator[](size_t n_elem){
+        CheckPolicy::check(n_elem, size_);
+        return *(begin() + n_elem);
+    }
 
-    const_reference operator[](size_t n_elem) const
-    { return at(n_elem); }
+    const_reference operator[](size_t n_elem) const {
+        CheckPolicy::check(n_elem, size_);
+        return *(cbegin() + n_elem);
+    }
 
     reference front()
-    { return at(0); }
+    { return operator[](0); }
 
     reference back()
-    { return at(size_ - 1); }
+    { return operator[](size_ - 1); }
 
     const_reference front() const
-    { return at(0); }
+    { return operator[](0); }
 
     const_reference back() const
-    { return at(size_ - 1); }
+    { return operator[](size_ - 1); }
+
+    /// words of the bits, n_words() of them are in use
+    bit_word_t* data()
+    { return data_; }
+
+    const bit_word_t* data() const
+    { return data_; }
 
-    // TODO:
-    pointer data();
-    const_pointer data() const;
+    size_t n_words() const
+    { return bit_words_for(size_); }
 
     bool empty() const
     { return size_ == 0; }
@@ -130,45 +283,138 @@ public:
 
     // size_t          max_size() const; ? how to implement
     void reserve(size_t capacity){
-        if(capacity <= capacity_) return;
+        if(bit_words_for(capacity) <= capacity_) return;
 
-        if(capacity_ == 0) {
-            data_ = this->allocate(capacity);
-        }
-
-        increase_capacity(capacity);
-        capacity_ = capacity;
+        reallocate(bit_words_for(capacity));
     }
 
+    /// in bits
     size_t capacity() const
-    { return capacity_; }
+    { return capacity_ * BITS_PER_WORD; }
 
     void shrink_to_fit(){
-        if(capacity_ == size_) return;
+        if(capacity_ == bit_words_for(size_)) return;
 
-        vector tmp = *this;
-        deallocate(data_, capacity_);
-        *this = nstd::move(tmp);
-        tmp.data_ = NULL;
+        reallocate(bit_words_for(size_));
     }
 
-    void clear()
-    { size_ = 0; }
+    void clear() {
+        clear_tail(0, size_);
+        size_ = 0;
+    }
+
+    /// inverts all the bits
+    void flip() {
+        simd::bit_words_not(data_, data_, bit_words_for(size_));
+        clear_tail(size_, bit_words_for(size_) * BITS_PER_WORD);
+    }
+
+    // Set algebra: operands must be of the same size, whole words are combined by the simd kernels.
+    // Zero bits after size() stay zero under and, or, xor and andnot
+
+    vector& operator&=(const vector& other)
+    { return apply<simd::BIT_AND>(other); }
+
+    vector& operator|=(const vector& other)
+    { return apply<simd::BIT_OR>(other); }
+
+    vector& operator^=(const vector& other)
+    { return apply<simd::BIT_XOR>(other); }
+
+    /// clears the bits set in other
+    vector& andnot(const vector& other)
+    { return apply<simd::BIT_ANDNOT>(other); }
+
+    friend vector operator&(const vector& lhs, const vector& rhs)
+    { return combine<simd::BIT_AND>(lhs, rhs); }
+
+    friend vector operator|(const vector& lhs, const vector& rhs)
+    { return combine<simd::BIT_OR>(lhs, rhs); }
+
+    friend vector operator^(const vector& lhs, const vector& rhs)
+    { return combine<simd::BIT_XOR>(lhs, rhs); }
+
+    /// whether some bit is set in both
+    bool intersects(const vector& other) const {
+        check_same_size(other);
+        return simd::bit_words_any<simd::BIT_AND>(data_, other.data_, bit_words_for(size_));
+    }
+
+    /// whether every bit set here is set in other
+    bool is_subset_of(const vector& other) const {
+        check_same_size(other);
+        return !simd::bit_words_any<simd::BIT_ANDNOT>(data_, other.data_, bit_words_for(size_));
+    }
+
+    // Counting and searching go a word at a time: popcnt, tzcnt, and runs of zero words
+    // are skipped by simd tests. Searches return size() if nothing is found
+
+    /// number of set bits
+    size_t count() const
+    { return simd::bit_words_popcount(data_, bit_words_for(size_)); }
+
+    /// number of set bits in [first, last)
+    size_t count(size_t first, size_t last) const {
+        if(first > last || last > size_)
+            throw std::out_of_range("out of range");
+        if(first == last) return 0;
+
+        size_t n_first = first / BITS_PER_WORD;
+        size_t n_last  = (last - 1) / BITS_PER_WORD;
+        bit_word_t first_mask = ~bit_word_t(0) << (first % BITS_PER_WORD);
+        bit_word_t last_mask  = bit_low_mask(last - n_last * BITS_PER_WORD);
+
+        if(n_first == n_last) return __builtin_popcountll(data_[n_first] & first_mask & last_mask);
+
+        return __builtin_popcountll(data_[n_first] & first_mask) +
+               simd::bit_words_popcount(data_ + n_first + 1, n_last - n_first - 1) +
+               __builtin_popcountll(data_[n_last] & last_mask);
+    }
+
+    size_t find_first() const
+    { return find_from(0, true); }
+
+    /// first set bit after pos
+    size_t find_next(size_t pos) const
+    { return pos + 1 < size_ ? find_from(pos + 1, true) : size_; }
+
+    size_t find_first_unset() const
+    { return find_from(0, false); }
+
+    /// first unset bit after pos
+    size_t find_next_unset(size_t pos) const
+    { return pos + 1 < size_ ? find_from(pos + 1, false) : size_; }
+
+    /// calls visit(n_bit) for every set bit in ascending order
+    template<typename Visitor>
+    void for_each_set_bit(Visitor visit) const {
+        size_t n_words = bit_words_for(size_);
+
+        for(size_t n_word = 0; ; n_word++) {
+            n_word += simd::bit_words_find(data_ + n_word, n_words - n_word, 0);
+            if(n_word == n_words) return;
+
+            for(bit_word_t word = data_[n_word]; word; word &= word - 1) {
+                visit(n_word * BITS_PER_WORD + __builtin_ctzll(word));
+            }
+        }
+    }
 
     //? why in standart const_iterator used and what would be realization of erase with it :|
     iterator erase(iterator pos)
     { return erase(pos, pos + 1); }
 
+    /// the tail is moved down a word at a time
     iterator erase(iterator start, iterator last){
-        auto offset = last - start;
-        
-        for(iterator it = start; it + offset != end(); it++) {
-            *(it) = nstd::move(*(it + offset));
-        }
+        size_t n_first  = start - begin();
+        size_t n_erased = last - start;
+        if(n_erased == 0) return start;
 
-        size_--;
+        bits_move(data_, n_first + n_erased, data_, n_first, size_ - n_first - n_erased);
+        clear_tail(size_ - n_erased, size_);
+        size_ -= n_erased;
 
-        return start;
+        return begin() + n_first;
     }
 
     // TODO: remove copypaste
@@ -176,68 +422,77 @@ public:
     iterator insert(iterator pos, const bool& val)
     { return insert(pos, 1, val); }
 
-    iterator insert(iterator pos, bool&& val){
-        reserve(size_ + 1);
-        size_++;
-
-        reverse_iterator last_pos = bit_iterator_reverse<bit_reference>(pos.bit_ref());
-
-        for(reverse_iterator it = rbegin(); it != last_pos; it++) {
-            *(it) = nstd::move(*(it + 1));
-        }
+    iterator insert(iterator pos, bool&& val)
+    { return insert(pos, 1, val); }
 
-        *pos = nstd::move(val);
+    iterator insert(iterator pos, size_t count, const bool& val){
+        size_t n_pos = open_gap(pos - begin(), count);
+        bits_fill(data_, n_pos, n_pos + count, val);
 
-        return pos;
+        return begin() + n_pos;
     }
 
-    iterator insert(iterator pos, size_t count, const bool& val){
-        if(count == 0) return pos;
-
-        reserve(size_ + count);
+    /// bits of vector<bool> are copied by words, other ranges are measured first if they could be,
+    /// single-pass ones are appended or buffered in a temporary vector<bool>
+    template<legacy_input_iterator ItFrom>
+    iterator insert(iterator pos, ItFrom start, ItFrom last) {
+        size_t n_pos = pos - begin();
 
-        size_ += count;
+        if constexpr(std::is_same_v<ItFrom, iterator> || std::is_same_v<ItFrom, const_iterator>) {
+            size_t count = last - start;
+            auto first_bit = start.bit_ref();
 
-        reverse_iterator last_pos = bit_iterator_reverse<bit_reference>(pos.bit_ref());
+            // source could be in this vector, so it is copied out before the gap is opened
+            vector bits;
+            bits.reallocate(bit_words_for(count));
+            bits_move(first_bit.p_data_, first_bit.mask_offset_, bits.data_, 0, count);
+            bits.size_ = count;
 
-        for(reverse_iterator it = rbegin(); it + count != last_pos; it++) {
-            *(it) = nstd::move(*(it + count));
+            open_gap(n_pos, count);
+            bits_move(bits.data_, 0, data_, n_pos, count);
         }
+        else if constexpr(legacy_forward_iterator<ItFrom>) {
+            size_t count = std::distance(start, last);
+            open_gap(n_pos, count);
 
-        for(iterator it = pos; it != pos + count; it++){
-            *(it) = val;
+            for(iterator it = begin() + n_pos; start != last; ++start, ++it) {
+                *it = bool(*start);
+            }
+        }
+        else if(n_pos == size_) {
+            for(; start != last; ++start) {
+                push_back(bool(*start));
+            }
+        }
+        else {
+            // length is unknown, so the bits are collected first and then copied into the gap by words
+            vector bits;
+            for(; start != last; ++start) {
+                bits.push_back(bool(*start));
+            }
+
+            open_gap(n_pos, bits.size_);
+            bits_move(bits.data_, 0, data_, n_pos, bits.size_);
         }
 
-        return pos;
+        return begin() + n_pos;
     }
 
-    // TODO:
-    //template<class ItFrom>
-    //iterator        insert(iterator pos, ItFrom start, ItFrom last);
-    
-    // TODO: emplace
+    template<typename Range>
+    void append_range(Range&& range)
+    { insert(end(), std::begin(range), std::end(range)); }
 
     void push_back(const bool& val){
-        if(capacity_ == 0) {
-            reserve(1);
-        }
-        if(capacity_ * 8 == size_) {
-            increase_capacity(capacity_ + 1);
+        if(size_ == capacity()) {
+            reallocate(CapacityPolicy::grow(capacity_, capacity_ + 1, sizeof(bit_word_t)));
         }
 
-        *(begin() + size_++) = val;
+        bits_store(data_, size_, 1, val);
+        size_++;
     }
 
-    void push_back(bool&& val){
-        if(capacity_ == 0) {
-            reserve(1);
-        }
-        if(capacity_ * 8 == size_) {
-            increase_capacity(capacity_ + 1);
-        }
-
-        *(begin() + size_++) = val;
-    }
+    void push_back(bool&& val)
+    { push_back(static_cast<const bool&>(val)); }
 
     // TODO: emplace_back
 
@@ -245,32 +500,27 @@ public:
         if(size_ == 0)
             throw std::out_of_range("pop_back on empty vector");
 
-        bool val = at(size_ - 1);
+        bool val = (*this)[size_ - 1];
+        clear_tail(size_ - 1, size_);
+        size_--;
+
+        size_t new_capacity = CapacityPolicy::shrink(capacity_, bit_words_for(size_));
+        if(new_capacity < capacity_) reallocate(new_capacity);
 
-        if((size_ - 1) * DECREASE_FACTOR >= capacity_ * 8) {
-            reduce_capacity();
-        }
         return val;
     }
 
-    void resize(size_t n_elems){
-        reserve(n_elems);
-        size_ = n_elems;
-    }
+    void resize(size_t n_elems)
+    { resize(n_elems, false); }
 
     void resize(size_t n_elems, const bool& val){
         reserve(n_elems);
-        size_ = n_elems;
 
-        if(size_ < n_elems) { 
-            if(val)
-                memset(data_, 0xFF, convert_size(n_elems));
-            else
-                memset(data_, 0, convert_size(n_elems));
-        }
-    }
+        if(n_elems > size_) bits_fill(data_, size_, n_elems, val);
+        else                clear_tail(n_elems, size_);
 
-    // TODO: void            swap(vector<T>& other);
+        size_ = n_elems;
+    }
 
     iterator begin()
     { return bit_iterator<bit_reference>(bit_reference(data_, 0));}
@@ -278,7 +528,7 @@ public:
     const_iterator cbegin() const
     { return bit_iterator<bit_reference_const>(bit_reference_const(data_, 0));}
 
-    reverse_iterator rbegin() { 
+    reverse_iterator rbegin() {
         bit_iterator<bit_reference> tmp = begin() + size_ - 1;
         return bit_iterator_reverse<bit_reference>(tmp.bit_ref());
     }
@@ -301,57 +551,95 @@ public:
     { return crbegin() + size_; }
 
 private:
-    uint8_t*  data_;
-    size_t    size_;
-    size_t    capacity_;
+    bit_word_t*  data_;
+    size_t       size_;
+    /// in words
+    size_t       capacity_;
 
 private:
-    void increase_capacity(size_t low_limit){
+    /// new block of new_capacity words, bits up to size_ are kept
+    void reallocate(size_t new_capacity) {
+        bit_word_t* new_data = new_capacity ? this->allocate(new_capacity) : NULL;
 
-        size_t new_capacity = capacity_;
-        while(new_capacity < low_limit) {
-            new_capacity *= GROWTH_FACTOR;
-        }
+        size_t n_used = bit_words_for(size_);
+        if(n_used)                   memcpy(new_data, data_, n_used * sizeof(bit_word_t));
+        if(new_capacity > n_used)    memset(new_data + n_used, 0, (new_capacity - n_used) * sizeof(bit_word_t));
+
+        if(data_) this->deallocate(data_, capacity_);
+        data_     = new_data;
+        capacity_ = new_capacity;
+    }
 
-        // TODO: remove copypaste
-        uint8_t* new_data = this->allocate(new_capacity);
+    /// first bit equal to val in [first, size_)
+    size_t find_from(size_t first, bool val) const {
+        if(first >= size_) return size_;
 
-        memcpy(new_data, data_, capacity_);
+        bit_word_t flip = val ? 0 : ~bit_word_t(0);
+        size_t n_words  = bit_words_for(size_);
+        size_t n_word   = first / BITS_PER_WORD;
 
-        this->deallocate(data_, capacity_);
-        data_ = new_data;
+        bit_word_t word = (data_[n_word] ^ flip) & (~bit_word_t(0) << (first % BITS_PER_WORD));
+        if(!word) {
+            n_word += 1 + simd::bit_words_find(data_ + n_word + 1, n_words - n_word - 1, flip);
+            if(n_word == n_words) return size_;
 
-        capacity_ = new_capacity;
-    }
-    void reduce_capacity(){
-        size_t new_capacity = capacity_;
-        while(size_ * DECREASE_FACTOR > new_capacity) { // TODO: optimize
-            new_capacity /= DECREASE_FACTOR;
+            word = data_[n_word] ^ flip;
         }
 
-        uint8_t* new_data = this->allocate(new_capacity);
-        memcpy(new_data, data_, capacity_);
-        this->deallocate(data_, capacity_);
-        data_ = new_data;
+        // unset bits after size_ could be found in the last word
+        size_t n_bit = n_word * BITS_PER_WORD + __builtin_ctzll(word);
+        return n_bit < size_ ? n_bit : size_;
+    }
 
-        capacity_ = new_capacity;
+    void check_same_size(const vector& other) const {
+        if(size_ != other.size_)
+            throw std::invalid_argument("bitwise operation on vectors of different sizes");
     }
 
-    // TODO: memset optimization
-    void set_mem(bit_iterator<bit_reference> start, bit_iterator<bit_reference> finish, bool val) {
-        for(bit_iterator<bit_reference> it = start; it != finish; it++) {
-            *it = val;
-        }
+    template<simd::bit_op_t OP>
+    vector& apply(const vector& other) {
+        check_same_size(other);
+        simd::bit_words<OP>(data_, other.data_, data_, bit_words_for(size_));
+
+        return *this;
     }
 
-    void set_mem(bit_iterator<bit_reference> start, bit_iterator<bit_reference> finish, bit_iterator<bit_reference_const> other_start) {
-        for(bit_iterator<bit_reference> it = start; it != finish; it++, other_start++) {
-            *it = *other_start;
+    /// the result is written straight into new storage, so each word is read and written once
+    template<simd::bit_op_t OP>
+    static vector combine(const vector& lhs, const vector& rhs) {
+        lhs.check_same_size(rhs);
+
+        vector res;
+        size_t n_words = bit_words_for(lhs.size_);
+        if(n_words) {
+            res.data_     = res.allocate(n_words);
+            res.capacity_ = n_words;
+            res.size_     = lhs.size_;
+            simd::bit_words<OP>(lhs.data_, rhs.data_, res.data_, n_words);
         }
+
+        return res;
     }
 
-    size_t convert_size(size_t size)
-        { return ((size + 7) / 8); }
+    /// zeroes bits [first, last), which are going out of the vector
+    void clear_tail(size_t first, size_t last) {
+        if(first < last) bits_fill(data_, first, last, false);
+    }
+
+    /// makes count bits of room at n_pos by shifting the tail towards the end, returns n_pos
+    size_t open_gap(size_t n_pos, size_t count) {
+        if(count == 0) return n_pos;
+
+        if(size_ + count > capacity()) {
+            size_t n_words = bit_words_for(size_ + count);
+            reallocate(CapacityPolicy::grow(capacity_, n_words, sizeof(bit_word_t)));
+        }
+
+        bits_move(data_, n_pos, data_, n_pos + count, size_ - n_pos);
+        size_ += count;
+
+        return n_pos;
+    }
 
 };
 
@@ -0,0 +1,112 @@
+#include <iostream>
+#include <stdint.h>
+#include <string.h>
+#include "allocator.hpp"
+#include "vector.hpp"
+
+// Behaviour checks of HugePageAllocator, exit code is the number of failed ones
+
+static int n_failed = 0;
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if(!(cond)) {                                                               \
+            std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #cond "\n";    \
+            n_failed++;                                                             \
+        }                                                                           \
+    } while(0)
+
+typedef nstd::HugePageAllocator<uint32_t> huge_alloc_t;
+
+static const size_t HUGE_PAGE = huge_alloc_t::HUGE_PAGE_SIZE;
+
+static bool is_aligned(const void* ptr)
+{ return reinterpret_cast<uintptr_t>(ptr) % HUGE_PAGE == 0; }
+
+/// every element holds its index, so a moved or a partially copied block is noticed
+static void fill(uint32_t* ptr, size_t begin, size_t end) {
+    for(size_t i = begin; i < end; i++) ptr[i] = uint32_t(i);
+}
+
+static bool is_filled(const uint32_t* ptr, size_t begin, size_t end) {
+    for(size_t i = begin; i < end; i++) {
+        if(ptr[i] != uint32_t(i)) return false;
+    }
+    return true;
+}
+
+void test_allocate() {
+    huge_alloc_t alloc;
+
+    // small blocks come from std::allocator and aren't rounded
+    CHECK(alloc.good_size(100) == 100);
+    uint32_t* small = alloc.allocate(100);
+    fill(small, 0, 100);
+    CHECK(is_filled(small, 0, 100));
+    alloc.deallocate(small, 100);
+
+    // big ones are whole aligned huge pages
+    size_t n_elems = HUGE_PAGE / sizeof(uint32_t) * 3 + 1;
+    size_t n_good  = alloc.good_size(n_elems);
+    CHECK(n_good == HUGE_PAGE / sizeof(uint32_t) * 4);
+    CHECK(alloc.good_size(n_good) == n_good);
+
+    uint32_t* big = alloc.allocate(n_good);
+    CHECK(is_aligned(big));
+    fill(big, 0, n_good);
+    CHECK(is_filled(big, 0, n_good));
+
+    // grow in place if the address space after the mapping is free, then give it back
+    size_t n_expanded = n_good * 2;
+    if(alloc.try_expand(big, n_good, n_expanded)) {
+        CHECK(is_filled(big, 0, n_good));
+        fill(big, n_good, n_expanded);
+        CHECK(is_filled(big, 0, n_expanded));
+
+        CHECK(alloc.try_shrink(big, n_expanded, n_good));
+    }
+    CHECK(alloc.try_shrink(big, n_good, n_good / 2));
+    CHECK(is_filled(big, 0, n_good / 2));
+
+    // shrink below the threshold would change the owner of the block
+    CHECK(!alloc.try_shrink(big, n_good / 2, 10));
+    // small blocks never resize
+    CHECK(!alloc.try_expand(small, 100, 200));
+
+    alloc.deallocate(big, n_good / 2);
+}
+
+void test_vector() {
+    nstd::vector<uint32_t, nstd::HugePageAllocator> v;
+
+    // crosses the threshold, data is relocated from the std::allocator block once
+    size_t n_elems = 5 * HUGE_PAGE / sizeof(uint32_t) + 12345;
+    for(size_t i = 0; i < n_elems; i++) v.push_back(uint32_t(i));
+
+    CHECK(v.size() == n_elems);
+    CHECK(is_filled(v.data(), 0, n_elems));
+    CHECK(is_aligned(v.data()));
+    CHECK(v.capacity() * sizeof(uint32_t) % HUGE_PAGE == 0);
+
+    v.resize(HUGE_PAGE / sizeof(uint32_t) + 1);
+    v.shrink_to_fit();
+    CHECK(v.capacity() == 2 * HUGE_PAGE / sizeof(uint32_t));
+    CHECK(is_filled(v.data(), 0, v.size()));
+
+    // copy gets its own mapping
+    nstd::vector<uint32_t, nstd::HugePageAllocator> copy(v);
+    CHECK(copy.data() != v.data() && is_filled(copy.data(), 0, copy.size()));
+
+    v.resize(10);
+    v.shrink_to_fit();
+    CHECK(v.size() == 10 && is_filled(v.data(), 0, 10));
+    CHECK(copy.size() == HUGE_PAGE / sizeof(uint32_t) + 1);
+}
+
+int main() {
+    test_allocate();
+    test_vector();
+
+    std::cout << (n_failed ? "allocator_test: FAILED\n" : "allocator_test: OK\n");
+    return n_failed;
+}
@@ -0,0 +1,124 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string.h>
+#include "vector.hpp"
+
+// Replays push/pop patterns on vectors with different capacity policies and reports
+// the allocations and the bytes moved by reallocations (counted by the move constructor of the element).
+// The first policy is the threshold shrink without hysteresis, which pop_back had before the policies
+
+struct counters_t {
+    size_t n_allocations;
+    size_t n_bytes_moved;
+    size_t n_pops;
+};
+
+static counters_t counters;
+
+/// std::allocator, which counts allocate() calls
+template<typename T>
+struct counting_allocator : std::allocator<T> {
+    T* allocate(size_t n_elems) {
+        counters.n_allocations++;
+        return std::allocator<T>::allocate(n_elems);
+    }
+};
+
+/// non-trivial move, so reallocations move it one by one and each move is counted
+struct payload {
+    uint8_t bytes[64];
+
+    payload() { memset(bytes, 0, sizeof(bytes)); }
+    payload(const payload& other) { memcpy(bytes, other.bytes, sizeof(bytes)); }
+    payload(payload&& other) {
+        memcpy(bytes, other.bytes, sizeof(bytes));
+        counters.n_bytes_moved += sizeof(bytes);
+    }
+    payload& operator=(const payload& other) = default;
+};
+
+/// pop_back returns the element, so its own move is subtracted later
+template<typename Vector>
+void pop(Vector& v) {
+    v.pop_back();
+    counters.n_pops++;
+}
+
+/// size oscillates by one element around the power of two, where growth happens
+template<typename Vector>
+void boundary_oscillation(Vector& v) {
+    while(v.size() < 1024) v.emplace_back();
+
+    for(size_t i = 0; i < 200000; i++) {
+        v.emplace_back();
+        pop(v);
+    }
+}
+
+/// bursts of 1000 pushes, then 1000 pops
+template<typename Vector>
+void sawtooth(Vector& v) {
+    for(size_t n_burst = 0; n_burst < 200; n_burst++) {
+        for(size_t i = 0; i < 1000; i++) v.emplace_back();
+        for(size_t i = 0; i < 1000; i++) pop(v);
+    }
+}
+
+/// grows to 100000 elements and drains to empty, a few times
+template<typename Vector>
+void fill_drain(Vector& v) {
+    for(size_t n_round = 0; n_round < 5; n_round++) {
+        for(size_t i = 0; i < 100000; i++) v.emplace_back();
+        while(!v.empty()) pop(v);
+    }
+}
+
+/// bytes moved by one pop_back without a reallocation
+static size_t pop_bytes() {
+    nstd::vector<payload, counting_allocator, nstd::capacity_policy<nstd::growth_x2, nstd::shrink_never>> v;
+    v.emplace_back();
+
+    counters = counters_t{};
+    v.pop_back();
+    return counters.n_bytes_moved;
+}
+
+template<class Policy>
+void run_policy(const char* policy_name) {
+    typedef nstd::vector<payload, counting_allocator, Policy> vector_t;
+
+    std::cout << std::left << std::setw(34) << policy_name;
+    size_t n_pop_bytes = pop_bytes();
+
+    void (*patterns[])(vector_t&) = {boundary_oscillation<vector_t>, sawtooth<vector_t>, fill_drain<vector_t>};
+    for(auto pattern : patterns) {
+        counters = counters_t{};
+        auto start = std::chrono::steady_clock::now();
+        {
+            vector_t v;
+            pattern(v);
+        }
+        counters.n_bytes_moved -= counters.n_pops * n_pop_bytes;
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << std::right << std::setw(9) << counters.n_allocations << std::setw(10) << std::fixed
+                  << std::setprecision(1) << counters.n_bytes_moved / 1e6 << std::setw(8) << ms << "   ";
+    }
+    std::cout << "\n";
+}
+
+int main() {
+    std::cout << std::left << std::setw(34) << "policy"
+              << "   boundary: allocs MB_moved ms   sawtooth: allocs MB_moved ms   fill/drain: allocs MB_moved ms\n";
+
+    run_policy<nstd::capacity_policy<nstd::growth_x2, nstd::shrink_hysteresis<2, 1, 1>>>("x2, shrink at 1/2 (no hysteresis)");
+    run_policy<nstd::capacity_policy<nstd::growth_x2, nstd::shrink_hysteresis<>>>("x2, hysteresis (default)");
+    run_policy<nstd::capacity_policy<nstd::growth_x2, nstd::shrink_never>>("x2, never shrink");
+    run_policy<nstd::capacity_policy<nstd::growth_x1_5, nstd::shrink_hysteresis<>>>("x1.5, hysteresis");
+    run_policy<nstd::capacity_policy<nstd::growth_size_class<>, nstd::shrink_hysteresis<>>>("x2 size class, hysteresis");
+    run_policy<nstd::capacity_policy<nstd::growth_size_class<nstd::growth_x1_5>, nstd::shrink_never>>("x1.5 size class, never shrink");
+
+    return 0;
+}
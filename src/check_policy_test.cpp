@@ -0,0 +1,91 @@
+#include <iostream>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <signal.h>
+#include "vector.hpp"
+#include "vector_bool.hpp"
+
+// Behaviour checks of the bounds checking policies, exit code is the number of failed ones.
+// Must be compiled without NDEBUG, check_debug is tested through assert
+
+static int n_failed = 0;
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if(!(cond)) {                                                               \
+            std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #cond "\n";    \
+            n_failed++;                                                             \
+        }                                                                           \
+    } while(0)
+
+template<typename Vector>
+bool throws_out_of_range(Vector& v, size_t n_elem) {
+    try {
+        (void)v[n_elem];
+    } catch(const std::out_of_range&) {
+        return true;
+    }
+    return false;
+}
+
+/// runs access in a child process, whether it was killed by SIGABRT
+template<typename Access>
+bool aborts(Access access) {
+    std::cout.flush();
+
+    pid_t pid = fork();
+    if(pid == 0) {
+        // the message of the failed assert is expected, it is hidden
+        if(freopen("/dev/null", "w", stderr) == NULL) _exit(2);
+        access();
+        _exit(0);
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+}
+
+void test_check_always() {
+    nstd::vector<int, std::allocator, nstd::default_capacity_policy, nstd::check_always> v(4, 1);
+
+    CHECK(!throws_out_of_range(v, 3));
+    CHECK(throws_out_of_range(v, 4));
+    CHECK(throws_out_of_range(v, size_t(-1)));
+
+    const auto& cv = v;
+    CHECK(throws_out_of_range(cv, 4));
+
+    v.clear();
+    bool is_thrown = false;
+    try {
+        (void)v.front();
+    } catch(const std::out_of_range&) {
+        is_thrown = true;
+    }
+    CHECK(is_thrown);
+
+    nstd::vector<bool, std::allocator, nstd::default_capacity_policy, nstd::check_always> bits(70, true);
+    CHECK(!throws_out_of_range(bits, 69));
+    CHECK(throws_out_of_range(bits, 70));
+}
+
+void test_check_debug() {
+    nstd::vector<int, std::allocator, nstd::default_capacity_policy, nstd::check_debug> v(4, 1);
+
+    CHECK(!aborts([&]{ (void)v[3]; }));
+    CHECK(aborts([&]{ (void)v[4]; }));
+    CHECK(aborts([&]{ v.clear(); (void)v.back(); }));
+
+    nstd::vector<bool, std::allocator, nstd::default_capacity_policy, nstd::check_debug> bits(70, true);
+    CHECK(aborts([&]{ (void)bits[70]; }));
+}
+
+int main() {
+    test_check_always();
+    test_check_debug();
+
+    std::cout << (n_failed ? "check_policy_test: FAILED\n" : "check_policy_test: OK\n");
+    return n_failed;
+}
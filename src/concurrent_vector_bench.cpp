@@ -0,0 +1,55 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <stdint.h>
+#include "concurrent_vector.hpp"
+#include "vector.hpp"
+
+// Throughput of concurrent push_back from 1 to 64 threads: concurrent_vector against nstd::vector behind
+// a mutex. Every run pushes N_PUSHES elements in total, cells are millions of pushes per second
+
+static const size_t N_PUSHES = 1 << 24;
+
+template<typename TPush>
+double run(size_t n_threads, TPush push) {
+    nstd::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for(size_t n_thread = 0; n_thread < n_threads; n_thread++) {
+        threads.push_back(std::thread([&, n_thread]{
+            for(size_t i = n_thread; i < N_PUSHES; i += n_threads) push(uint64_t(i));
+        }));
+    }
+    for(size_t n_thread = 0; n_thread < threads.size(); n_thread++) threads[n_thread].join();
+
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return N_PUSHES / sec / 1e6;
+}
+
+int main() {
+    std::cout << N_PUSHES << " pushes of uint64_t, " << std::thread::hardware_concurrency() << " cores, Mpush/s\n";
+    std::cout << std::setw(8) << "threads" << std::setw(20) << "concurrent_vector" << std::setw(20) << "vector + mutex" << "\n";
+
+    for(size_t n_threads = 1; n_threads <= 64; n_threads *= 2) {
+        double concurrent_rate = 0, locked_rate = 0;
+        {
+            nstd::concurrent_vector<uint64_t> v;
+            concurrent_rate = run(n_threads, [&](uint64_t value) { v.push_back(value); });
+        }
+        {
+            nstd::vector<uint64_t> v;
+            std::mutex mutex;
+            locked_rate = run(n_threads, [&](uint64_t value) {
+                std::lock_guard<std::mutex> lock(mutex);
+                v.push_back(value);
+            });
+        }
+
+        std::cout << std::setw(8) << n_threads << std::fixed << std::setprecision(1)
+                  << std::setw(20) << concurrent_rate << std::setw(20) << locked_rate << "\n";
+    }
+
+    return 0;
+}
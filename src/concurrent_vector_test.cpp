@@ -0,0 +1,240 @@
+#include <iostream>
+#include <stdexcept>
+#include <atomic>
+#include <thread>
+#include "concurrent_vector.hpp"
+#include "vector.hpp"
+#include "vector_bool.hpp"
+
+// Behaviour checks of concurrent_vector, exit code is the number of failed ones
+
+static int n_failed = 0;
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if(!(cond)) {                                                               \
+            std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #cond "\n";    \
+            n_failed++;                                                             \
+        }                                                                           \
+    } while(0)
+
+/// constructor throws for negative values, live objects are counted
+struct Checked {
+    static std::atomic<int> n_alive;
+
+    int value;
+
+    Checked(int value_): value(value_) {
+        if(value < 0) throw std::runtime_error("negative");
+        n_alive++;
+    }
+    Checked(const Checked& other): value(other.value) { n_alive++; }
+    ~Checked() { n_alive--; }
+};
+
+std::atomic<int> Checked::n_alive(0);
+
+static std::atomic<int> n_failing_allocations(0);
+
+/// std::allocator, which throws bad_alloc for the next n_failing_allocations calls
+template<typename T>
+struct failing_allocator : std::allocator<T> {
+    T* allocate(size_t n_elems) {
+        int n_failing = n_failing_allocations.load();
+        while(n_failing > 0 && !n_failing_allocations.compare_exchange_weak(n_failing, n_failing - 1)) {}
+
+        if(n_failing > 0) throw std::bad_alloc();
+        return std::allocator<T>::allocate(n_elems);
+    }
+};
+
+void test_throwing_constructor() {
+    {
+        nstd::concurrent_vector<Checked> v;
+        v.emplace_back(0);
+
+        bool is_thrown = false;
+        try {
+            v.emplace_back(-1);
+        } catch(const std::runtime_error&) {
+            is_thrown = true;
+        }
+        CHECK(is_thrown);
+
+        // the elements after the dead slot are published
+        v.emplace_back(2);
+        CHECK(v.size() == 3);
+        CHECK(v.is_constructed(0) && !v.is_constructed(1) && v.is_constructed(2));
+        CHECK(v[2].value == 2);
+        CHECK(v.at(0).value == 0);
+
+        is_thrown = false;
+        try {
+            (void)v.at(1);
+        } catch(const std::out_of_range&) {
+            is_thrown = true;
+        }
+        CHECK(is_thrown);
+        CHECK(Checked::n_alive == 2);
+
+        // dead slot is reused as a normal one after clear()
+        v.clear();
+        CHECK(Checked::n_alive == 0);
+        v.emplace_back(5);
+        v.emplace_back(6);
+        CHECK(v.size() == 2 && v.is_constructed(1) && v[1].value == 6);
+    }
+    CHECK(Checked::n_alive == 0);
+}
+
+void test_concurrent_throwing_constructor() {
+    const int N_THREADS    = 4;
+    const int N_PER_THREAD = 20000;
+
+    {
+        nstd::concurrent_vector<Checked> v;
+        std::atomic<int> n_thrown(0);
+
+        nstd::vector<std::thread> threads;
+        for(int n_thread = 0; n_thread < N_THREADS; n_thread++) {
+            threads.push_back(std::thread([&, n_thread]{
+                for(int i = 0; i < N_PER_THREAD; i++) {
+                    int value = n_thread * N_PER_THREAD + i;
+                    try {
+                        v.emplace_back(value % 7 == 0 ? -1 : value);
+                    } catch(const std::runtime_error&) {
+                        n_thrown++;
+                    }
+                }
+            }));
+        }
+        for(size_t n_thread = 0; n_thread < threads.size(); n_thread++) threads[n_thread].join();
+
+        // nothing is hidden behind the dead slots
+        CHECK(v.size() == size_t(N_THREADS * N_PER_THREAD));
+
+        nstd::vector<bool> is_seen(N_THREADS * N_PER_THREAD, false);
+        size_t n_dead = 0;
+        for(size_t n_elem = 0; n_elem < v.size(); n_elem++) {
+            if(!v.is_constructed(n_elem)) {
+                n_dead++;
+                continue;
+            }
+            CHECK(!is_seen[v[n_elem].value]);
+            is_seen[v[n_elem].value] = true;
+        }
+        CHECK(n_dead == size_t(n_thrown));
+        CHECK(is_seen.count() == size_t(N_THREADS * N_PER_THREAD - n_thrown));
+        CHECK(Checked::n_alive == N_THREADS * N_PER_THREAD - n_thrown);
+    }
+    CHECK(Checked::n_alive == 0);
+}
+
+template<typename Vector>
+bool push_throws(Vector& v, int value) {
+    try {
+        v.emplace_back(value);
+    } catch(const std::bad_alloc&) {
+        return true;
+    }
+    return false;
+}
+
+void test_failing_allocation() {
+    // blocks of 16, 32, ... slots, the writer of the 8th slot allocates the second block in advance
+    {
+        nstd::concurrent_vector<Checked, failing_allocator> v;
+        for(int i = 0; i < 8; i++) v.emplace_back(i);
+
+        // allocation in advance fails, the block exists, so the slot is dead
+        n_failing_allocations = 1;
+        CHECK(push_throws(v, 8));
+        CHECK(v.size() == 9 && !v.is_constructed(8));
+
+        for(int i = 9; i < 16; i++) v.emplace_back(i);
+
+        // own block of the writer fails, the next writer installs it and publishes the abandoned slot
+        n_failing_allocations = 1;
+        CHECK(push_throws(v, 16));
+        CHECK(v.size() == 16);
+
+        v.emplace_back(17);
+        CHECK(v.size() == 18);
+        CHECK(!v.is_constructed(16) && v.is_constructed(17) && v[17].value == 17 && v[15].value == 15);
+        CHECK(Checked::n_alive == 16);
+    }
+    CHECK(Checked::n_alive == 0);
+
+    // abandoned slot, which block is never installed
+    {
+        nstd::concurrent_vector<Checked, failing_allocator> v;
+        for(int i = 0; i < 16; i++) {
+            if(i == 8) n_failing_allocations = 1;
+            CHECK(push_throws(v, i) == (i == 8));
+        }
+
+        n_failing_allocations = 1;
+        CHECK(push_throws(v, 16));
+        CHECK(v.size() == 16 && v.capacity() == 16);
+        CHECK(Checked::n_alive == 15);
+
+        v.clear();
+        CHECK(Checked::n_alive == 0);
+
+        for(int i = 0; i < 20; i++) v.emplace_back(i);
+        CHECK(v.size() == 20 && v.is_constructed(16) && v[19].value == 19);
+    }
+    CHECK(Checked::n_alive == 0);
+}
+
+void test_concurrent_failing_allocation() {
+    const int N_THREADS    = 4;
+    const int N_PER_THREAD = 20000;
+
+    {
+        nstd::concurrent_vector<Checked, failing_allocator> v;
+        std::atomic<int> n_thrown(0);
+
+        nstd::vector<std::thread> threads;
+        for(int n_thread = 0; n_thread < N_THREADS; n_thread++) {
+            threads.push_back(std::thread([&, n_thread]{
+                for(int i = 0; i < N_PER_THREAD; i++) {
+                    // the next block allocation fails, whoever does it
+                    if(n_thread == 0 && i % 1000 == 0) n_failing_allocations = 1;
+
+                    if(push_throws(v, n_thread * N_PER_THREAD + i)) n_thrown++;
+                }
+            }));
+        }
+        for(size_t n_thread = 0; n_thread < threads.size(); n_thread++) threads[n_thread].join();
+        n_failing_allocations = 0;
+
+        // nobody may have come to the block of the last abandoned slots, installing it publishes them
+        v.reserve(N_THREADS * N_PER_THREAD);
+        CHECK(v.size() == size_t(N_THREADS * N_PER_THREAD));
+
+        nstd::vector<bool> is_seen(N_THREADS * N_PER_THREAD, false);
+        size_t n_dead = 0;
+        for(size_t n_elem = 0; n_elem < v.size(); n_elem++) {
+            if(!v.is_constructed(n_elem)) {
+                n_dead++;
+                continue;
+            }
+            CHECK(!is_seen[v[n_elem].value]);
+            is_seen[v[n_elem].value] = true;
+        }
+        CHECK(n_dead == size_t(n_thrown));
+        CHECK(Checked::n_alive == N_THREADS * N_PER_THREAD - n_thrown);
+    }
+    CHECK(Checked::n_alive == 0);
+}
+
+int main() {
+    test_throwing_constructor();
+    test_concurrent_throwing_constructor();
+    test_failing_allocation();
+    test_concurrent_failing_allocation();
+
+    std::cout << (n_failed ? "concurrent_vector_test: FAILED\n" : "concurrent_vector_test: OK\n");
+    return n_failed;
+}
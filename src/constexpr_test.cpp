@@ -0,0 +1,135 @@
+#include <iostream>
+#include <array>
+#include "vector.hpp"
+
+// Constant evaluation of nstd::vector: every check is a static_assert, so the test fails to compile instead
+// of failing at run time. The same functions run at run time too, so both paths must agree
+
+/// non-trivial element: owns a vector, so copies, moves and destruction must all run in the constant evaluation
+struct word {
+    nstd::vector<char> chars;
+
+    constexpr word() = default;
+    constexpr word(const char* str) {
+        for(; *str; str++) chars.push_back(*str);
+    }
+
+    constexpr bool operator==(const char* str) const {
+        size_t i = 0;
+        for(; str[i]; i++) {
+            if(i >= chars.size() || chars[i] != str[i]) return false;
+        }
+        return i == chars.size();
+    }
+};
+
+constexpr nstd::vector<int> squares(int n_elems) {
+    nstd::vector<int> v;
+    for(int i = 0; i < n_elems; i++) v.push_back(i * i);
+    return v;
+}
+
+constexpr bool test_growth() {
+    nstd::vector<int> v = squares(100);
+    if(v.size() != 100 || v[99] != 99 * 99 || v.capacity() < 100) return false;
+
+    v.resize(200, 7);
+    v.resize(150);
+    v.shrink_to_fit();
+    if(v.size() != 150 || v.capacity() != 150 || v[149] != 7) return false;
+
+    v.reserve(1000);
+    if(v.capacity() < 1000 || v[10] != 100) return false;
+
+    v.clear();
+    return v.empty();
+}
+
+constexpr bool test_insert_erase() {
+    nstd::vector<int> v = squares(10);
+
+    v.insert(v.begin() + 2, -1);
+    v.insert(v.begin(), 3, -2);
+    v.erase(v.begin() + 5, v.begin() + 8);
+    if(v.size() != 11 || v[0] != -2 || v[2] != -2 || v[3] != 0 || v[4] != 1 || v[5] != 16) return false;
+
+    nstd::vector<int> other = squares(3);
+    v.insert(v.end(), other.begin(), other.end());
+    if(v.size() != 14 || v.back() != 4) return false;
+
+    // value from the vector itself
+    v.insert(v.begin(), v.back());
+    if(v.front() != 4 || v.size() != 15) return false;
+
+    if(v.erase_if([](int x) { return x < 0; }) != 3) return false;
+    if(v.pop_back() != 4 || v.size() != 11) return false;
+
+    v.emplace(v.begin() + 1, 42);
+    return v[1] == 42 && v[0] == 4 && v[2] == 0;
+}
+
+constexpr bool test_copy_move() {
+    nstd::vector<int> v = squares(20);
+    nstd::vector<int> copy(v);
+    nstd::vector<int> moved(nstd::move(v));
+    if(copy.size() != 20 || moved.size() != 20 || v.size() != 0) return false;
+
+    nstd::vector<int> assigned;
+    assigned = copy;
+    assigned.swap(moved);
+    v = nstd::move(assigned);
+    if(v.size() != 20 || moved.size() != 20 || v[19] != 361) return false;
+
+    nstd::vector<int> from_range(copy.begin() + 5, copy.end());
+    return from_range.size() == 15 && from_range[0] == 25;
+}
+
+constexpr bool test_iterators() {
+    // arithmetic on the null pointer of the empty vector would not be a constant expression
+    nstd::vector<int> empty;
+    if(empty.rbegin() != empty.rend() || empty.begin() != empty.end()) return false;
+
+    nstd::vector<int> v = squares(5);
+
+    int n_elem = 4;
+    for(auto it = v.rbegin(); it != v.rend(); ++it, n_elem--) {
+        if(*it != n_elem * n_elem) return false;
+    }
+    for(int& x : v) x++;
+
+    return n_elem == -1 && v[4] == 17 && *v.crbegin() == 17 && v.rbegin()[4] == 1;
+}
+
+constexpr bool test_non_trivial() {
+    nstd::vector<word> words;
+    words.push_back("alpha");
+    words.emplace_back("beta");
+    words.insert(words.begin(), word("gamma"));
+    for(int i = 0; i < 20; i++) words.push_back("x");
+
+    words.erase(words.begin() + 3, words.end());
+    nstd::vector<word> copy = words;
+    words.resize(1);
+
+    return words.size() == 1 && words[0] == "gamma" && copy.size() == 3 && copy[1] == "alpha" && copy[2] == "beta";
+}
+
+static_assert(test_growth());
+static_assert(test_insert_erase());
+static_assert(test_copy_move());
+static_assert(test_iterators());
+static_assert(test_non_trivial());
+
+// table computed by the compiler, the heap memory of the vector doesn't leave the constant evaluation
+static constexpr auto SQUARES = nstd::to_static_array([]{ return squares(16); });
+
+static_assert(SQUARES.size() == 16);
+static_assert(SQUARES[0] == 0 && SQUARES[15] == 225);
+static_assert(std::is_same_v<decltype(SQUARES), const std::array<int, 16>>);
+
+int main() {
+    int n_failed = !test_growth() + !test_insert_erase() + !test_copy_move() + !test_iterators() + !test_non_trivial();
+
+    std::cout << (n_failed ? "constexpr_test: FAILED\n" : "constexpr_test: OK\n");
+    return n_failed;
+}
@@ -0,0 +1,85 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <unordered_map>
+#include <stdint.h>
+#include <stdlib.h>
+#include "flat_hash_map.hpp"
+
+// flat_hash_map against std::unordered_map with 1K, 1M and 16M uint64_t keys (arguments override the sizes):
+// inserts into an empty map, random lookups of present and absent keys, a full scan and erasure of every key.
+// Cells are ns per operation
+
+static const size_t N_LOOKUPS = 10000000;
+
+/// bijection on uint64_t (splitmix64 finalizer), so mix(0..n) are n different keys in random order
+static uint64_t mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+template<typename TFunc>
+double ns_per(size_t n_ops, TFunc func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n_ops;
+}
+
+/// lookups of i-th random key: even i are present, odd ones are not
+template<typename Map>
+void run(const char* name, size_t n_keys) {
+    volatile uint64_t sink = 0;
+    Map map;
+
+    double insert_ns = ns_per(n_keys, [&]{
+        for(size_t i = 0; i < n_keys; i++) map[mix(i)] = i;
+    });
+
+    uint64_t rng = 88172645463325252ull;
+    double lookup_ns = ns_per(N_LOOKUPS, [&]{
+        uint64_t sum = 0;
+        for(size_t i = 0; i < N_LOOKUPS; i++) {
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+
+            auto it = map.find(mix(rng % n_keys + (i & 1) * n_keys));
+            if(it != map.end()) sum += (*it).second;
+        }
+        sink = sum;
+    });
+
+    double scan_ns = ns_per(n_keys, [&]{
+        uint64_t sum = 0;
+        for(auto it = map.begin(); it != map.end(); ++it) sum += (*it).second;
+        sink = sum;
+    });
+
+    double erase_ns = ns_per(n_keys, [&]{
+        for(size_t i = 0; i < n_keys; i++) map.erase(mix(i));
+    });
+
+    std::cout << std::left << std::setw(12) << n_keys << std::setw(20) << name << std::right << std::fixed
+              << std::setprecision(1) << std::setw(10) << insert_ns << std::setw(10) << lookup_ns
+              << std::setw(10) << scan_ns << std::setw(10) << erase_ns << "\n";
+    (void)sink;
+}
+
+int main(int argc, char** argv) {
+    size_t default_sizes[] = {1000, 1000000, 16000000};
+
+    std::cout << N_LOOKUPS << " lookups, half of them miss, ns\n";
+    std::cout << std::left << std::setw(12) << "keys" << std::setw(20) << "map" << std::right << std::setw(10) << "insert"
+              << std::setw(10) << "lookup" << std::setw(10) << "scan" << std::setw(10) << "erase" << "\n";
+
+    int n_sizes = argc > 1 ? argc - 1 : 3;
+    for(int n_size = 0; n_size < n_sizes; n_size++) {
+        size_t n_keys = argc > 1 ? strtoull(argv[n_size + 1], NULL, 10) : default_sizes[n_size];
+
+        run<nstd::flat_hash_map<uint64_t, uint64_t>>("flat_hash_map", n_keys);
+        run<std::unordered_map<uint64_t, uint64_t>>("std::unordered_map", n_keys);
+    }
+
+    return 0;
+}
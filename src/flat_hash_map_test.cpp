@@ -0,0 +1,163 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "flat_hash_map.hpp"
+
+// Random operations on flat_hash_map repeated on std::unordered_map, contents must agree after every step.
+// Weak hashes put keys in long clusters, which wrap around the table, to exercise the backward shift of erase.
+// Exit code is the number of failed checks
+
+static int n_failed = 0;
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if(!(cond)) {                                                               \
+            std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #cond "\n";    \
+            n_failed++;                                                             \
+        }                                                                           \
+    } while(0)
+
+/// every key in one of 4 homes
+struct clustered_hash {
+    size_t operator()(int key) const
+    { return size_t(key & 3); }
+};
+
+/// one home and one h2 for all keys: the whole map is a single cluster, every probe compares keys
+struct constant_hash {
+    size_t operator()(int) const
+    { return 0; }
+};
+
+template<typename Map, typename Ref>
+bool same_map(const Map& map, const Ref& ref) {
+    if(map.size() != ref.size()) return false;
+
+    // iteration visits every element once
+    size_t n_visited = 0;
+    for(auto it = map.begin(); it != map.end(); ++it, n_visited++) {
+        auto ref_it = ref.find((*it).first);
+        if(ref_it == ref.end() || !(ref_it->second == (*it).second)) return false;
+    }
+    if(n_visited != ref.size()) return false;
+
+    for(const auto& pair : ref) {
+        auto it = map.find(pair.first);
+        if(it == map.end() || !((*it).second == pair.second)) return false;
+    }
+    return true;
+}
+
+template<typename Hash>
+void check_against_std(unsigned seed, int n_keys) {
+    typedef nstd::flat_hash_map<int, std::string, Hash> map_t;
+
+    std::mt19937 rng(seed);
+    map_t map;
+    std::unordered_map<int, std::string> ref;
+
+    for(int step = 0; step < 20000; step++) {
+        int key = int(rng() % n_keys);
+        std::string value = std::to_string(rng() % 1000);
+
+        switch(rng() % 10) {
+        case 0:
+        case 1: {
+            auto result = map.insert({key, value});
+            auto ref_result = ref.insert({key, value});
+            CHECK(result.second == ref_result.second && (*result.first).second == ref_result.first->second);
+            break;
+        }
+        case 2:
+            CHECK(map.try_emplace(key, value).second == ref.try_emplace(key, value).second);
+            break;
+        case 3:
+            CHECK(map.insert_or_assign(key, value).second == ref.insert_or_assign(key, value).second);
+            break;
+        case 4:
+            map[key] += value;
+            ref[key] += value;
+            break;
+        case 5:
+        case 6:
+            CHECK(map.erase(key) == ref.erase(key));
+            break;
+        case 7: {
+            auto it = map.find(key);
+            auto ref_it = ref.find(key);
+            CHECK((it == map.end()) == (ref_it == ref.end()) && map.contains(key) == (ref_it != ref.end()));
+            if(ref_it != ref.end()) {
+                CHECK(map.at(key) == ref_it->second);
+                map.erase(it);
+                ref.erase(ref_it);
+            }
+            break;
+        }
+        case 8:
+            if(rng() % 20 == 0) {
+                int divisor = int(rng() % 5) + 2;
+                size_t n_erased = map.erase_if([&](std::pair<const int&, std::string&> pair) { return pair.first % divisor == 0; });
+                CHECK(n_erased == std::erase_if(ref, [&](const auto& pair) { return pair.first % divisor == 0; }));
+            }
+            break;
+        case 9:
+            if(rng() % 50 == 0) {
+                // copies, moves and swaps keep the contents
+                map_t copy = map;
+                map_t other;
+                other.swap(copy);
+                map = nstd::move(other);
+                CHECK(other.empty());
+            }
+            else if(rng() % 50 == 0) {
+                map.clear();
+                ref.clear();
+            }
+            break;
+        }
+
+        if(!same_map(map, ref)) {
+            CHECK(same_map(map, ref));
+            return;
+        }
+        CHECK(map.size() <= map.capacity() * map_t::MAX_LOAD_NUM / map_t::MAX_LOAD_DEN);
+    }
+
+    map_t from_pairs(ref.begin(), ref.end());
+    CHECK(same_map(from_pairs, ref));
+}
+
+void test_reserve() {
+    nstd::flat_hash_map<int, int> map;
+    map.reserve(1000);
+    size_t capacity = map.capacity();
+
+    for(int i = 0; i < 1000; i++) map[i] = i;
+    CHECK(map.capacity() == capacity && map.size() == 1000);
+
+    CHECK(nstd::erase_if(map, [](std::pair<const int&, int&> pair) { return pair.second >= 10; }) == 990);
+    CHECK(map.size() == 10 && map.at(9) == 9 && !map.contains(10));
+
+    bool is_thrown = false;
+    try {
+        map.at(10);
+    } catch(const std::out_of_range&) {
+        is_thrown = true;
+    }
+    CHECK(is_thrown);
+}
+
+int main() {
+    check_against_std<std::hash<int>>(1, 500);
+    check_against_std<std::hash<int>>(2, 5000);
+    check_against_std<clustered_hash>(3, 200);
+    check_against_std<constant_hash>(4, 100);
+    test_reserve();
+
+    std::cout << (n_failed ? "flat_hash_map_test: FAILED\n" : "flat_hash_map_test: OK\n");
+    return n_failed;
+}
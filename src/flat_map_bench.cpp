@@ -0,0 +1,122 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <map>
+#include <iterator>
+#include <utility>
+#include <type_traits>
+#include <stdint.h>
+#include <stdlib.h>
+#include "flat_map.hpp"
+
+// flat_map against std::map with 1K, 1M and 100M uint64_t keys (arguments override the sizes): bulk build from
+// unsorted pairs, random lookups of present and absent keys, and a full scan. Cells are ns per key or lookup.
+// std::map is skipped past MAX_STD_MAP_KEYS, where its nodes would not fit in the memory of a small machine
+
+static const size_t N_LOOKUPS        = 10000000;
+static const size_t MAX_STD_MAP_KEYS = 1 << 25;
+
+/// bijection on uint64_t (splitmix64 finalizer), so mix(0..n) are n different keys in random order
+static uint64_t mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+/// pairs (mix(i), i) generated on the fly, so the input doesn't take memory next to the containers
+struct mixed_pairs {
+    typedef std::input_iterator_tag             iterator_category;
+    typedef std::pair<uint64_t, uint64_t>       value_type;
+    typedef ptrdiff_t                           difference_type;
+    typedef const value_type*                   pointer;
+    typedef const value_type&                   reference;
+
+    uint64_t   n_pair;
+    value_type pair;
+
+    explicit mixed_pairs(uint64_t n_pair_):
+        n_pair(n_pair_),
+        pair(mix(n_pair_), n_pair_){}
+
+    reference operator *() const
+    { return pair; }
+
+    pointer operator ->() const
+    { return &pair; }
+
+    mixed_pairs& operator ++() {
+        n_pair++;
+        pair = value_type(mix(n_pair), n_pair);
+        return *this;
+    }
+
+    bool operator ==(const mixed_pairs& other) const
+    { return n_pair == other.n_pair; }
+
+    bool operator !=(const mixed_pairs& other) const
+    { return n_pair != other.n_pair; }
+};
+
+template<typename TFunc>
+double ns_per(size_t n_ops, TFunc func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n_ops;
+}
+
+/// lookups of i-th random key: even i are present, odd ones are past the inserted range
+template<typename Map>
+void run(const char* name, size_t n_keys) {
+    volatile uint64_t sink = 0;
+    Map map;
+
+    double build_ns = ns_per(n_keys, [&]{
+        if constexpr(std::is_same_v<Map, std::map<uint64_t, uint64_t>>) map.insert(mixed_pairs(0), mixed_pairs(n_keys));
+        else                                                             map.insert_range(mixed_pairs(0), mixed_pairs(n_keys));
+    });
+
+    uint64_t rng = 88172645463325252ull;
+    double lookup_ns = ns_per(N_LOOKUPS, [&]{
+        uint64_t sum = 0;
+        for(size_t i = 0; i < N_LOOKUPS; i++) {
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+
+            uint64_t n_key = rng % n_keys + (i & 1) * n_keys;
+            auto it = map.find(mix(n_key));
+            if(it != map.end()) sum += (*it).second;
+        }
+        sink = sum;
+    });
+
+    double scan_ns = ns_per(n_keys, [&]{
+        uint64_t sum = 0;
+        for(auto it = map.begin(); it != map.end(); ++it) sum += (*it).second;
+        sink = sum;
+    });
+
+    std::cout << std::left << std::setw(12) << n_keys << std::setw(12) << name << std::right << std::fixed
+              << std::setprecision(1) << std::setw(12) << build_ns << std::setw(12) << lookup_ns
+              << std::setw(12) << scan_ns << "\n";
+    (void)sink;
+}
+
+int main(int argc, char** argv) {
+    size_t default_sizes[] = {1000, 1000000, 100000000};
+
+    std::cout << N_LOOKUPS << " lookups, half of them miss, ns\n";
+    std::cout << std::left << std::setw(12) << "keys" << std::setw(12) << "map" << std::right << std::setw(12) << "build/key"
+              << std::setw(12) << "lookup" << std::setw(12) << "scan/key" << "\n";
+
+    int n_sizes = argc > 1 ? argc - 1 : 3;
+    for(int n_size = 0; n_size < n_sizes; n_size++) {
+        size_t n_keys = argc > 1 ? strtoull(argv[n_size + 1], NULL, 10) : default_sizes[n_size];
+
+        run<nstd::flat_map<uint64_t, uint64_t>>("flat_map", n_keys);
+        if(n_keys <= MAX_STD_MAP_KEYS) run<std::map<uint64_t, uint64_t>>("std::map", n_keys);
+        else                           std::cout << std::left << std::setw(12) << n_keys << "std::map    skipped\n";
+    }
+
+    return 0;
+}
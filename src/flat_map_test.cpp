@@ -0,0 +1,225 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <map>
+#include <set>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "flat_map.hpp"
+#include "flat_set.hpp"
+
+// Random operations on flat_map and flat_set repeated on std::map and std::set, contents and lookups
+// must agree after every step. Exit code is the number of failed checks
+
+static int n_failed = 0;
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if(!(cond)) {                                                               \
+            std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #cond "\n";    \
+            n_failed++;                                                             \
+        }                                                                           \
+    } while(0)
+
+template<typename Map, typename Ref>
+bool same_map(const Map& map, const Ref& ref) {
+    if(map.size() != ref.size()) return false;
+
+    auto it = map.begin();
+    for(const auto& pair : ref) {
+        if(!((*it).first == pair.first) || !((*it).second == pair.second)) return false;
+        ++it;
+    }
+    return it == map.end();
+}
+
+template<typename Set, typename Ref>
+bool same_set(const Set& set, const Ref& ref) {
+    if(set.size() != ref.size()) return false;
+
+    auto it = set.begin();
+    for(const auto& key : ref) {
+        if(!(*it == key)) return false;
+        ++it;
+    }
+    return it == set.end();
+}
+
+/// key_of(n) maps random numbers to keys, so the same run covers numbers (the branchless search) and strings
+template<typename K, typename Compare, typename KeyOf>
+void check_map(KeyOf key_of, unsigned seed) {
+    std::mt19937 rng(seed);
+    nstd::flat_map<K, int, Compare> map;
+    std::map<K, int, Compare> ref;
+
+    for(int step = 0; step < 20000; step++) {
+        K key = key_of(rng() % 500);
+        int value = int(rng() % 1000);
+
+        switch(rng() % 9) {
+        case 0: {
+            auto result = map.insert({key, value});
+            auto ref_result = ref.insert({key, value});
+            CHECK(result.second == ref_result.second && (*result.first).second == ref_result.first->second);
+            break;
+        }
+        case 1: {
+            auto result = map.try_emplace(key, value);
+            CHECK(result.second == ref.try_emplace(key, value).second);
+            break;
+        }
+        case 2: {
+            auto result = map.insert_or_assign(key, value);
+            CHECK(result.second == ref.insert_or_assign(key, value).second && (*result.first).second == value);
+            break;
+        }
+        case 3:
+            map[key] += value;
+            ref[key] += value;
+            break;
+        case 4:
+            CHECK(map.erase(key) == ref.erase(key));
+            break;
+        case 5:
+            if(!ref.empty()) {
+                auto it = map.lower_bound(key);
+                auto ref_it = ref.lower_bound(key);
+                if(ref_it == ref.end()) {
+                    CHECK(it == map.end());
+                }
+                else {
+                    CHECK((*it).first == ref_it->first);
+                    it = map.erase(it);
+                    ref_it = ref.erase(ref_it);
+                    CHECK((it == map.end()) == (ref_it == ref.end()));
+                }
+            }
+            break;
+        case 6: {
+            // bulk insertion with repeated keys, the first one of equal keys is kept as by std::map
+            std::vector<std::pair<K, int>> pairs;
+            for(int n_pair = int(rng() % 20); n_pair > 0; n_pair--) {
+                pairs.push_back({key_of(rng() % 500), int(rng() % 1000)});
+            }
+            map.insert_range(pairs.begin(), pairs.end());
+            ref.insert(pairs.begin(), pairs.end());
+            break;
+        }
+        case 7: {
+            CHECK(map.contains(key) == (ref.count(key) == 1));
+            auto it = map.find(key);
+            auto ref_it = ref.find(key);
+            CHECK((it == map.end()) == (ref_it == ref.end()));
+            if(ref_it != ref.end()) CHECK((*it).second == ref_it->second && map.at(key) == ref.at(key));
+
+            auto upper = map.upper_bound(key);
+            auto ref_upper = ref.upper_bound(key);
+            CHECK(upper - map.begin() == std::distance(ref.begin(), ref_upper));
+            break;
+        }
+        case 8:
+            if(rng() % 100 == 0) {
+                map.clear();
+                ref.clear();
+            }
+            break;
+        }
+
+        if(!same_map(map, ref)) {
+            CHECK(same_map(map, ref));
+            return;
+        }
+    }
+
+    // construction from the map's own columns
+    nstd::flat_map<K, int, Compare> copy(nstd::sorted_unique, map.keys(), map.values());
+    CHECK(same_map(copy, ref));
+
+    nstd::flat_map<K, int, Compare> from_pairs(ref.begin(), ref.end());
+    CHECK(same_map(from_pairs, ref));
+}
+
+template<typename K, typename Compare, typename KeyOf>
+void check_set(KeyOf key_of, unsigned seed) {
+    std::mt19937 rng(seed);
+    nstd::flat_set<K, Compare> set;
+    std::set<K, Compare> ref;
+
+    for(int step = 0; step < 20000; step++) {
+        K key = key_of(rng() % 500);
+
+        switch(rng() % 7) {
+        case 0:
+        case 1: {
+            auto result = set.insert(key);
+            CHECK(result.second == ref.insert(key).second && *result.first == key);
+            break;
+        }
+        case 2:
+            CHECK(set.erase(key) == ref.erase(key));
+            break;
+        case 3: {
+            std::vector<K> keys;
+            for(int n_key = int(rng() % 20); n_key > 0; n_key--) keys.push_back(key_of(rng() % 500));
+            set.insert_range(keys.begin(), keys.end());
+            ref.insert(keys.begin(), keys.end());
+            break;
+        }
+        case 4: {
+            CHECK(set.contains(key) == (ref.count(key) == 1));
+            CHECK(set.lower_bound(key) - set.begin() == std::distance(ref.begin(), ref.lower_bound(key)));
+            CHECK(set.upper_bound(key) - set.begin() == std::distance(ref.begin(), ref.upper_bound(key)));
+            break;
+        }
+        case 5: {
+            auto it = set.find(key);
+            auto ref_it = ref.find(key);
+            CHECK((it == set.end()) == (ref_it == ref.end()));
+            if(ref_it != ref.end()) {
+                set.erase(it);
+                ref.erase(ref_it);
+            }
+            break;
+        }
+        case 6:
+            if(rng() % 50 == 0) {
+                K pivot = key_of(rng() % 500);
+                Compare comp;
+                set.erase_if([&](const K& k) { return comp(k, pivot); });
+                std::erase_if(ref, [&](const K& k) { return comp(k, pivot); });
+            }
+            break;
+        }
+
+        if(!same_set(set, ref)) {
+            CHECK(same_set(set, ref));
+            return;
+        }
+    }
+
+    nstd::flat_set<K, Compare> copy(nstd::sorted_unique, set.keys());
+    CHECK(same_set(copy, ref));
+
+    nstd::vector<K> keys = set.extract();
+    CHECK(set.empty() && keys.size() == ref.size());
+
+    nstd::flat_set<K, Compare> unsorted(keys.crbegin(), keys.crend());
+    CHECK(same_set(unsorted, ref));
+}
+
+int main() {
+    auto int_key    = [](unsigned n) { return int(n) - 250; };
+    auto string_key = [](unsigned n) { return std::to_string(n * 7919); };
+
+    check_map<int, std::less<int>>(int_key, 1);
+    check_map<int, std::greater<int>>(int_key, 2);
+    check_map<std::string, std::less<std::string>>(string_key, 3);
+
+    check_set<int, std::less<int>>(int_key, 4);
+    check_set<int, std::greater<int>>(int_key, 5);
+    check_set<std::string, std::less<std::string>>(string_key, 6);
+
+    std::cout << (n_failed ? "flat_map_test: FAILED\n" : "flat_map_test: OK\n");
+    return n_failed;
+}
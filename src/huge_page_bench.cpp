@@ -0,0 +1,96 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "allocator.hpp"
+#include "vector.hpp"
+
+// Random reads over a vector of 8 GB (the first argument overrides the size in MB) with std::allocator
+// and HugePageAllocator. dTLB load misses are read from perf_event_open, "n/a" is printed if the kernel
+// doesn't give the counter (perf_event_paranoid, virtual machines)
+
+static const size_t N_READS = 50000000;
+
+/// dTLB load miss counter of this thread, fd is -1 if it isn't available
+struct dtlb_counter {
+    int fd;
+
+    dtlb_counter() {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.type           = PERF_TYPE_HW_CACHE;
+        attr.config         = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled       = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+
+        fd = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    ~dtlb_counter() {
+        if(fd >= 0) close(fd);
+    }
+
+    void start() {
+        if(fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    /// number of misses since start(), -1 if unknown
+    long long stop() {
+        if(fd < 0) return -1;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+        long long n_misses = 0;
+        return read(fd, &n_misses, sizeof(n_misses)) == sizeof(n_misses) ? n_misses : -1;
+    }
+};
+
+template<template <typename> class Alloc>
+void run(const char* name, size_t n_elems) {
+    nstd::vector<uint64_t, Alloc> v;
+    v.resize_default_init(n_elems);
+    for(size_t i = 0; i < n_elems; i++) v[i] = i;
+
+    dtlb_counter counter;
+    uint64_t rng = 88172645463325252ull, sum = 0;
+
+    counter.start();
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < N_READS; i++) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        sum += v[rng % n_elems];
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    long long n_misses = counter.stop();
+
+    std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << ms << std::setw(16);
+    if(n_misses >= 0) std::cout << n_misses << std::setw(14) << std::setprecision(3) << double(n_misses) / N_READS;
+    else              std::cout << "n/a" << std::setw(14) << "n/a";
+    std::cout << "    (checksum " << sum % 1000 << ")\n";
+}
+
+int main(int argc, char** argv) {
+    size_t n_mb    = argc > 1 ? strtoull(argv[1], NULL, 10) : 8192;
+    size_t n_elems = n_mb * (1 << 20) / sizeof(uint64_t);
+
+    std::cout << N_READS << " random reads over " << n_mb << " MB\n";
+    std::cout << std::left << std::setw(20) << "allocator" << std::right << std::setw(10) << "ms"
+              << std::setw(16) << "dTLB misses" << std::setw(14) << "per read" << "\n";
+
+    run<std::allocator>("std::allocator", n_elems);
+    run<nstd::HugePageAllocator>("HugePageAllocator", n_elems);
+
+    return 0;
+}
@@ -0,0 +1,234 @@
+#include <iostream>
+#include <sstream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "inplace_vector.hpp"
+#include "vector.hpp"
+
+// Behaviour checks of inplace_vector against std::vector, exit code is the number of failed ones
+
+static int n_failed = 0;
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if(!(cond)) {                                                               \
+            std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #cond "\n";    \
+            n_failed++;                                                             \
+        }                                                                           \
+    } while(0)
+
+#define CHECK_THROWS(expr, Exception)                                               \
+    do {                                                                            \
+        bool thrown = false;                                                        \
+        try { expr; } catch(const Exception&) { thrown = true; }                    \
+        if(!thrown) {                                                               \
+            std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #expr          \
+                      << " doesn't throw " #Exception "\n";                         \
+            n_failed++;                                                             \
+        }                                                                           \
+    } while(0)
+
+/// counts live objects, copy constructor throws after n_copies_left copies
+struct Tracked {
+    static int n_alive;
+    static int n_copies_left;
+
+    int value;
+
+    Tracked(int value_ = 0): value(value_) { n_alive++; }
+    Tracked(const Tracked& other): value(other.value) {
+        if(n_copies_left-- == 0) throw std::runtime_error("copy");
+        n_alive++;
+    }
+    Tracked(Tracked&& other): value(other.value) { n_alive++; }
+    Tracked& operator=(const Tracked& other) { value = other.value; return *this; }
+    Tracked& operator=(Tracked&& other) { value = other.value; return *this; }
+    ~Tracked() { n_alive--; }
+};
+
+int Tracked::n_alive       = 0;
+int Tracked::n_copies_left = -1;
+
+struct pod { int a; double b; };
+
+static_assert(std::is_trivially_copyable_v<nstd::inplace_vector<pod, 16>>);
+static_assert(!std::is_trivially_copyable_v<nstd::inplace_vector<Tracked, 16>>);
+
+template<typename V, typename Ref>
+bool equal(V& v, const Ref& ref) {
+    if(v.size() != ref.size()) return false;
+    for(size_t i = 0; i < ref.size(); i++) {
+        if(v[i] != ref[i]) return false;
+    }
+    return true;
+}
+
+static void test_capacity() {
+    nstd::inplace_vector<int, 4> v;
+    CHECK(v.empty() && v.capacity() == 4);
+
+    v.push_back(1);
+    v.unchecked_push_back(2);
+    CHECK(v.try_push_back(3) != NULL && *v.try_emplace_back(4) == 4);
+    CHECK(v.size() == 4 && v[3] == 4);
+
+    CHECK(v.try_push_back(5) == NULL);
+    CHECK_THROWS(v.push_back(5), std::length_error);
+    CHECK_THROWS(v.insert(v.begin(), 5), std::length_error);
+    CHECK_THROWS(v.resize(5), std::length_error);
+    CHECK_THROWS(v.reserve(5), std::length_error);
+    CHECK(v.size() == 4 && v.back() == 4);
+
+    CHECK_THROWS((nstd::inplace_vector<int, 4>(5)), std::length_error);
+    CHECK_THROWS(v.at(4), std::out_of_range);
+
+    v.clear();
+    CHECK_THROWS(v.pop_back(), std::out_of_range);
+}
+
+static void test_ranges() {
+    int array[] = {1, 2, 3, 4, 5};
+
+    nstd::inplace_vector<int, 8> from_pointers(array, array + 5);
+    CHECK(from_pointers.size() == 5 && from_pointers[4] == 5);
+
+    // same element type, copied as an array
+    nstd::inplace_vector<int, 8> from_iterators(from_pointers.begin() + 1, from_pointers.end());
+    CHECK(from_iterators.size() == 4 && from_iterators[0] == 2);
+
+    // other element type, converted one by one
+    nstd::inplace_vector<long, 8> converted(from_pointers.cbegin(), from_pointers.cend());
+    CHECK(converted.size() == 5 && converted[2] == 3);
+
+    nstd::vector<int> source(array, array + 5);
+    nstd::inplace_vector<int, 8> from_vector(source.begin(), source.end());
+    CHECK(equal(from_vector, source));
+
+    std::istringstream in("7 8 9");
+    nstd::inplace_vector<int, 16> from_stream((std::istream_iterator<int>(in)), std::istream_iterator<int>());
+    CHECK(from_stream.size() == 3 && from_stream[0] == 7 && from_stream[2] == 9);
+
+    std::istringstream more("10 11");
+    from_stream.insert(from_stream.begin() + 1, std::istream_iterator<int>(more), std::istream_iterator<int>());
+    CHECK(from_stream.size() == 5 && from_stream[1] == 10 && from_stream[2] == 11 && from_stream[3] == 8);
+
+    std::istringstream too_many("1 2 3 4 5 6 7 8 9");
+    CHECK_THROWS((nstd::inplace_vector<int, 8>(std::istream_iterator<int>(too_many), std::istream_iterator<int>())),
+                 std::length_error);
+
+    from_stream.append_range(source);
+    CHECK(from_stream.size() == 10 && from_stream[5] == 1 && from_stream.back() == 5);
+}
+
+static void test_against_std() {
+    std::mt19937 rng(7);
+    nstd::inplace_vector<int, 64> v;
+    std::vector<int> ref;
+
+    for(int step = 0; step < 20000; step++) {
+        int value = int(rng() % 1000);
+        size_t pos = ref.empty() ? 0 : rng() % (ref.size() + 1);
+
+        switch(rng() % 6) {
+        case 0:
+            if(ref.size() < 64) { v.push_back(value); ref.push_back(value); }
+            break;
+        case 1:
+            if(ref.size() < 64) { v.insert(v.begin() + pos, value); ref.insert(ref.begin() + pos, value); }
+            break;
+        case 2: {
+            size_t count = rng() % 4;
+            if(ref.size() + count <= 64) {
+                v.insert(v.begin() + pos, count, value);
+                ref.insert(ref.begin() + pos, count, value);
+            }
+            break;
+        }
+        case 3:
+            if(pos < ref.size()) {
+                size_t last = pos + rng() % (ref.size() - pos + 1);
+                v.erase(v.begin() + pos, v.begin() + last);
+                ref.erase(ref.begin() + pos, ref.begin() + last);
+            }
+            break;
+        case 4:
+            if(!ref.empty()) { CHECK(v.pop_back() == ref.back()); ref.pop_back(); }
+            break;
+        case 5:
+            if(ref.size() < 64 && !ref.empty()) {
+                // value from the vector itself
+                v.emplace(v.begin() + pos, v[0]);
+                ref.insert(ref.begin() + pos, ref[0]);
+            }
+            break;
+        }
+
+        if(!equal(v, ref)) {
+            CHECK(equal(v, ref));
+            return;
+        }
+    }
+}
+
+static void test_copy_move() {
+    {
+        nstd::inplace_vector<Tracked, 8> v;
+        for(int i = 0; i < 5; i++) v.emplace_back(i);
+
+        nstd::inplace_vector<Tracked, 8> copy(v);
+        nstd::inplace_vector<Tracked, 8> moved(nstd::move(v));
+        CHECK(copy.size() == 5 && moved.size() == 5 && v.empty() && moved[4].value == 4);
+
+        nstd::inplace_vector<Tracked, 8> other;
+        other.emplace_back(42);
+        other.swap(copy);
+        CHECK(other.size() == 5 && copy.size() == 1 && copy[0].value == 42 && other[1].value == 1);
+
+        copy = other;
+        v = nstd::move(other);
+        CHECK(copy.size() == 5 && v.size() == 5 && other.empty());
+        CHECK(Tracked::n_alive == 15);
+    }
+    CHECK(Tracked::n_alive == 0);
+
+    nstd::inplace_vector<pod, 4> pods;
+    pods.push_back({1, 2.5});
+    nstd::inplace_vector<pod, 4> pods_copy = pods;
+    CHECK(pods_copy.size() == 1 && pods_copy[0].b == 2.5);
+}
+
+static void test_exception_safety() {
+    {
+        nstd::inplace_vector<Tracked, 16> v;
+        for(int i = 0; i < 4; i++) v.emplace_back(i);
+
+        Tracked::n_copies_left = 2;
+        CHECK_THROWS(v.insert(v.begin() + 1, 5, Tracked(9)), std::runtime_error);
+        CHECK(v.size() == 4 && v[1].value == 1 && v[3].value == 3);
+
+        Tracked values[] = {10, 11, 12};
+        Tracked::n_copies_left = 1;
+        CHECK_THROWS(v.insert(v.begin(), values, values + 3), std::runtime_error);
+        CHECK(v.size() == 4 && v[0].value == 0);
+
+        Tracked::n_copies_left = 2;
+        CHECK_THROWS((nstd::inplace_vector<Tracked, 16>(v.begin(), v.end())), std::runtime_error);
+
+        Tracked::n_copies_left = -1;
+        CHECK(Tracked::n_alive == 4 + 3);
+    }
+    CHECK(Tracked::n_alive == 0);
+}
+
+int main() {
+    test_capacity();
+    test_ranges();
+    test_against_std();
+    test_copy_move();
+    test_exception_safety();
+
+    std::cout << (n_failed ? "inplace_vector_test: FAILED\n" : "inplace_vector_test: OK\n");
+    return n_failed;
+}
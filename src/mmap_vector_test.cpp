@@ -0,0 +1,174 @@
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+#include <string>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "mmap_vector.hpp"
+
+// Behaviour checks of mmap_vector on files in a temporary directory, exit code is the number of failed ones
+
+static int n_failed = 0;
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if(!(cond)) {                                                               \
+            std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #cond "\n";    \
+            n_failed++;                                                             \
+        }                                                                           \
+    } while(0)
+
+#define CHECK_THROWS(expr, exception)                                               \
+    do {                                                                            \
+        bool is_thrown = false;                                                     \
+        try {                                                                       \
+            expr;                                                                   \
+        } catch(const exception&) {                                                 \
+            is_thrown = true;                                                       \
+        }                                                                           \
+        CHECK(is_thrown && #expr);                                                  \
+    } while(0)
+
+struct point {
+    int    id;
+    double x;
+};
+
+static std::string dir;
+
+static std::string path(const char* name)
+{ return dir + "/" + name; }
+
+static size_t file_size(const std::string& path) {
+    struct stat st = {};
+    stat(path.c_str(), &st);
+    return st.st_size;
+}
+
+void test_reopen() {
+    {
+        nstd::mmap_vector<point> v(path("points").c_str(), nstd::MMAP_CREATE);
+        CHECK(v.empty() && !v.is_read_only());
+
+        for(int i = 0; i < 100000; i++) v.push_back(point{i, i * 0.5});
+        // source inside the mapping, which moves on growth
+        v.append(v.data(), 1000);
+        v.push_back(v[5]);
+        v.sync();
+    }
+    {
+        nstd::mmap_vector<point> v(path("points").c_str());
+        CHECK(v.size() == 101001);
+
+        bool is_equal = true;
+        for(int i = 0; i < 100000; i++) is_equal = is_equal && v[i].id == i && v[i].x == i * 0.5;
+        for(int i = 0; i < 1000; i++) is_equal = is_equal && v[100000 + i].id == i;
+        CHECK(is_equal);
+        CHECK(v.back().id == 5);
+
+        // changes of the reopened vector are kept too
+        v.pop_back();
+        v.resize(101010);
+        CHECK(v[101009].id == 0 && v[101009].x == 0);
+        v.resize(101020, point{-1, -1});
+        CHECK(v[101019].id == -1 && v[101000].id == 0);
+    }
+    {
+        nstd::mmap_vector<point> v(path("points").c_str());
+        CHECK(v.size() == 101020 && v[101019].id == -1 && v[99999].id == 99999);
+
+        size_t n_elems = 0;
+        for(auto it = v.rbegin(); it != v.rend(); ++it) n_elems++;
+        CHECK(n_elems == v.size());
+    }
+
+    // create truncates
+    nstd::mmap_vector<point> v(path("points").c_str(), nstd::MMAP_CREATE);
+    CHECK(v.size() == 0);
+}
+
+void test_read_only() {
+    {
+        nstd::mmap_vector<int> v(path("ints").c_str(), nstd::MMAP_CREATE);
+        for(int i = 0; i < 1000; i++) v.push_back(i);
+    }
+
+    nstd::mmap_vector<int> v(path("ints").c_str(), nstd::MMAP_READ_ONLY);
+    CHECK(v.is_read_only() && v.size() == 1000 && v[999] == 999 && v.at(10) == 10);
+
+    CHECK_THROWS(v.push_back(1), std::logic_error);
+    CHECK_THROWS(v.emplace_back(1), std::logic_error);
+    CHECK_THROWS(v.append(v.data(), 1), std::logic_error);
+    CHECK_THROWS(v.pop_back(), std::logic_error);
+    CHECK_THROWS(v.resize(10), std::logic_error);
+    CHECK_THROWS(v.clear(), std::logic_error);
+    CHECK_THROWS(v.reserve(1000000), std::logic_error);
+    CHECK_THROWS(v.at(1000), std::out_of_range);
+    CHECK(v.size() == 1000 && v[999] == 999);
+
+    // another reader of the same file
+    nstd::mmap_vector<int> other(path("ints").c_str(), nstd::MMAP_READ_ONLY);
+    CHECK(other.size() == 1000 && other[500] == 500);
+}
+
+void test_bad_files() {
+    CHECK_THROWS(nstd::mmap_vector<int>(path("missing").c_str(), nstd::MMAP_READ_ONLY), std::system_error);
+
+    // element type differs from the file
+    { nstd::mmap_vector<int> v(path("typed").c_str(), nstd::MMAP_CREATE); v.push_back(1); }
+    CHECK_THROWS(nstd::mmap_vector<point>(path("typed").c_str()), std::runtime_error);
+
+    // shorter than the header, and not a vector file at all
+    FILE* file = fopen(path("short").c_str(), "w");
+    fputs("short", file);
+    fclose(file);
+    CHECK_THROWS(nstd::mmap_vector<int>(path("short").c_str()), std::runtime_error);
+
+    file = fopen(path("garbage").c_str(), "w");
+    for(int i = 0; i < 100; i++) fputs("garbage ", file);
+    fclose(file);
+    CHECK_THROWS(nstd::mmap_vector<int>(path("garbage").c_str()), std::runtime_error);
+    CHECK_THROWS(nstd::mmap_vector<int>(path("garbage").c_str(), nstd::MMAP_READ_ONLY), std::runtime_error);
+}
+
+void test_capacity() {
+    nstd::mmap_vector<int> v(path("capacity").c_str(), nstd::MMAP_CREATE);
+
+    v.reserve(1000000);
+    CHECK(v.capacity() >= 1000000 && file_size(path("capacity")) >= 4000000);
+
+    for(int i = 0; i < 10; i++) v.push_back(i);
+    v.shrink_to_fit();
+    CHECK(v.capacity() >= 10 && file_size(path("capacity")) <= size_t(sysconf(_SC_PAGESIZE)));
+    CHECK(v.size() == 10 && v[9] == 9);
+
+    // moved vector keeps the mapping
+    nstd::mmap_vector<int> moved(nstd::move(v));
+    CHECK(moved.size() == 10 && v.size() == 0);
+    moved.push_back(10);
+
+    nstd::mmap_vector<int> other(path("other").c_str(), nstd::MMAP_CREATE);
+    other = nstd::move(moved);
+    CHECK(other.size() == 11 && other[10] == 10);
+}
+
+int main() {
+    char dir_template[] = "/tmp/mmap_vector_test.XXXXXX";
+    if(!mkdtemp(dir_template)) {
+        std::cout << "mmap_vector_test: can't create a temporary directory\n";
+        return 1;
+    }
+    dir = dir_template;
+
+    test_reopen();
+    test_read_only();
+    test_bad_files();
+    test_capacity();
+
+    for(const char* name : {"points", "ints", "typed", "short", "garbage", "capacity", "other"}) unlink(path(name).c_str());
+    rmdir(dir.c_str());
+
+    std::cout << (n_failed ? "mmap_vector_test: FAILED\n" : "mmap_vector_test: OK\n");
+    return n_failed;
+}
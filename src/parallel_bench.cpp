@@ -0,0 +1,62 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <stdlib.h>
+#include "parallel.hpp"
+#include "vector.hpp"
+
+// Scaling of the nstd::par algorithms from 1 thread to the number of cores, on 100M ints by default
+// (the first argument overrides it). Every row is a pool size, cells are milliseconds
+
+template<class TFunc>
+double time_ms(TFunc func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    size_t n_elems = argc > 1 ? strtoull(argv[1], NULL, 10) : 100000000;
+
+    nstd::vector<int> values;
+    values.reserve(n_elems);
+    std::mt19937 rng(42);
+    for(size_t i = 0; i < n_elems; i++) values.push_back(int(rng() % 1000000));
+
+    nstd::vector<int> out(n_elems, 0), sorted(n_elems, 0);
+    long long checksum = 0;
+
+    std::cout << n_elems << " ints, ms\n";
+    std::cout << std::setw(8) << "threads" << std::setw(10) << "for_each" << std::setw(10) << "reduce"
+              << std::setw(10) << "scan" << std::setw(10) << "count_if" << std::setw(10) << "find_if"
+              << std::setw(10) << "sort" << "\n";
+
+    // powers of two and all the cores
+    nstd::vector<size_t> thread_counts;
+    for(size_t n_threads = 1; n_threads < std::thread::hardware_concurrency(); n_threads *= 2) thread_counts.push_back(n_threads);
+    thread_counts.push_back(std::max(std::thread::hardware_concurrency(), 1u));
+
+    for(size_t n_threads : thread_counts) {
+        nstd::thread_pool pool(n_threads);
+        nstd::par::execution_policy policy = nstd::par::default_policy().on(pool);
+
+        double ms[6];
+        ms[0] = time_ms([&]{ nstd::par::for_each(policy, out.begin(), out.end(), [](int& x) { x += 3; }); });
+        ms[1] = time_ms([&]{ checksum += nstd::par::reduce(policy, values.begin(), values.end(), 0LL); });
+        ms[2] = time_ms([&]{ nstd::par::inclusive_scan(policy, values.begin(), values.end(), out.begin()); });
+        ms[3] = time_ms([&]{ checksum += nstd::par::count_if(policy, values.begin(), values.end(), [](int x) { return x % 3 == 0; }); });
+        // absent value, so the whole range is scanned
+        ms[4] = time_ms([&]{ checksum += nstd::par::find_if(policy, values.begin(), values.end(), [](int x) { return x < 0; }) - values.begin(); });
+
+        sorted = values;
+        ms[5] = time_ms([&]{ nstd::par::sort(policy, sorted.begin(), sorted.end()); });
+
+        std::cout << std::setw(8) << n_threads << std::fixed << std::setprecision(1);
+        for(double cell : ms) std::cout << std::setw(10) << cell;
+        std::cout << "\n";
+    }
+
+    std::cout << "checksum " << checksum + out[n_elems / 2] + sorted[n_elems / 2] << "\n";
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include "parallel.hpp"
+#include "vector.hpp"
+
+// Every nstd::par algorithm is compared against its serial std counterpart on a private pool, with the cutoff
+// removed, so small inputs are split too. 'make tsan' builds it with -fsanitize=thread.
+// Exit code is the number of failed checks
+
+static int n_failed = 0;
+
+#define CHECK(cond, n_elems)                                                                            \
+    do {                                                                                                \
+        if(!(cond)) {                                                                                   \
+            std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #cond ", n_elems " << (n_elems)    \
+                      << "\n";                                                                          \
+            n_failed++;                                                                                 \
+        }                                                                                               \
+    } while(0)
+
+static std::mt19937_64 rng(42);
+
+static nstd::vector<int> random_values(size_t n_elems, int range) {
+    nstd::vector<int> res;
+    for(size_t i = 0; i < n_elems; i++) res.push_back(int(rng() % range));
+
+    return res;
+}
+
+void test_algorithms(const nstd::par::execution_policy& policy) {
+    for(size_t n_elems : {0, 1, 2, 7, 100, 1000, 100003}) {
+        nstd::vector<int> values = random_values(n_elems, 1000);
+
+        nstd::vector<int> incremented = values;
+        nstd::par::for_each(policy, incremented.begin(), incremented.end(), [](int& x) { x++; });
+        CHECK(std::equal(values.begin(), values.end(), incremented.begin(), [](int x, int y) { return x + 1 == y; }), n_elems);
+
+        nstd::vector<int> squares(n_elems, 0), ref(n_elems, 0);
+        nstd::par::transform(policy, values.begin(), values.end(), squares.begin(), [](int x) { return x * x; });
+        std::transform(values.begin(), values.end(), ref.begin(), [](int x) { return x * x; });
+        CHECK(squares == ref, n_elems);
+
+        long long sum = std::accumulate(values.begin(), values.end(), 0LL);
+        CHECK(nstd::par::reduce(policy, values.begin(), values.end(), 0LL) == sum, n_elems);
+        CHECK(nstd::par::transform_reduce(policy, values.begin(), values.end(), 5LL, std::plus<>(),
+                                          [](int x) { return 2LL * x; }) == 5 + 2 * sum, n_elems);
+
+        nstd::vector<int> scan(n_elems, 0);
+        nstd::par::inclusive_scan(policy, values.begin(), values.end(), scan.begin());
+        std::inclusive_scan(values.begin(), values.end(), ref.begin());
+        CHECK(scan == ref, n_elems);
+
+        auto is_even = [](int x) { return x % 2 == 0; };
+        CHECK(nstd::par::count_if(policy, values.begin(), values.end(), is_even) ==
+              size_t(std::count_if(values.begin(), values.end(), is_even)), n_elems);
+
+        // the first of several matches, the last element only, and no match
+        for(int key : {int(rng() % 1000), n_elems ? values.back() : 0, -1}) {
+            auto is_key = [key](int x) { return x == key; };
+            CHECK(nstd::par::find_if(policy, values.begin(), values.end(), is_key) ==
+                  std::find_if(values.begin(), values.end(), is_key), n_elems);
+        }
+
+        // random with duplicates, sorted and reversed
+        nstd::vector<int> sorted = values;
+        nstd::par::sort(policy, sorted.begin(), sorted.end());
+        ref = values;
+        std::sort(ref.begin(), ref.end());
+        CHECK(sorted == ref, n_elems);
+
+        nstd::par::sort(policy, sorted.begin(), sorted.end());
+        CHECK(sorted == ref, n_elems);
+
+        nstd::par::sort(policy, sorted.begin(), sorted.end(), std::greater<>());
+        CHECK(std::is_sorted(sorted.begin(), sorted.end(), std::greater<>()), n_elems);
+        nstd::par::sort(policy, sorted.begin(), sorted.end());
+        CHECK(sorted == ref, n_elems);
+    }
+}
+
+void test_exception(const nstd::par::execution_policy& policy) {
+    nstd::vector<int> values(10000, 1);
+    values[7777] = -1;
+
+    bool is_thrown = false;
+    try {
+        nstd::par::for_each(policy, values.begin(), values.end(), [](int x) {
+            if(x < 0) throw std::runtime_error("negative");
+        });
+    } catch(const std::runtime_error&) {
+        is_thrown = true;
+    }
+    CHECK(is_thrown, values.size());
+
+    // the pool is still usable
+    CHECK(nstd::par::reduce(policy, values.begin(), values.end(), 0) == 9998, values.size());
+}
+
+void test_nested(const nstd::par::execution_policy& policy) {
+    // every task runs a parallel sort on the same pool, waiting tasks must help instead of blocking workers
+    nstd::vector<nstd::vector<int>> rows;
+    for(size_t i = 0; i < 16; i++) rows.push_back(random_values(5000, 100));
+
+    nstd::par::for_each(policy.with_chunk_size(1), rows.begin(), rows.end(), [&](nstd::vector<int>& row) {
+        nstd::par::sort(policy, row.begin(), row.end());
+    });
+
+    bool is_sorted = true;
+    for(const nstd::vector<int>& row : rows) is_sorted = is_sorted && std::is_sorted(row.cbegin(), row.cend());
+    CHECK(is_sorted, rows.size());
+}
+
+int main() {
+    nstd::thread_pool pool(4);
+    nstd::par::execution_policy policy = nstd::par::default_policy().on(pool).with_serial_cutoff(0);
+
+    test_algorithms(policy);
+    test_algorithms(policy.with_chunk_size(7));
+    // serial fallback below the cutoff
+    test_algorithms(nstd::par::default_policy().on(pool));
+    test_exception(policy);
+    test_nested(policy);
+
+    std::cout << (n_failed ? "parallel_test: FAILED\n" : "parallel_test: OK\n");
+    return n_failed;
+}
@@ -0,0 +1,150 @@
+#include <iostream>
+#include <random>
+#include <stdint.h>
+#include "rank_select.hpp"
+
+// rank1, rank0 and select1 of rank_select against counting bit by bit, over densities and sizes around the block,
+// superblock and sample boundaries, and rank across the 2^32-bit region boundary. Built twice by the makefile:
+// portable and with -march=native, so both the loops and the popcnt / pdep paths are checked.
+// Exit code is the number of failed checks
+
+static int n_failed = 0;
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if(!(cond)) {                                                               \
+            std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #cond "\n";    \
+            n_failed++;                                                             \
+        }                                                                           \
+    } while(0)
+
+typedef nstd::rank_select<> rank_select_t;
+
+#if defined(__POPCNT__) && defined(__BMI2__)
+static const char* NAME = "rank_select_test (popcnt, pdep)";
+#else
+static const char* NAME = "rank_select_test";
+#endif
+
+/// every rank and every select against the naive answers, stops at the first mismatch
+static void check_all(const nstd::vector<bool>& bits, const char* what) {
+    nstd::vector<bool> copy = bits;
+    rank_select_t index(nstd::move(copy));
+
+    nstd::vector<size_t> ones;
+    size_t size = bits.size();
+    for(size_t i = 0; i < size; i++) {
+        if(index[i]) ones.push_back(i);
+    }
+    CHECK(index.size() == size && index.count() == ones.size());
+
+    size_t n_ones = 0;
+    for(size_t i = 0; i <= size; i++) {
+        if(index.rank1(i) != n_ones || index.rank0(i) != i - n_ones) {
+            std::cout << what << ", size " << size << ": rank of " << i << "\n";
+            CHECK(index.rank1(i) == n_ones);
+            return;
+        }
+        if(i < size && index[i]) n_ones++;
+    }
+
+    for(size_t k = 0; k < ones.size(); k++) {
+        if(index.select1(k) != ones[k]) {
+            std::cout << what << ", size " << size << ": select of " << k << "\n";
+            CHECK(index.select1(k) == ones[k]);
+            return;
+        }
+    }
+    CHECK(index.select1(ones.size()) == size);
+}
+
+static nstd::vector<bool> random_bits(size_t size, double density, std::mt19937_64& rng) {
+    std::bernoulli_distribution coin(density);
+
+    nstd::vector<bool> bits;
+    for(size_t i = 0; i < size; i++) bits.push_back(coin(rng));
+    return bits;
+}
+
+/// runs of ones and zeros of random lengths up to max_run
+static nstd::vector<bool> run_bits(size_t size, size_t max_run, std::mt19937_64& rng) {
+    nstd::vector<bool> bits;
+    bool val = false;
+    while(bits.size() < size) {
+        size_t run = rng() % max_run + 1;
+        for(size_t i = 0; i < run && bits.size() < size; i++) bits.push_back(val);
+        val = !val;
+    }
+    return bits;
+}
+
+static void test_select_in_word() {
+    std::mt19937_64 rng(24);
+    for(int n_word = 0; n_word < 100000; n_word++) {
+        uint64_t word = rng() & rng();
+        size_t n_bit = 0;
+        for(size_t i = 0; i < 64; i++) {
+            if(word >> i & 1) {
+                if(nstd::select_in_word(word, n_bit) != i) {
+                    CHECK(nstd::select_in_word(word, n_bit) == i);
+                    return;
+                }
+                n_bit++;
+            }
+        }
+    }
+}
+
+static void test_densities() {
+    std::mt19937_64 rng(42);
+
+    check_all(nstd::vector<bool>(), "empty");
+
+    // sizes at the word, block (512), superblock (2048) and select sample (8192 ones) boundaries
+    for(size_t size : {1, 63, 64, 65, 511, 512, 513, 2047, 2048, 2049, 8191, 8192, 8193, 16385, 100000}) {
+        check_all(nstd::vector<bool>(size, false), "zeros");
+        check_all(nstd::vector<bool>(size, true), "ones");
+        check_all(random_bits(size, 0.5, rng), "half");
+    }
+
+    for(double density : {0.999, 0.9, 0.1, 0.01, 0.0001}) {
+        check_all(random_bits(300000, density, rng), "random");
+    }
+
+    // long gaps put many superblocks between two select samples
+    check_all(run_bits(400000, 20000, rng), "runs");
+    check_all(run_bits(100000, 3, rng), "short runs");
+}
+
+/// superblocks keep 32-bit ranks relative to their 2^32-bit region, so the region boundary is checked
+/// on all ones with two zeros around it
+static void test_regions() {
+    const size_t REGION = rank_select_t::REGION_BITS;
+
+    nstd::vector<bool> bits(REGION + 5000, true);
+    bits[REGION - 1]  = false;
+    bits[REGION + 10] = false;
+    rank_select_t index(nstd::move(bits));
+
+    CHECK(index.count() == REGION + 5000 - 2);
+    CHECK(index.rank1(REGION - 1) == REGION - 1);
+    CHECK(index.rank1(REGION) == REGION - 1);
+    CHECK(index.rank1(REGION + 10) == REGION + 9);
+    CHECK(index.rank1(REGION + 11) == REGION + 9);
+    CHECK(index.rank1(REGION + 5000) == REGION + 4998);
+
+    CHECK(index.select1(REGION - 2) == REGION - 2);
+    CHECK(index.select1(REGION - 1) == REGION);
+    CHECK(index.select1(REGION + 9) == REGION + 11);
+    CHECK(index.select1(REGION + 4997) == REGION + 4999);
+    CHECK(index.select1(REGION + 4998) == REGION + 5000);
+}
+
+int main() {
+    test_select_in_word();
+    test_densities();
+    test_regions();
+
+    std::cout << NAME << (n_failed ? ": FAILED\n" : ": OK\n");
+    return n_failed;
+}
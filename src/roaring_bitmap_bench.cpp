@@ -0,0 +1,159 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <iterator>
+#include <stdint.h>
+#include "roaring_bitmap.hpp"
+#include "flat_set.hpp"
+#include "vector.hpp"
+#include "vector_bool.hpp"
+
+// roaring_bitmap (after optimize()) against a sorted array (flat_set<uint32_t>) and a plain bitset (vector<bool>)
+// over 2^28 values, on sparse, dense and run data: memory in bytes per value, build, 10M random contains,
+// intersection of two sets of the same kind and a full scan. Times are ns per value or per probe
+
+static const uint32_t UNIVERSE = 1 << 28;
+static const size_t   N_PROBES = 10000000;
+
+struct xorshift {
+    uint64_t state = 88172645463325252ull;
+
+    uint32_t operator()() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return uint32_t(state >> 32);
+    }
+};
+
+template<typename TFunc>
+double ns_per(size_t n_ops, TFunc func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n_ops;
+}
+
+static void print_row(const char* data, const char* set, double bytes, double build_ns, double contains_ns,
+                      double and_ns, double scan_ns) {
+    std::cout << std::left << std::setw(10) << data << std::setw(16) << set << std::right << std::fixed
+              << std::setprecision(3) << std::setw(12) << bytes << std::setprecision(1) << std::setw(10) << build_ns
+              << std::setw(10) << contains_ns << std::setw(10) << and_ns << std::setw(10) << scan_ns << "\n";
+}
+
+/// lhs and rhs are sorted values of the two sets, the rows are measured on lhs and its intersection with rhs
+static void run(const char* data, const nstd::vector<uint32_t>& lhs, const nstd::vector<uint32_t>& rhs) {
+    volatile uint64_t sink = 0;
+    size_t n_values = lhs.size();
+
+    {
+        nstd::roaring_bitmap bitmap, other(rhs.cbegin(), rhs.cend());
+        double build_ns = ns_per(n_values, [&]{
+            for(size_t i = 0; i < n_values; i++) bitmap.add(lhs[i]);
+            bitmap.optimize();
+        });
+        other.optimize();
+
+        xorshift rng;
+        double contains_ns = ns_per(N_PROBES, [&]{
+            size_t n_found = 0;
+            for(size_t i = 0; i < N_PROBES; i++) n_found += bitmap.contains(rng() % UNIVERSE);
+            sink = n_found;
+        });
+        double and_ns = ns_per(n_values, [&]{ sink = (bitmap & other).size(); });
+        double scan_ns = ns_per(n_values, [&]{
+            uint64_t sum = 0;
+            bitmap.for_each([&](uint32_t value) { sum += value; });
+            sink = sum;
+        });
+
+        print_row(data, "roaring_bitmap", double(bitmap.memory_bytes()) / n_values, build_ns, contains_ns, and_ns, scan_ns);
+        std::cout << std::setw(26) << "" << "serialized: " << std::setprecision(3)
+                  << double(bitmap.serialized_size()) / n_values << " bytes per value\n";
+    }
+    {
+        nstd::flat_set<uint32_t> set, other(nstd::sorted_unique, rhs);
+        double build_ns = ns_per(n_values, [&]{ set = nstd::flat_set<uint32_t>(lhs); });
+
+        xorshift rng;
+        double contains_ns = ns_per(N_PROBES, [&]{
+            size_t n_found = 0;
+            for(size_t i = 0; i < N_PROBES; i++) n_found += set.contains(rng() % UNIVERSE);
+            sink = n_found;
+        });
+        double and_ns = ns_per(n_values, [&]{
+            nstd::vector<uint32_t> res;
+            std::set_intersection(set.begin(), set.end(), other.begin(), other.end(), std::back_inserter(res));
+            sink = res.size();
+        });
+        double scan_ns = ns_per(n_values, [&]{
+            uint64_t sum = 0;
+            for(uint32_t value : set) sum += value;
+            sink = sum;
+        });
+
+        print_row(data, "flat_set", double(set.keys().capacity() * sizeof(uint32_t)) / n_values, build_ns, contains_ns,
+                  and_ns, scan_ns);
+    }
+    {
+        nstd::vector<bool> bits, other(UNIVERSE, false);
+        for(size_t i = 0; i < rhs.size(); i++) other[rhs[i]] = true;
+
+        double build_ns = ns_per(n_values, [&]{
+            bits.resize(UNIVERSE);
+            for(size_t i = 0; i < n_values; i++) bits[lhs[i]] = true;
+        });
+
+        xorshift rng;
+        double contains_ns = ns_per(N_PROBES, [&]{
+            size_t n_found = 0;
+            for(size_t i = 0; i < N_PROBES; i++) n_found += bits[rng() % UNIVERSE];
+            sink = n_found;
+        });
+        double and_ns = ns_per(n_values, [&]{ sink = (bits & other).count(); });
+        double scan_ns = ns_per(n_values, [&]{
+            uint64_t sum = 0;
+            bits.for_each_set_bit([&](size_t value) { sum += value; });
+            sink = sum;
+        });
+
+        print_row(data, "vector<bool>", double(bits.capacity()) / 8 / n_values, build_ns, contains_ns, and_ns, scan_ns);
+    }
+    (void)sink;
+}
+
+/// n_values random values below limit, sorted and unique
+static nstd::vector<uint32_t> random_values(size_t n_values, uint32_t limit, xorshift& rng) {
+    nstd::vector<uint32_t> values;
+    for(size_t i = 0; i < n_values; i++) values.push_back(rng() % limit);
+
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    return values;
+}
+
+/// n_runs runs of up to max_run values with random gaps between them
+static nstd::vector<uint32_t> run_values(size_t n_runs, uint32_t max_run, xorshift& rng) {
+    nstd::vector<uint32_t> values;
+    uint32_t gap = UNIVERSE / n_runs;
+    for(size_t n_run = 0; n_run < n_runs; n_run++) {
+        uint32_t start = uint32_t(n_run * gap + rng() % (gap / 2));
+        uint32_t length = rng() % max_run + 1;
+        for(uint32_t value = start; value < start + length; value++) values.push_back(value);
+    }
+    return values;
+}
+
+int main() {
+    xorshift rng;
+
+    std::cout << "values below 2^28, " << N_PROBES << " random probes, bytes per value and ns\n";
+    std::cout << std::left << std::setw(10) << "data" << std::setw(16) << "set" << std::right << std::setw(12) << "bytes"
+              << std::setw(10) << "build" << std::setw(10) << "contains" << std::setw(10) << "and" << std::setw(10) << "scan" << "\n";
+
+    run("sparse", random_values(1000000, UNIVERSE, rng), random_values(1000000, UNIVERSE, rng));
+    run("dense", random_values(10000000, 1 << 24, rng), random_values(10000000, 1 << 24, rng));
+    run("runs", run_values(10000, 5000, rng), run_values(10000, 5000, rng));
+
+    return 0;
+}
@@ -0,0 +1,248 @@
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+#include <stdexcept>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <iterator>
+#include "roaring_bitmap.hpp"
+
+// Random operations on roaring_bitmap repeated on std::set<uint32_t>, sizes must agree after every step, contents
+// after every 10th. Values are packed into a few chunks, so containers go between array, bitmap and run. The states
+// also go through serialize() and deserialize(), the format is checked on bytes written by hand from its specification.
+// Exit code is the number of failed checks
+
+static int n_failed = 0;
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if(!(cond)) {                                                               \
+            std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #cond "\n";    \
+            n_failed++;                                                             \
+        }                                                                           \
+    } while(0)
+
+#define CHECK_THROWS(expr, Exception)                                               \
+    do {                                                                            \
+        bool thrown = false;                                                        \
+        try { expr; } catch(const Exception&) { thrown = true; }                    \
+        if(!thrown) {                                                               \
+            std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #expr          \
+                      << " doesn't throw " #Exception "\n";                         \
+            n_failed++;                                                             \
+        }                                                                           \
+    } while(0)
+
+/// iterators and for_each both give the values of ref in order
+static bool same_values(const nstd::roaring_bitmap& bitmap, const std::set<uint32_t>& ref) {
+    if(bitmap.size() != ref.size()) return false;
+
+    auto ref_it = ref.begin();
+    for(auto it = bitmap.begin(); it != bitmap.end(); ++it, ++ref_it) {
+        if(ref_it == ref.end() || *it != *ref_it) return false;
+    }
+
+    bool is_same = true;
+    ref_it = ref.begin();
+    bitmap.for_each([&](uint32_t value) { is_same = is_same && value == *ref_it++; });
+
+    return is_same && ref_it == ref.end();
+}
+
+static bool round_trips(const nstd::roaring_bitmap& bitmap) {
+    nstd::vector<uint8_t> bytes = bitmap.serialize();
+    if(bytes.size() != bitmap.serialized_size()) return false;
+
+    nstd::roaring_bitmap copy = nstd::roaring_bitmap::deserialize(bytes);
+    return copy == bitmap && copy.size() == bitmap.size();
+}
+
+/// value of chunk (high 16 bits) 0..n_chunks-1, chunk 3 also gets values at the top of the range
+static uint32_t random_value(std::mt19937& rng, uint32_t n_chunks, uint32_t spread) {
+    uint32_t chunk = rng() % n_chunks;
+    if(chunk == 3) chunk = 0xFFFF;
+
+    return chunk << 16 | (rng() % spread);
+}
+
+static void test_against_std(unsigned seed, uint32_t spread) {
+    std::mt19937 rng(seed);
+    nstd::roaring_bitmap bitmap;
+    std::set<uint32_t> ref;
+
+    for(int step = 0; step < 1000; step++) {
+        uint32_t value = random_value(rng, 4, spread);
+
+        switch(rng() % 8) {
+        case 0:
+            for(int i = 0; i < 100; i++) {
+                uint32_t added = random_value(rng, 4, spread);
+                CHECK(bitmap.add(added) == ref.insert(added).second);
+            }
+            break;
+        case 1:
+            for(int i = 0; i < 100; i++) {
+                uint32_t removed = random_value(rng, 4, spread);
+                CHECK(bitmap.remove(removed) == (ref.erase(removed) == 1));
+            }
+            break;
+        case 2: {
+            // ranges within a chunk and over chunk boundaries
+            uint64_t last = std::min<uint64_t>(uint64_t(value) + rng() % 70000, uint64_t(1) << 32);
+            bitmap.add_range(value, last);
+
+            auto hint = ref.lower_bound(value);
+            for(uint64_t v = value; v < last; v++) hint = std::next(ref.insert(hint, uint32_t(v)));
+            break;
+        }
+        case 3: {
+            // removing most of a chunk turns a bitmap back into an array
+            uint32_t chunk = value & 0xFFFF0000;
+            for(auto it = ref.lower_bound(chunk); it != ref.end() && (*it & 0xFFFF0000) == chunk; ) {
+                if(rng() % 16) {
+                    CHECK(bitmap.remove(*it));
+                    it = ref.erase(it);
+                }
+                else ++it;
+            }
+            break;
+        }
+        case 4:
+            bitmap.optimize();
+            break;
+        case 5: {
+            nstd::roaring_bitmap other;
+            std::set<uint32_t> other_ref;
+            for(int i = 0; i < 2000; i++) {
+                uint32_t added = random_value(rng, 4, spread);
+                other.add(added);
+                other_ref.insert(added);
+            }
+            if(rng() % 2) {
+                uint64_t last = std::min<uint64_t>(uint64_t(value) + 5000, uint64_t(1) << 32);
+                other.add_range(value, last);
+                for(uint64_t v = value; v < last; v++) other_ref.insert(uint32_t(v));
+            }
+            if(rng() % 2) other.optimize();
+
+            std::vector<uint32_t> res;
+            if(rng() % 2) {
+                bitmap &= other;
+                std::set_intersection(ref.begin(), ref.end(), other_ref.begin(), other_ref.end(), std::back_inserter(res));
+            }
+            else {
+                bitmap |= other;
+                std::set_union(ref.begin(), ref.end(), other_ref.begin(), other_ref.end(), std::back_inserter(res));
+            }
+            ref = std::set<uint32_t>(res.begin(), res.end());
+            break;
+        }
+        case 6:
+            for(int i = 0; i < 100; i++) {
+                uint32_t probe = random_value(rng, 4, spread);
+                CHECK(bitmap.contains(probe) == (ref.count(probe) == 1));
+            }
+            break;
+        case 7:
+            if(rng() % 20 == 0) {
+                bitmap.clear();
+                ref.clear();
+            }
+            break;
+        }
+
+        // full walks over up to 4 chunks are slow under the sanitizers, so they are done every 10th step
+        if(bitmap.size() != ref.size()) {
+            std::cout << "seed " << seed << ", step " << step << "\n";
+            CHECK(bitmap.size() == ref.size());
+            return;
+        }
+        if(step % 10 != 9) continue;
+
+        if(!same_values(bitmap, ref)) {
+            std::cout << "seed " << seed << ", step " << step << "\n";
+            CHECK(same_values(bitmap, ref));
+            return;
+        }
+        if(!round_trips(bitmap)) {
+            std::cout << "seed " << seed << ", step " << step << "\n";
+            CHECK(round_trips(bitmap));
+            return;
+        }
+    }
+}
+
+/// serialized bytes of the Roaring format specification, written out by hand
+static void test_format() {
+    nstd::roaring_bitmap array;
+    for(uint32_t value : {1, 2, 3}) array.add(value);
+
+    // no run containers: cookie 12346, 1 container, key 0 and cardinality - 1, offset 16, values
+    const uint8_t ARRAY_BYTES[] = {0x3A, 0x30, 0, 0,  1, 0, 0, 0,  0, 0, 2, 0,  16, 0, 0, 0,  1, 0, 2, 0, 3, 0};
+    nstd::vector<uint8_t> bytes = array.serialize();
+    CHECK(bytes.size() == sizeof(ARRAY_BYTES) && memcmp(bytes.data(), ARRAY_BYTES, sizeof(ARRAY_BYTES)) == 0);
+
+    // run container: cookie 12347 with n - 1 in the high half, run flags, key and cardinality - 1,
+    // no offsets below 4 containers, number of runs, start and length of each
+    nstd::roaring_bitmap runs;
+    runs.add_range(0, 100);
+    runs.optimize();
+    const uint8_t RUN_BYTES[] = {0x3B, 0x30, 0, 0,  1,  0, 0, 99, 0,  1, 0,  0, 0, 99, 0};
+    bytes = runs.serialize();
+    CHECK(bytes.size() == sizeof(RUN_BYTES) && memcmp(bytes.data(), RUN_BYTES, sizeof(RUN_BYTES)) == 0);
+
+    nstd::roaring_bitmap from_bytes = nstd::roaring_bitmap::deserialize(RUN_BYTES, sizeof(RUN_BYTES));
+    CHECK(from_bytes == runs && from_bytes.size() == 100 && from_bytes.contains(99) && !from_bytes.contains(100));
+}
+
+/// the format tells arrays from bitmaps by cardinality, so containers must switch exactly at MAX_ARRAY values
+static void test_array_bitmap_boundary() {
+    const uint32_t MAX_ARRAY = nstd::roaring_container::MAX_ARRAY;
+
+    nstd::roaring_bitmap array, bitmap;
+    for(uint32_t value = 0; value < MAX_ARRAY; value++) array.add(value * 3);
+    for(uint32_t value = 0; value <= MAX_ARRAY; value++) bitmap.add(value * 3);
+    CHECK(round_trips(array) && round_trips(bitmap));
+
+    bitmap.remove(MAX_ARRAY * 3);
+    CHECK(bitmap == array && round_trips(bitmap));
+    CHECK(bitmap.serialize().size() == array.serialize().size());
+    CHECK(memcmp(bitmap.serialize().data(), array.serialize().data(), array.serialized_size()) == 0);
+
+    bitmap.add(MAX_ARRAY * 3);
+    CHECK(round_trips(bitmap) && bitmap.size() == MAX_ARRAY + 1);
+}
+
+static void test_malformed() {
+    nstd::roaring_bitmap bitmap;
+    for(uint32_t value = 0; value < 300000; value += 7) bitmap.add(value);
+    bitmap.add_range(1 << 20, (1 << 20) + 50000);
+    bitmap.optimize();
+
+    nstd::vector<uint8_t> bytes = bitmap.serialize();
+    CHECK(nstd::roaring_bitmap::deserialize(bytes) == bitmap);
+
+    // every cut of the input is detected
+    for(size_t n_bytes = 0; n_bytes < bytes.size(); n_bytes += 1 + n_bytes / 64) {
+        CHECK_THROWS(nstd::roaring_bitmap::deserialize(bytes.data(), n_bytes), std::invalid_argument);
+    }
+
+    nstd::vector<uint8_t> bad_cookie = bytes;
+    bad_cookie[0] ^= 0xFF;
+    CHECK_THROWS(nstd::roaring_bitmap::deserialize(bad_cookie), std::invalid_argument);
+}
+
+int main() {
+    // sparse chunks stay arrays, dense ones become bitmaps and runs
+    test_against_std(1, 3000);
+    test_against_std(2, 20000);
+    test_against_std(3, 65536);
+    test_format();
+    test_array_bitmap_boundary();
+    test_malformed();
+
+    std::cout << (n_failed ? "roaring_bitmap_test: FAILED\n" : "roaring_bitmap_test: OK\n");
+    return n_failed;
+}
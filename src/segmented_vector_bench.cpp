@@ -0,0 +1,48 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <stdint.h>
+#include "vector.hpp"
+#include "segmented_vector.hpp"
+
+// Latency of single push_back calls: nstd::vector moves all the elements on growth, segmented_vector
+// only allocates a block. 20M uint64_t are pushed, every call is timed, percentiles are in nanoseconds
+
+static const size_t N_PUSHES = 20000000;
+
+template<typename Vector>
+void run(const char* name) {
+    nstd::vector<uint32_t> latencies;
+    latencies.reserve(N_PUSHES);
+
+    {
+        Vector v;
+        for(size_t i = 0; i < N_PUSHES; i++) {
+            auto start = std::chrono::steady_clock::now();
+            v.push_back(i);
+            auto end   = std::chrono::steady_clock::now();
+
+            latencies.push_back(uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << std::left << std::setw(20) << name << std::right;
+    for(double percentile : {0.5, 0.99, 0.999, 0.99999}) {
+        std::cout << std::setw(12) << latencies[size_t(percentile * (N_PUSHES - 1))];
+    }
+    std::cout << std::setw(12) << latencies.back() << "\n";
+}
+
+int main() {
+    std::cout << std::left << std::setw(20) << "container" << std::right << std::setw(12) << "p50"
+              << std::setw(12) << "p99" << std::setw(12) << "p99.9" << std::setw(12) << "p99.999"
+              << std::setw(12) << "max" << "\n";
+
+    run<nstd::vector<uint64_t>>("vector");
+    run<nstd::segmented_vector<uint64_t>>("segmented_vector");
+
+    return 0;
+}
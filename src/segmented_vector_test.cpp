@@ -0,0 +1,185 @@
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "segmented_vector.hpp"
+
+// Behaviour checks of segmented_vector against std::vector, exit code is the number of failed ones
+
+static int n_failed = 0;
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if(!(cond)) {                                                               \
+            std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #cond "\n";    \
+            n_failed++;                                                             \
+        }                                                                           \
+    } while(0)
+
+/// counts live objects, copy constructor throws after n_copies_left copies
+struct Tracked {
+    static int n_alive;
+    static int n_copies_left;
+
+    int value;
+
+    Tracked(int value_ = 0): value(value_) { n_alive++; }
+    Tracked(const Tracked& other): value(other.value) {
+        if(n_copies_left-- == 0) throw std::runtime_error("copy");
+        n_alive++;
+    }
+    Tracked(Tracked&& other): value(other.value) { n_alive++; }
+    Tracked& operator=(const Tracked& other) { value = other.value; return *this; }
+    ~Tracked() { n_alive--; }
+};
+
+int Tracked::n_alive       = 0;
+int Tracked::n_copies_left = -1;
+
+/// instances are never equal, so moves can't take the blocks of the other vector
+template<typename T>
+struct unequal_allocator : std::allocator<T> {
+    typedef std::false_type is_always_equal;
+};
+
+template<typename Vector>
+bool is_equal(const Vector& v, const std::vector<int>& ref) {
+    if(v.size() != ref.size()) return false;
+
+    for(size_t i = 0; i < ref.size(); i++) {
+        if(v[i].value != ref[i]) return false;
+    }
+    return true;
+}
+
+void test_random_ops() {
+    std::mt19937_64 rng(42);
+    {
+        nstd::segmented_vector<Tracked, std::allocator, nstd::check_always, 2> v;
+        std::vector<int> ref;
+
+        for(size_t n_op = 0; n_op < 200000; n_op++) {
+            int value = int(rng() % 1000);
+
+            switch(rng() % 8) {
+                case 0: case 1: case 2:
+                    v.push_back(Tracked(value));
+                    ref.push_back(value);
+                    break;
+                case 3:
+                    if(ref.empty()) break;
+                    CHECK(v.pop_back().value == ref.back());
+                    ref.pop_back();
+                    break;
+                case 4:
+                    if(ref.empty()) break;
+                    v[value % ref.size()].value = value;
+                    ref[value % ref.size()]     = value;
+                    break;
+                case 5:
+                    v.resize(ref.size() + value % 7, Tracked(value));
+                    ref.resize(ref.size() + value % 7, value);
+                    break;
+                case 6:
+                    if(rng() % 64) break;
+                    v.resize(ref.size() / 2);
+                    ref.resize(ref.size() / 2);
+                    v.shrink_to_fit();
+                    CHECK(v.capacity() >= v.size() && v.capacity() < 2 * v.size() + 4);
+                    break;
+                case 7:
+                    if(rng() % 256) break;
+                    v.clear();
+                    ref.clear();
+                    break;
+            }
+            CHECK(v.size() == ref.size());
+            CHECK(Tracked::n_alive == int(ref.size()));
+        }
+        CHECK(is_equal(v, ref));
+
+        // iterators and their arithmetic across block boundaries
+        size_t i = 0;
+        for(auto it = v.cbegin(); it != v.cend(); ++it, i++) CHECK(it->value == ref[i]);
+        CHECK(size_t(v.end() - v.begin()) == ref.size());
+        for(size_t offset = 0; offset < ref.size(); offset += 37) {
+            CHECK((v.begin() + offset)->value == ref[offset] && v.begin()[offset].value == ref[offset]);
+            CHECK((v.end() - (offset + 1))->value == ref[ref.size() - offset - 1]);
+        }
+
+        bool is_thrown = false;
+        try {
+            (void)v[ref.size()];
+        } catch(const std::out_of_range&) {
+            is_thrown = true;
+        }
+        CHECK(is_thrown);
+    }
+    CHECK(Tracked::n_alive == 0);
+}
+
+void test_stable_references() {
+    nstd::segmented_vector<int> v;
+    std::vector<int*> addresses;
+
+    for(int i = 0; i < 100000; i++) addresses.push_back(&v.emplace_back(i));
+
+    bool is_stable = true;
+    for(int i = 0; i < 100000; i++) is_stable = is_stable && addresses[i] == &v[i] && *addresses[i] == i;
+    CHECK(is_stable);
+}
+
+template<template <typename> class Alloc>
+void check_copy_move() {
+    typedef nstd::segmented_vector<Tracked, Alloc> vector_t;
+    {
+        vector_t v;
+        std::vector<int> ref;
+        for(int i = 0; i < 1000; i++) {
+            v.emplace_back(i);
+            ref.push_back(i);
+        }
+
+        vector_t copy(v);
+        CHECK(is_equal(copy, ref));
+
+        vector_t moved(nstd::move(copy));
+        CHECK(is_equal(moved, ref) && copy.size() == 0);
+
+        vector_t assigned;
+        assigned.emplace_back(-1);
+        assigned = moved;
+        CHECK(is_equal(assigned, ref));
+        assigned = nstd::move(moved);
+        CHECK(is_equal(assigned, ref) && moved.size() == 0);
+
+        vector_t other(3, Tracked(7));
+        swap(other, assigned);
+        CHECK(is_equal(other, ref) && is_equal(assigned, {7, 7, 7}));
+        CHECK(Tracked::n_alive == 2 * 1000 + 3);
+
+        // copy fails in the middle
+        Tracked::n_copies_left = 500;
+        try {
+            vector_t failed(v);
+            CHECK(false);
+        } catch(const std::runtime_error&) {}
+        Tracked::n_copies_left = -1;
+        CHECK(Tracked::n_alive == 2 * 1000 + 3);
+    }
+    CHECK(Tracked::n_alive == 0);
+}
+
+void test_copy_move() {
+    check_copy_move<std::allocator>();
+    check_copy_move<unequal_allocator>();
+}
+
+int main() {
+    test_random_ops();
+    test_stable_references();
+    test_copy_move();
+
+    std::cout << (n_failed ? "segmented_vector_test: FAILED\n" : "segmented_vector_test: OK\n");
+    return n_failed;
+}
@@ -0,0 +1,167 @@
+#include <iostream>
+#include <random>
+#include "simd.hpp"
+
+// Every kernel of every ISA supported by the cpu is compared against the scalar reference, on lengths
+// from empty to several blocks, so all the tails shorter than a vector are covered. Outputs get guard
+// elements after the end, which must stay untouched. Data are small integers, so float results are exact.
+// Exit code is the number of failed checks
+
+using namespace nstd;
+
+static int n_failed = 0;
+
+#define CHECK(cond, isa, n_elems)                                                                       \
+    do {                                                                                                \
+        if(!(cond)) {                                                                                   \
+            std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #cond ", isa " << (isa)            \
+                      << ", n_elems " << (n_elems) << "\n";                                             \
+            n_failed++;                                                                                 \
+        }                                                                                               \
+    } while(0)
+
+static const size_t N_GUARDS  = 16;
+static const int    GUARD_VAL = 12345;
+
+static std::mt19937_64 rng(42);
+
+/// lengths 0..130 and some long ones around multiples of the widest vector block
+static vector<size_t> test_lengths() {
+    vector<size_t> lengths;
+    for(size_t n_elems = 0; n_elems <= 130; n_elems++) lengths.push_back(n_elems);
+    for(size_t n_elems : {255, 256, 257, 1023, 1024, 1025, 4099}) lengths.push_back(n_elems);
+
+    return lengths;
+}
+
+template<typename T>
+vector<T> random_values(size_t n_elems, int range) {
+    vector<T> res;
+    for(size_t i = 0; i < n_elems; i++) res.push_back(T(int(rng() % (2 * range + 1)) - range));
+
+    return res;
+}
+
+template<typename T>
+bool guards_intact(const vector<T>& out, size_t n_elems) {
+    for(size_t i = n_elems; i < n_elems + N_GUARDS; i++) {
+        if(out[i] != T(GUARD_VAL)) return false;
+    }
+    return true;
+}
+
+template<typename T>
+void test_numeric(simd::isa_t isa) {
+    for(size_t n_elems : test_lengths()) {
+        vector<T> lhs = random_values<T>(n_elems, 8);
+        vector<T> rhs = random_values<T>(n_elems, 8);
+        vector<T> add = random_values<T>(n_elems, 8);
+
+        CHECK(simd::sum(lhs.data(), n_elems, isa) == simd::sum(lhs.data(), n_elems, simd::ISA_SCALAR), isa, n_elems);
+        CHECK(simd::dot(lhs.data(), rhs.data(), n_elems, isa) ==
+              simd::dot(lhs.data(), rhs.data(), n_elems, simd::ISA_SCALAR), isa, n_elems);
+
+        if(n_elems) {
+            CHECK(simd::min(lhs.data(), n_elems, isa) == simd::min(lhs.data(), n_elems, simd::ISA_SCALAR), isa, n_elems);
+            CHECK(simd::max(lhs.data(), n_elems, isa) == simd::max(lhs.data(), n_elems, simd::ISA_SCALAR), isa, n_elems);
+            CHECK(simd::argmin(lhs.data(), n_elems, isa) == simd::argmin(lhs.data(), n_elems, simd::ISA_SCALAR), isa, n_elems);
+            CHECK(simd::argmax(lhs.data(), n_elems, isa) == simd::argmax(lhs.data(), n_elems, simd::ISA_SCALAR), isa, n_elems);
+        }
+
+        // present, absent and only the last element
+        T last = n_elems ? lhs[n_elems - 1] : T(0);
+        for(T key : {T(0), T(3), T(100), last}) {
+            CHECK(simd::find_first_equal(lhs.data(), n_elems, key, isa) ==
+                  simd::find_first_equal(lhs.data(), n_elems, key, simd::ISA_SCALAR), isa, n_elems);
+            CHECK(simd::count_equal(lhs.data(), n_elems, key, isa) ==
+                  simd::count_equal(lhs.data(), n_elems, key, simd::ISA_SCALAR), isa, n_elems);
+        }
+
+        vector<T> out(n_elems + N_GUARDS, T(GUARD_VAL)), ref(n_elems + N_GUARDS, T(GUARD_VAL));
+
+        simd::add(lhs.data(), rhs.data(), out.data(), n_elems, isa);
+        simd::add(lhs.data(), rhs.data(), ref.data(), n_elems, simd::ISA_SCALAR);
+        CHECK(std::equal(out.data(), out.data() + n_elems, ref.data()) && guards_intact(out, n_elems), isa, n_elems);
+
+        simd::mul(lhs.data(), rhs.data(), out.data(), n_elems, isa);
+        simd::mul(lhs.data(), rhs.data(), ref.data(), n_elems, simd::ISA_SCALAR);
+        CHECK(std::equal(out.data(), out.data() + n_elems, ref.data()) && guards_intact(out, n_elems), isa, n_elems);
+
+        simd::fma(lhs.data(), rhs.data(), add.data(), out.data(), n_elems, isa);
+        simd::fma(lhs.data(), rhs.data(), add.data(), ref.data(), n_elems, simd::ISA_SCALAR);
+        CHECK(std::equal(out.data(), out.data() + n_elems, ref.data()) && guards_intact(out, n_elems), isa, n_elems);
+    }
+}
+
+template<simd::bit_op_t OP>
+void test_bit_op(simd::isa_t isa, const vector<uint64_t>& lhs, const vector<uint64_t>& rhs, size_t n_words) {
+    vector<uint64_t> out(n_words + N_GUARDS, GUARD_VAL), ref(n_words + N_GUARDS, GUARD_VAL);
+
+    simd::bit_words<OP>(lhs.data(), rhs.data(), out.data(), n_words, isa);
+    simd::bit_words<OP>(lhs.data(), rhs.data(), ref.data(), n_words, simd::ISA_SCALAR);
+    CHECK(std::equal(out.data(), out.data() + n_words, ref.data()) && guards_intact(out, n_words), isa, n_words);
+
+    CHECK(simd::bit_words_any<OP>(lhs.data(), rhs.data(), n_words, isa) ==
+          simd::bit_words_any<OP>(lhs.data(), rhs.data(), n_words, simd::ISA_SCALAR), isa, n_words);
+}
+
+void test_bits(simd::isa_t isa) {
+    for(size_t n_words : test_lengths()) {
+        vector<uint64_t> lhs, rhs, disjoint, zeros(n_words, 0), ones(n_words, ~uint64_t(0));
+        for(size_t i = 0; i < n_words; i++) {
+            lhs.push_back(rng());
+            rhs.push_back(rng());
+            disjoint.push_back(~lhs[i]);
+        }
+
+        test_bit_op<simd::BIT_AND>(isa, lhs, rhs, n_words);
+        test_bit_op<simd::BIT_OR>(isa, lhs, rhs, n_words);
+        test_bit_op<simd::BIT_XOR>(isa, lhs, rhs, n_words);
+        test_bit_op<simd::BIT_ANDNOT>(isa, lhs, rhs, n_words);
+
+        // results of 'any' are false for the whole array
+        test_bit_op<simd::BIT_AND>(isa, lhs, disjoint, n_words);
+        test_bit_op<simd::BIT_ANDNOT>(isa, lhs, lhs, n_words);
+        test_bit_op<simd::BIT_XOR>(isa, lhs, lhs, n_words);
+        test_bit_op<simd::BIT_OR>(isa, zeros, zeros, n_words);
+
+        vector<uint64_t> out(n_words + N_GUARDS, GUARD_VAL), ref(n_words + N_GUARDS, GUARD_VAL);
+        simd::bit_words_not(lhs.data(), out.data(), n_words, isa);
+        simd::bit_words_not(lhs.data(), ref.data(), n_words, simd::ISA_SCALAR);
+        CHECK(std::equal(out.data(), out.data() + n_words, ref.data()) && guards_intact(out, n_words), isa, n_words);
+
+        CHECK(simd::bit_words_popcount(lhs.data(), n_words, isa) ==
+              simd::bit_words_popcount(lhs.data(), n_words, simd::ISA_SCALAR), isa, n_words);
+        CHECK(simd::bit_words_popcount(ones.data(), n_words, isa) == 64 * n_words, isa, n_words);
+
+        // the first word, which differs from flip, is at every position and missing
+        for(size_t n_diff = 0; n_diff <= n_words; n_diff++) {
+            for(uint64_t flip : {uint64_t(0), ~uint64_t(0)}) {
+                vector<uint64_t> words(n_words, flip);
+                if(n_diff < n_words) words[n_diff] ^= uint64_t(1) << (n_diff % 64);
+
+                CHECK(simd::bit_words_find(words.data(), n_words, flip, isa) ==
+                      simd::bit_words_find(words.data(), n_words, flip, simd::ISA_SCALAR), isa, n_words);
+                CHECK(simd::bit_words_find(words.data(), n_words, flip, isa) == n_diff, isa, n_words);
+            }
+        }
+    }
+}
+
+int main() {
+    for(simd::isa_t isa : {simd::ISA_SCALAR, simd::ISA_SSE42, simd::ISA_AVX2, simd::ISA_AVX512}) {
+        if(!simd::is_supported(isa)) {
+            std::cout << "simd_test: isa " << isa << " is not supported, skipped\n";
+            continue;
+        }
+
+        test_numeric<int32_t>(isa);
+        test_numeric<int64_t>(isa);
+        test_numeric<float>(isa);
+        test_numeric<double>(isa);
+        test_bits(isa);
+    }
+
+    std::cout << (n_failed ? "simd_test: FAILED\n" : "simd_test: OK\n");
+    return n_failed;
+}
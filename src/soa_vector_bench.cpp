@@ -0,0 +1,133 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <stdint.h>
+#include "vector.hpp"
+#include "soa_vector.hpp"
+
+// Scans of 8M records of 64 bytes stored as structs (nstd::vector<record>) and as columns (soa_vector).
+// Every scan is repeated, the best time is taken; GB/s is the bandwidth of the fields the scan really uses
+
+static const size_t N_RECORDS = 8 << 20;
+static const int    N_REPEATS = 5;
+
+struct record {
+    double   price;
+    double   quantity;
+    int64_t  id;
+    int64_t  timestamp;
+    int32_t  flags;
+    int32_t  venue;
+    double   bid;
+    double   ask;
+    double   fee;
+};
+
+static_assert(sizeof(record) == 64, "one record per cache line");
+
+typedef nstd::soa_vector<double, double, int64_t, int64_t, int32_t, int32_t, double, double, double> soa_t;
+
+template<typename TFunc>
+double best_ms(TFunc func) {
+    double best = 1e300;
+    for(int i = 0; i < N_REPEATS; i++) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if(ms < best) best = ms;
+    }
+    return best;
+}
+
+static void print_row(const char* scan, size_t n_used_bytes, double aos_ms, double soa_ms) {
+    double n_gb = double(n_used_bytes) * N_RECORDS / 1e9;
+
+    std::cout << std::left << std::setw(28) << scan << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << aos_ms << std::setw(10) << n_gb / aos_ms * 1e3
+              << std::setw(10) << soa_ms << std::setw(10) << n_gb / soa_ms * 1e3 << "\n";
+}
+
+int main() {
+    nstd::vector<record> aos;
+    soa_t soa;
+    aos.reserve(N_RECORDS);
+    soa.reserve(N_RECORDS);
+
+    for(size_t i = 0; i < N_RECORDS; i++) {
+        record rec = {double(i % 1000), double(i % 7), int64_t(i), int64_t(i * 3), int32_t(i % 16), int32_t(i % 5),
+                      double(i % 1000) - 0.5, double(i % 1000) + 0.5, 0.01};
+        aos.push_back(rec);
+        soa.emplace_back(rec.price, rec.quantity, rec.id, rec.timestamp, rec.flags, rec.venue, rec.bid, rec.ask, rec.fee);
+    }
+
+    volatile double sink = 0;
+
+    std::cout << N_RECORDS << " records of " << sizeof(record) << " bytes, best of " << N_REPEATS << "\n";
+    std::cout << std::left << std::setw(28) << "scan" << std::right << std::setw(10) << "AoS ms" << std::setw(10) << "GB/s"
+              << std::setw(10) << "SoA ms" << std::setw(10) << "GB/s" << "\n";
+
+    // one field
+    double aos_ms = best_ms([&]{
+        double sum = 0;
+        for(size_t i = 0; i < N_RECORDS; i++) sum += aos[i].price;
+        sink = sum;
+    });
+    double soa_ms = best_ms([&]{
+        const double* price = soa.data<0>();
+        double sum = 0;
+        for(size_t i = 0; i < N_RECORDS; i++) sum += price[i];
+        sink = sum;
+    });
+    print_row("sum(price)", sizeof(double), aos_ms, soa_ms);
+
+    // two fields
+    aos_ms = best_ms([&]{
+        double sum = 0;
+        for(size_t i = 0; i < N_RECORDS; i++) sum += aos[i].price * aos[i].quantity;
+        sink = sum;
+    });
+    soa_ms = best_ms([&]{
+        const double* price    = soa.data<0>();
+        const double* quantity = soa.data<1>();
+        double sum = 0;
+        for(size_t i = 0; i < N_RECORDS; i++) sum += price[i] * quantity[i];
+        sink = sum;
+    });
+    print_row("sum(price * quantity)", 2 * sizeof(double), aos_ms, soa_ms);
+
+    // filter on a narrow field
+    aos_ms = best_ms([&]{
+        size_t n_found = 0;
+        for(size_t i = 0; i < N_RECORDS; i++) n_found += aos[i].flags == 3;
+        sink = double(n_found);
+    });
+    soa_ms = best_ms([&]{
+        const int32_t* flags = soa.data<4>();
+        size_t n_found = 0;
+        for(size_t i = 0; i < N_RECORDS; i++) n_found += flags[i] == 3;
+        sink = double(n_found);
+    });
+    print_row("count(flags == 3)", sizeof(int32_t), aos_ms, soa_ms);
+
+    // whole records, where AoS reads one line per record and SoA nine streams
+    aos_ms = best_ms([&]{
+        double sum = 0;
+        for(size_t i = 0; i < N_RECORDS; i++) {
+            const record& rec = aos[i];
+            sum += rec.price + rec.quantity + rec.id + rec.timestamp + rec.flags + rec.venue + rec.bid + rec.ask + rec.fee;
+        }
+        sink = sum;
+    });
+    soa_ms = best_ms([&]{
+        double sum = 0;
+        for(size_t i = 0; i < N_RECORDS; i++) {
+            sum += soa.data<0>()[i] + soa.data<1>()[i] + soa.data<2>()[i] + soa.data<3>()[i] + soa.data<4>()[i]
+                 + soa.data<5>()[i] + soa.data<6>()[i] + soa.data<7>()[i] + soa.data<8>()[i];
+        }
+        sink = sum;
+    });
+    print_row("sum(all fields)", sizeof(record), aos_ms, soa_ms);
+
+    (void)sink;
+    return 0;
+}
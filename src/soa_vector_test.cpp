@@ -0,0 +1,74 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "soa_vector.hpp"
+
+// Behaviour checks of soa_vector, exit code is the number of failed ones
+
+static int n_failed = 0;
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if(!(cond)) {                                                               \
+            std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #cond "\n";    \
+            n_failed++;                                                             \
+        }                                                                           \
+    } while(0)
+
+/// copy throws for negative values
+struct Fragile {
+    int value;
+
+    Fragile(int value_ = 0): value(value_) {}
+    Fragile(const Fragile& other): value(other.value) {
+        if(value < 0) throw std::runtime_error("copy");
+    }
+};
+
+void test_emplace_back_from_itself() {
+    nstd::soa_vector<int, std::string> v;
+
+    v.emplace_back(0, std::string(40, 'a'));
+    for(size_t i = 1; i < 100; i++) {
+        // arguments refer to the columns, which are reallocated at every growth
+        size_t capacity = v.capacity();
+        v.emplace_back(v[i - 1].get<0>() + 1, v[i - 1].get<1>());
+        CHECK(v.capacity() >= capacity);
+    }
+
+    CHECK(v.size() == 100);
+    for(size_t i = 0; i < v.size(); i++) {
+        CHECK(v.data<0>()[i] == int(i));
+        CHECK(v.data<1>()[i] == std::string(40, 'a'));
+    }
+
+    nstd::soa_vector<int, std::string> w;
+    w.push_back(std::make_tuple(7, std::string(40, 'b')));
+    for(size_t i = 1; i < 50; i++) w.push_back(w[i - 1]);
+    CHECK(w.size() == 50 && w[49].get<0>() == 7 && w[49].get<1>() == std::string(40, 'b'));
+}
+
+void test_emplace_back_throws() {
+    nstd::soa_vector<int, Fragile> v;
+    v.emplace_back(1, Fragile(1));
+    v.shrink_to_fit();
+
+    // growth is abandoned, old columns are kept
+    bool is_thrown = false;
+    try {
+        v.emplace_back(2, Fragile(-1));
+    } catch(const std::runtime_error&) {
+        is_thrown = true;
+    }
+    CHECK(is_thrown);
+    CHECK(v.size() == 1 && v.capacity() == 1);
+    CHECK(v[0].get<0>() == 1 && v[0].get<1>().value == 1);
+}
+
+int main() {
+    test_emplace_back_from_itself();
+    test_emplace_back_throws();
+
+    std::cout << (n_failed ? "soa_vector_test: FAILED\n" : "soa_vector_test: OK\n");
+    return n_failed;
+}
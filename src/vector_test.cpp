@@ -0,0 +1,371 @@
+#include <iostream>
+#include <stdexcept>
+#include <sstream>
+#include <iterator>
+#include <random>
+#include <ranges>
+#include <vector>
+#include "vector.hpp"
+#include "vector_bool.hpp"
+#include "inplace_vector.hpp"
+#include "segmented_vector.hpp"
+
+// Behaviour checks of nstd::vector, failures are printed and counted, exit code is their number
+
+static int n_failed = 0;
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if(!(cond)) {                                                               \
+            std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #cond "\n";    \
+            n_failed++;                                                             \
+        }                                                                           \
+    } while(0)
+
+/// counts live objects, copy constructor throws after n_copies_left copies
+struct Tracked {
+    static int n_alive;
+    static int n_copies_left;
+
+    int value;
+
+    Tracked(int value_ = 0): value(value_) { n_alive++; }
+    Tracked(const Tracked& other): value(other.value) {
+        if(n_copies_left-- == 0) throw std::runtime_error("copy");
+        n_alive++;
+    }
+    Tracked(Tracked&& other): value(other.value) { n_alive++; }
+    Tracked& operator=(const Tracked& other) { value = other.value; return *this; }
+    Tracked& operator=(Tracked&& other) { value = other.value; return *this; }
+    ~Tracked() { n_alive--; }
+};
+
+int Tracked::n_alive       = 0;
+int Tracked::n_copies_left = -1;
+
+template<typename Vector>
+bool has_values(const Vector& v, std::initializer_list<int> values) {
+    if(v.size() != values.size()) return false;
+
+    size_t i = 0;
+    for(int value : values) {
+        if(v[i++].value != value) return false;
+    }
+    return true;
+}
+
+void test_insert_count_throws() {
+    // in place
+    {
+        nstd::vector<Tracked> v;
+        v.reserve(16);
+        for(int i = 0; i < 4; i++) v.emplace_back(i);
+
+        Tracked::n_copies_left = 2;
+        try {
+            v.insert(v.begin() + 1, 3, Tracked(9));
+            CHECK(false);
+        } catch(const std::runtime_error&) {}
+        Tracked::n_copies_left = -1;
+
+        CHECK(has_values(v, {0, 1, 2, 3}));
+        CHECK(Tracked::n_alive == 4);
+    }
+    CHECK(Tracked::n_alive == 0);
+
+    // with reallocation
+    {
+        nstd::vector<Tracked> v;
+        for(int i = 0; i < 4; i++) v.emplace_back(i);
+        v.shrink_to_fit();
+
+        Tracked::n_copies_left = 2;
+        try {
+            v.insert(v.begin() + 1, 3, Tracked(9));
+            CHECK(false);
+        } catch(const std::runtime_error&) {}
+        Tracked::n_copies_left = -1;
+
+        CHECK(has_values(v, {0, 1, 2, 3}));
+        CHECK(Tracked::n_alive == 4);
+    }
+    CHECK(Tracked::n_alive == 0);
+}
+
+void test_insert_count() {
+    nstd::vector<Tracked> v;
+    for(int i = 0; i < 4; i++) v.emplace_back(i);
+
+    v.insert(v.begin() + 1, 2, Tracked(9));
+    CHECK(has_values(v, {0, 9, 9, 1, 2, 3}));
+
+    // value from the vector itself
+    v.insert(v.begin(), 3, v[5]);
+    CHECK(has_values(v, {3, 3, 3, 0, 9, 9, 1, 2, 3}));
+
+    v.insert(v.end(), v.back());
+    CHECK(has_values(v, {3, 3, 3, 0, 9, 9, 1, 2, 3, 3}));
+}
+
+void test_append_uninitialized() {
+    nstd::vector<int> v(2, 7);
+
+    v.append_uninitialized(3, [](int* place, size_t n_elems) {
+        for(size_t i = 0; i < n_elems; i++) place[i] = int(i);
+    });
+    CHECK(v.size() == 5 && v[4] == 2);
+
+    size_t n_filled = v.append_uninitialized(10, [](int* place, size_t) {
+        place[0] = 42;
+        return size_t(1);
+    });
+    CHECK(n_filled == 1 && v.size() == 6 && v[5] == 42);
+
+    // more than requested is caught even without the bounds checks
+    nstd::vector<int, std::allocator, nstd::default_capacity_policy, nstd::check_never> checked;
+    bool is_thrown = false;
+    try {
+        checked.append_uninitialized(4, [](int*, size_t n_elems) { return n_elems + 1; });
+    } catch(const std::out_of_range&) {
+        is_thrown = true;
+    }
+    CHECK(is_thrown);
+    CHECK(checked.size() == 0);
+
+    nstd::vector<Tracked> tracked;
+    tracked.append_uninitialized(4, [](Tracked* place, size_t n_elems) {
+        for(size_t i = 0; i < 2 && i < n_elems; i++) new (place + i) Tracked(int(i));
+        return size_t(2);
+    });
+    CHECK(has_values(tracked, {0, 1}));
+}
+
+void test_resize_growth() {
+    // capacity grows geometrically, as with push_back
+    for(int n_variant = 0; n_variant < 3; n_variant++) {
+        nstd::vector<int> v;
+        size_t n_growths = 0, capacity = v.capacity();
+
+        for(size_t i = 0; i < 100000; i++) {
+            if(n_variant == 0)      v.resize(v.size() + 1);
+            else if(n_variant == 1) v.resize(v.size() + 1, 5);
+            else                    v.resize_default_init(v.size() + 1);
+
+            n_growths += v.capacity() != capacity;
+            capacity   = v.capacity();
+        }
+        CHECK(v.size() == 100000);
+        CHECK(n_growths < 40);
+    }
+
+    nstd::vector<int> v;
+    v.resize(3, 7);
+    v.resize(5);
+    CHECK(v.size() == 5 && v[2] == 7 && v[3] == 0 && v[4] == 0);
+    v.resize(1);
+    CHECK(v.size() == 1 && v[0] == 7);
+}
+
+template<typename Vector>
+void check_reverse_iteration() {
+    Vector v;
+    CHECK(v.rbegin() == v.rend());
+    CHECK(v.crbegin() == v.crend());
+
+    for(int i = 0; i < 5; i++) v.push_back(i);
+
+    int expected = 4;
+    for(typename Vector::reverse_iterator it = v.rbegin(); it != v.rend(); ++it) {
+        CHECK(*it == expected--);
+    }
+    CHECK(expected == -1);
+    CHECK(v.rend() - v.rbegin() == 5);
+    CHECK(v.rbegin()[1] == 3 && *(v.rbegin() + 4) == 0);
+    CHECK(*v.crbegin() == 4 && *(v.crend() - 1) == 0);
+}
+
+void test_reverse_iteration() {
+    check_reverse_iteration<nstd::vector<int>>();
+    check_reverse_iteration<nstd::inplace_vector<int, 8>>();
+    check_reverse_iteration<nstd::segmented_vector<int>>();
+}
+
+/// moved by memcpy, live objects are counted by Tracked
+struct Relocatable : Tracked {
+    Relocatable(int value_ = 0): Tracked(value_) {}
+};
+
+template<>
+struct nstd::is_trivially_relocatable<Relocatable> : std::true_type {};
+
+template<typename Vector>
+void check_erase_if_throws(size_t n_throwing_call, std::initializer_list<int> expected) {
+    {
+        Vector v;
+        for(int i = 0; i < 10; i++) v.emplace_back(i);
+
+        size_t n_calls = 0;
+        try {
+            v.erase_if([&](const auto& elem) {
+                if(++n_calls == n_throwing_call) throw std::runtime_error("pred");
+                return elem.value == 1 || elem.value == 7;
+            });
+            CHECK(false);
+        } catch(const std::runtime_error&) {}
+
+        CHECK(has_values(v, expected));
+        CHECK(Tracked::n_alive == int(v.size()));
+    }
+    CHECK(Tracked::n_alive == 0);
+}
+
+void test_erase_if_throws() {
+    // pred throws while scanning the survivors after a removed element
+    check_erase_if_throws<nstd::vector<Relocatable>>(6, {0, 2, 3, 4, 5, 6, 7, 8, 9});
+    // pred throws right after a removal and on the first element
+    check_erase_if_throws<nstd::vector<Relocatable>>(3, {0, 2, 3, 4, 5, 6, 7, 8, 9});
+    check_erase_if_throws<nstd::vector<Relocatable>>(1, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+    // after the second removal
+    check_erase_if_throws<nstd::vector<Relocatable>>(10, {0, 2, 3, 4, 5, 6, 8, 9});
+
+    // elements of the general path stay valid, with some of them in unspecified order
+    {
+        nstd::vector<Tracked> v;
+        for(int i = 0; i < 10; i++) v.emplace_back(i);
+
+        size_t n_calls = 0;
+        try {
+            v.erase_if([&](const Tracked& elem) {
+                if(++n_calls == 6) throw std::runtime_error("pred");
+                return elem.value == 1;
+            });
+        } catch(const std::runtime_error&) {}
+
+        CHECK(v.size() == 10 || v.size() == 9);
+        CHECK(Tracked::n_alive == int(v.size()));
+    }
+    CHECK(Tracked::n_alive == 0);
+
+    nstd::vector<Relocatable> v;
+    for(int i = 0; i < 10; i++) v.emplace_back(i);
+    CHECK(v.erase_if([](const Relocatable& elem) { return elem.value % 3 == 0; }) == 4);
+    CHECK(has_values(v, {1, 2, 4, 5, 7, 8}));
+}
+
+void test_vector_bool_copy() {
+    nstd::vector<bool> bits(130, false);
+    bits[0] = bits[64] = bits[129] = true;
+
+    nstd::vector<bool> copy(bits);
+    CHECK(copy.size() == 130 && copy.count() == 3 && copy[129]);
+
+    copy[0] = false;
+    CHECK(bits[0] && !copy[0]);
+}
+
+static bool same_bits(nstd::vector<bool>& bits, const std::vector<bool>& ref) {
+    if(bits.size() != ref.size()) return false;
+
+    for(size_t i = 0; i < ref.size(); i++) {
+        if(bits[i] != ref[i]) return false;
+    }
+    return true;
+}
+
+void test_vector_bool_insert_erase() {
+    std::mt19937 rng(21);
+    nstd::vector<bool> bits;
+    std::vector<bool> ref;
+
+    for(int step = 0; step < 3000; step++) {
+        size_t pos = rng() % (ref.size() + 1);
+        size_t count = rng() % 150;
+
+        switch(rng() % 5) {
+        case 0: {
+            bool val = rng() % 2;
+            bits.insert(bits.begin() + pos, count, val);
+            ref.insert(ref.begin() + pos, count, val);
+            break;
+        }
+        case 1: {
+            std::vector<bool> source;
+            for(size_t i = 0; i < count; i++) source.push_back(rng() % 2);
+            bits.insert(bits.begin() + pos, source.begin(), source.end());
+            ref.insert(ref.begin() + pos, source.begin(), source.end());
+            break;
+        }
+        case 2: {
+            // range of this vector, copied by words; std::vector doesn't allow that, so its range is copied first
+            size_t first = rng() % (ref.size() + 1);
+            size_t last = first + rng() % (ref.size() - first + 1);
+            std::vector<bool> source(ref.begin() + first, ref.begin() + last);
+            bits.insert(bits.begin() + pos, bits.begin() + first, bits.begin() + last);
+            ref.insert(ref.begin() + pos, source.begin(), source.end());
+            break;
+        }
+        case 3: {
+            // single pass range, its length is unknown
+            std::string text;
+            std::vector<bool> source;
+            for(size_t i = 0; i < count; i++) {
+                source.push_back(rng() % 2);
+                text += source.back() ? "1 " : "0 ";
+            }
+            std::istringstream in(text);
+            bits.insert(bits.begin() + pos, std::istream_iterator<int>(in), std::istream_iterator<int>());
+            ref.insert(ref.begin() + pos, source.begin(), source.end());
+            break;
+        }
+        case 4:
+            if(pos < ref.size()) {
+                size_t last = pos + rng() % (ref.size() - pos + 1);
+                bits.erase(bits.begin() + pos, bits.begin() + last);
+                ref.erase(ref.begin() + pos, ref.begin() + last);
+            }
+            break;
+        }
+
+        if(ref.size() > 4000) {
+            bits.erase(bits.begin() + 1000, bits.end());
+            ref.erase(ref.begin() + 1000, ref.end());
+        }
+        if(!same_bits(bits, ref)) {
+            CHECK(same_bits(bits, ref));
+            return;
+        }
+    }
+}
+
+void test_vector_bool_input_iterators() {
+    std::istringstream in("1 0 0 1 1");
+    nstd::vector<bool> bits((std::istream_iterator<int>(in)), std::istream_iterator<int>());
+    CHECK(same_bits(bits, {true, false, false, true, true}));
+
+    std::istringstream more("0 1");
+    bits.assign(std::istream_iterator<int>(more), std::istream_iterator<int>());
+    CHECK(same_bits(bits, {false, true}));
+
+    std::istringstream tail("1 1 0");
+    bits.append_range(std::ranges::subrange(std::istream_iterator<int>(tail), std::istream_iterator<int>()));
+    CHECK(same_bits(bits, {false, true, true, true, false}));
+
+    std::istringstream empty("");
+    bits.insert(bits.begin() + 1, std::istream_iterator<int>(empty), std::istream_iterator<int>());
+    CHECK(bits.size() == 5);
+}
+
+int main() {
+    test_insert_count();
+    test_insert_count_throws();
+    test_append_uninitialized();
+    test_resize_growth();
+    test_reverse_iteration();
+    test_erase_if_throws();
+    test_vector_bool_copy();
+    test_vector_bool_insert_erase();
+    test_vector_bool_input_iterators();
+
+    std::cout << (n_failed ? "vector_test: FAILED\n" : "vector_test: OK\n");
+    return n_failed;
+}
@@ -0,0 +1,21 @@
+#include "vector.hpp"
+
+// Codegen check, only compiled: 'make vectorize_check' builds it with -O3 -S and greps the assembly of each function.
+// Integers are summed, so the reduction may be reordered and the vectorized loop shows packed adds (paddd).
+// The bound is n, not size(), so the bounds check is not redundant:
+// - sum_unchecked, default check_never policy, must be vectorized
+// - sum_checked, check_always policy, may throw in the middle and must stay scalar
+
+int sum_unchecked(const nstd::vector<int>& v, size_t n) {
+    int res = 0;
+    for(size_t i = 0; i < n; i++) res += v[i];
+
+    return res;
+}
+
+int sum_checked(const nstd::vector<int, std::allocator, nstd::default_capacity_policy, nstd::check_always>& v, size_t n) {
+    int res = 0;
+    for(size_t i = 0; i < n; i++) res += v[i];
+
+    return res;
+}